@@ -2,13 +2,25 @@
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec4 aColor;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aTexSlot;
+layout (location = 4) in float aMode;
+layout (location = 5) in float aAdditive;
+
+// Identity for streamed quads, which arrive in clip space, and the full transform for static batches
+uniform mat4 uViewProjection;
 
 out vec2 uv;
 out vec4 color;
+out float texSlot;
+out float mode;
+out float additive;
 
 void main()
 {
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+    gl_Position = uViewProjection * vec4(aPos.x, aPos.y, 0.0, 1.0);
     color = aColor;
     uv = aTexCoord;
+    texSlot = aTexSlot;
+    mode = aMode;
+    additive = aAdditive;
 }
\ No newline at end of file
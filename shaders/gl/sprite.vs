@@ -0,0 +1,33 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec2 iPosition;
+layout (location = 2) in vec2 iSize;
+layout (location = 3) in float iRotation;
+layout (location = 4) in vec4 iUvRect;
+layout (location = 5) in vec2 iPivot;
+layout (location = 6) in vec4 iColor;
+layout (location = 7) in float iTexSlot;
+layout (location = 8) in float iAdditive;
+
+uniform mat4 uViewProjection;
+
+out vec2 uv;
+out vec4 color;
+out float texSlot;
+out float mode;
+out float additive;
+
+void main()
+{
+    vec2 local = (aCorner - iPivot) * iSize;
+    float s = sin(iRotation);
+    float c = cos(iRotation);
+    vec2 world = iPosition + vec2(c * local.x + s * local.y, -s * local.x + c * local.y);
+
+    gl_Position = uViewProjection * vec4(world, 0.0, 1.0);
+    color = iColor;
+    texSlot = iTexSlot;
+    mode = 0.0;
+    additive = iAdditive;
+    uv = iUvRect.xy + aCorner * iUvRect.zw;
+}
\ No newline at end of file
@@ -1,14 +0,0 @@
-#version 330 core
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec4 aColor;
-layout (location = 2) in vec2 aTexCoord;
-
-out vec2 uv;
-out vec4 color;
-
-void main()
-{
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
-    color = aColor;
-    uv = aTexCoord;
-}
\ No newline at end of file
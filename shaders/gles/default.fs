@@ -1,14 +1,57 @@
 //#version 330 core
 //out vec4 FragColor;
+#ifdef GL_OES_standard_derivatives
+#extension GL_OES_standard_derivatives : enable
+#endif
 precision mediump float; 
 varying vec4 color;
 varying vec2 uv;
+varying float texSlot;
+varying float mode; // 0 tints the texel, 1 uses the red channel as coverage for text, 2 as a distance field
+varying float additive;
 
-uniform sampler2D uTexture;
+uniform sampler2D uTextures[8];
+uniform vec4 uTint;
+
+// Sampler arrays may only be indexed with constants on GLES, the slot picks a branch instead
+vec4 SampleSlot(float slot, vec2 coords)
+{
+    if (slot < 0.5) return texture2D(uTextures[0], coords);
+    if (slot < 1.5) return texture2D(uTextures[1], coords);
+    if (slot < 2.5) return texture2D(uTextures[2], coords);
+    if (slot < 3.5) return texture2D(uTextures[3], coords);
+    if (slot < 4.5) return texture2D(uTextures[4], coords);
+    if (slot < 5.5) return texture2D(uTextures[5], coords);
+    if (slot < 6.5) return texture2D(uTextures[6], coords);
+    return texture2D(uTextures[7], coords);
+}
 
 void main()
 {
     vec4 uvColor = vec4(uv.x, uv.y, 0, 1.0);
-    vec4 textureColor = texture2D(uTexture, uv);
-    gl_FragColor = vec4(mix(textureColor.rgb, color.rgb, color.a), textureColor.a);
+    // Textures are premultiplied and so is the output, blending is ONE, ONE_MINUS_SRC_ALPHA
+    vec4 textureColor = SampleSlot(texSlot, uv);
+    // Derivatives are taken before branching, the smoothing follows how fast the distance changes on screen
+#ifdef GL_OES_standard_derivatives
+    float smoothing = max(0.7 * fwidth(textureColor.r), 0.001);
+#else
+    float smoothing = 0.09; // About a pixel when drawn at the size the glyphs were baked
+#endif
+    if (mode < 0.5)
+    {
+        gl_FragColor = vec4(mix(textureColor.rgb, color.rgb * textureColor.a, color.a), textureColor.a);
+    }
+    else if (mode < 1.5)
+    {
+        float coverage = textureColor.r * color.a;
+        gl_FragColor = vec4(color.rgb * coverage, coverage);
+    }
+    else
+    {
+        float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, textureColor.r) * color.a;
+        gl_FragColor = vec4(color.rgb * coverage, coverage);
+    }
+    // Less alpha only lets more of the destination through, at 0 the color is added
+    gl_FragColor.a *= 1.0 - additive;
+    gl_FragColor *= vec4(uTint.rgb * uTint.a, uTint.a);
 } 
\ No newline at end of file
@@ -2,13 +2,25 @@
 attribute vec2 aPos;
 attribute vec4 aColor;
 attribute vec2 aTexCoord;
+attribute float aTexSlot;
+attribute float aMode;
+attribute float aAdditive;
+
+// Identity for streamed quads, which arrive in clip space, and the full transform for static batches
+uniform mat4 uViewProjection;
 
 varying vec2 uv;
 varying vec4 color;
+varying float texSlot;
+varying float mode;
+varying float additive;
 
 void main()
 {
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+    gl_Position = uViewProjection * vec4(aPos.x, aPos.y, 0.0, 1.0);
     color = aColor;
     uv = aTexCoord;
+    texSlot = aTexSlot;
+    mode = aMode;
+    additive = aAdditive;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+//#version 330 core
+attribute vec2 aCorner;
+attribute vec2 iPosition;
+attribute vec2 iSize;
+attribute float iRotation;
+attribute vec4 iUvRect;
+attribute vec2 iPivot;
+attribute vec4 iColor;
+attribute float iTexSlot;
+attribute float iAdditive;
+
+uniform mat4 uViewProjection;
+
+varying vec2 uv;
+varying vec4 color;
+varying float texSlot;
+varying float mode;
+varying float additive;
+
+void main()
+{
+    vec2 local = (aCorner - iPivot) * iSize;
+    float s = sin(iRotation);
+    float c = cos(iRotation);
+    vec2 world = iPosition + vec2(c * local.x + s * local.y, -s * local.x + c * local.y);
+
+    gl_Position = uViewProjection * vec4(world, 0.0, 1.0);
+    color = iColor;
+    texSlot = iTexSlot;
+    mode = 0.0;
+    additive = iAdditive;
+    uv = iUvRect.xy + aCorner * iUvRect.zw;
+}
\ No newline at end of file
@@ -11,9 +11,10 @@
     
 #endif // DEBUG_MODE
 
-#if defined (PLATFORM_DESKTOP)
-    #define FEATHER_SPRITE_ATLAS
-#endif 
+// Quad renderer vertices with RGBA8 colors and unorm16 uvs, 20 bytes instead of 44
+#define QUAD_RENDERER_COMPACT_VERTICES
+// Half float positions in the compact layout bring it to 16 bytes at ~1/4 pixel of precision, needs GL 3 / GLES 3
+// #define QUAD_RENDERER_HALF_POSITIONS
 
 #ifndef ASSERT
     #if defined(_DEBUG)
@@ -0,0 +1,109 @@
+#include "asset_pack.hpp"
+#include "core.hpp"
+#include "platform_api.hpp"
+
+#include <cstring>
+
+#ifndef MAX_ASSET_PACK_PREFIX
+    #define MAX_ASSET_PACK_PREFIX 512
+#endif
+
+struct {
+    unsigned char* data; // The whole pack, mapped
+    size_t size;
+    const AssetPackSlot* slots;
+    uint32_t slot_count;
+    char prefix[MAX_ASSET_PACK_PREFIX];
+    size_t prefix_length;
+} state = {0};
+
+namespace Mln
+{
+    bool MountAssetPack(const char* path, const char* prefix)
+    {
+        size_t prefix_length = strlen(prefix);
+        ASSERT(prefix_length < MAX_ASSET_PACK_PREFIX, "Asset pack prefix is too long");
+        if (prefix_length >= MAX_ASSET_PACK_PREFIX)
+        {
+            return false;
+        }
+
+        size_t size = 0;
+        unsigned char* data = PlatformMapFile(path, &size);
+        if (!data)
+        {
+            return false;
+        }
+
+        // Only the table is checked here, every lookup checks the asset it returns
+        AssetPackHeader header = {};
+        if (size >= sizeof(header))
+        {
+            memcpy(&header, data, sizeof(header));
+        }
+        bool valid = header.magic == AssetPackMagic && header.version == AssetPackVersion && header.slot_count > 0
+                  && (header.slot_count & (header.slot_count - 1)) == 0 && sizeof(header) + (size_t)header.slot_count * sizeof(AssetPackSlot) <= size;
+        if (!valid)
+        {
+            PrintLog(LOG_ERROR, "Asset pack %s is not a version %u pack\n", path, AssetPackVersion);
+            PlatformUnmapFile(data, size);
+            return false;
+        }
+
+        UnmountAssetPack();
+        state.data = data;
+        state.size = size;
+        state.slots = (const AssetPackSlot*)(data + sizeof(header));
+        state.slot_count = header.slot_count;
+        memcpy(state.prefix, prefix, prefix_length + 1);
+        state.prefix_length = prefix_length;
+        PrintLog(LOG_INFO, "Mounted asset pack %s with %u assets\n", path, header.asset_count);
+        return true;
+    }
+
+    void UnmountAssetPack()
+    {
+        if (state.data)
+        {
+            PlatformUnmapFile(state.data, state.size);
+        }
+        state = {};
+    }
+
+    unsigned char* FindPackedAsset(const char* path, size_t* size)
+    {
+        if (!state.data || strncmp(path, state.prefix, state.prefix_length) != 0)
+        {
+            return nullptr;
+        }
+
+        const char* name = path + state.prefix_length;
+        size_t length = strlen(name);
+        uint64_t hash = HashAssetName(name, length);
+        for (uint32_t i = 0; i < state.slot_count; i++)
+        {
+            const AssetPackSlot* slot = &state.slots[(hash + i) & (state.slot_count - 1)];
+            if (slot->hash == 0)
+            {
+                return nullptr;
+            }
+            if (slot->hash != hash || slot->name_length != length)
+            {
+                continue;
+            }
+
+            bool in_bounds = slot->name_offset + (size_t)slot->name_length <= state.size && slot->offset <= state.size && slot->size <= state.size - slot->offset;
+            if (in_bounds && memcmp(state.data + slot->name_offset, name, length) == 0)
+            {
+                *size = (size_t)slot->size;
+                return state.data + slot->offset;
+            }
+        }
+        return nullptr;
+    }
+
+    bool IsPackedAsset(const unsigned char* data)
+    {
+        return state.data && data >= state.data && data < state.data + state.size;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef MELON_ASSET_PACK_HPP
+#define MELON_ASSET_PACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Asset packs hold a resource directory in one file built by tools/asset_packer. The file is an AssetPackHeader, a
+// table of slot_count AssetPackSlots, the asset names and then the assets, each starting on a 16 byte boundary.
+// Slots are open addressed on HashAssetName with linear probing, a hash of 0 marks an empty slot.
+// A mounted pack is mapped once and LoadFileBinary hands out views into the mapping instead of reading and copying
+
+#define ASSET_PACK_FILE "resources.pack"
+
+constexpr uint32_t AssetPackMagic = 0x504E4C4D; // "MLNP"
+constexpr uint32_t AssetPackVersion = 1;
+constexpr uint64_t AssetPackAlignment = 16;
+
+struct AssetPackHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count; // Power of two, at least twice the asset count
+    uint32_t asset_count;
+};
+
+struct AssetPackSlot{
+    uint64_t hash;
+    uint64_t offset;     // From the start of the pack
+    uint64_t size;
+    uint32_t name_offset;
+    uint32_t name_length;
+};
+
+// FNV-1a over the name relative to the packed directory with '/' separators, never 0
+inline uint64_t HashAssetName(const char* name, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char)name[i]) * 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
+namespace Mln
+{
+    // Files below prefix are looked up in the pack first. InitWindow mounts RESOURCES_PATH ASSET_PACK_FILE when it
+    // exists, a later mount replaces the earlier one. Data loaded from the pack must be done with before it is unmounted
+    bool MountAssetPack(const char* path, const char* prefix);
+    void UnmountAssetPack();
+
+    // A view into the mounted pack, or null when the path isn't packed
+    unsigned char* FindPackedAsset(const char* path, size_t* size);
+    bool IsPackedAsset(const unsigned char* data);
+}
+
+#endif // MELON_ASSET_PACK_HPP
@@ -1,6 +1,7 @@
 #include "audio.hpp"
 #include "core.hpp"
 #include "melon_types.hpp"
+#include "handle_pool.hpp"
 #include <cstdlib>
 #include <cstring>
 #include <stdint.h>
@@ -18,14 +19,7 @@ using namespace Mln;
         WAVE_FLOAT = 3
     } WaveFormat;
 
-    constexpr size_t SoundBufferNodeCapacity = 32;
-
-    struct SoundBufferNode
-    {
-        SoundBufferNode* next;
-        int count;
-        SoundBuffer buffers[SoundBufferNodeCapacity];
-    };
+    constexpr int InitialSoundCapacity = 32;
 
     struct RawSound
     {
@@ -40,18 +34,22 @@ using namespace Mln;
 
     static void OnSendAudioDataToDevice(ma_device *device, void *frames_out, const void *frames_in, ma_uint32 frame_count);
     Sound ConvertRawSound(RawSound raw_sound);
-    SoundBuffer* TrackSoundBuffer(SoundBuffer buffer); // Stores SoundBuffer in gAudio.buffer_list
+    Sound TrackSoundBuffer(SoundBuffer buffer); // Stores SoundBuffer in gAudio.buffers
     void DebugWriteWaveFile(RawSound raw_sound);
 
     static struct {
         ma_device device;
         ma_mutex lock;
-        SoundBufferNode buffer_list;
+        HandlePool buffers; // SoundBuffer, Sound::id is the handle
     } gAudio = {0};
 
 
     int InitAudio()
     {
+        InitHandlePool(&gAudio.buffers, sizeof(SoundBuffer), InitialSoundCapacity);
+        // Sounds are loaded from job threads too, the lock keeps them and the device out of the pool together
+        ma_mutex_init(&gAudio.lock);
+
         ma_device_config config  = ma_device_config_init(ma_device_type_playback);
         config.playback.format   = ma_format_f32;   // Set to ma_format_unknown to use the device's native format.
         config.playback.channels = 2;               // Set to 0 to use the device's native channel count.
@@ -76,51 +74,41 @@ using namespace Mln;
 
         ma_mutex_lock(&gAudio.lock);
         {
-            SoundBufferNode* iterator = &gAudio.buffer_list;
-
-            while(iterator != NULL)
+            for (int slot = 0; slot < gAudio.buffers.capacity; slot++)
             {
-                for (int i = 0; i < iterator->count; i++)
+                SoundBuffer* buffer = (SoundBuffer*)GetPoolItemAt(&gAudio.buffers, slot);
+                if (buffer == NULL || !buffer->playing)
+                {
+                    continue;
+                }
+
+
+                uint32_t availableFrames = (buffer->frame_count - buffer->frames_processed);
+
+                bool finished = false;
+                if (availableFrames > frame_count)
+                {
+                    availableFrames = frame_count;
+                }
+                else
                 {
-                    SoundBuffer* buffer = &iterator->buffers[i];
-                    ASSERT(buffer != NULL, "There should not be any null buffers in the buffer_list");
-
-                    if (!buffer->playing)
-                    {
-                        continue;
-                    }
-
-
-                    uint32_t availableFrames = (buffer->frame_count - buffer->frames_processed);
-
-                    bool finished = false;
-                    if (availableFrames > frame_count)
-                    {
-                        availableFrames = frame_count;
-                    }
-                    else
-                    {
-                        finished = true;
-                    }
-
-                    // Accumulate all sound sources
-                    int bytes_per_frame = buffer->bytes_per_sample * buffer->channels;
-                    uint8_t* data_frame_start = buffer->data + buffer->frames_processed * bytes_per_frame;
-                    for (int i = 0; i < availableFrames * buffer->channels; i++) {
-                        ((float*)frames_out)[i] += ((float*)data_frame_start)[i];
-                    }
-
-                    buffer->frames_processed += availableFrames;
-
-                    if (finished)
-                    {
-                        buffer->playing = buffer->looping;
-                        buffer->frames_processed = 0;
-                    }
+                    finished = true;
+                }
 
+                // Accumulate all sound sources
+                int bytes_per_frame = buffer->bytes_per_sample * buffer->channels;
+                uint8_t* data_frame_start = buffer->data + buffer->frames_processed * bytes_per_frame;
+                for (int i = 0; i < availableFrames * buffer->channels; i++) {
+                    ((float*)frames_out)[i] += ((float*)data_frame_start)[i];
                 }
 
-                iterator = iterator->next;
+                buffer->frames_processed += availableFrames;
+
+                if (finished)
+                {
+                    buffer->playing = buffer->looping;
+                    buffer->frames_processed = 0;
+                }
             }
         }
 
@@ -131,9 +119,23 @@ using namespace Mln;
     void PlaySound(Sound sound)
     {
         ma_mutex_lock(&gAudio.lock);
-        sound.buffer->playing = true;
-        sound.buffer->frames_processed = 0;
+        SoundBuffer* buffer = (SoundBuffer*)GetPoolItem(&gAudio.buffers, sound.id);
+        if (buffer)
+        {
+            buffer->playing = true;
+            buffer->frames_processed = 0;
+        }
+        ma_mutex_unlock(&gAudio.lock);
+    }
+
+
+    size_t GetSoundMemory(Sound sound)
+    {
+        ma_mutex_lock(&gAudio.lock);
+        SoundBuffer* buffer = (SoundBuffer*)GetPoolItem(&gAudio.buffers, sound.id);
+        size_t bytes = buffer ? (size_t)buffer->frame_count * buffer->channels * buffer->bytes_per_sample : 0;
         ma_mutex_unlock(&gAudio.lock);
+        return bytes;
     }
 
 
@@ -143,7 +145,7 @@ using namespace Mln;
         uint8_t* file_content = Mln::LoadFileBinary(filepath, &file_size);
         if (!file_content)
         {
-            return Sound{0};
+            return Sound{InvalidID};
         }
 
         Sound sound = LoadSoundFromMemoryWave(file_content, file_size);
@@ -170,32 +172,32 @@ using namespace Mln;
         if (!CompareBytes(&cursor, end, (const uint8_t*)"RIFF", 4))
         {
             PrintLog(LOG_ERROR, "Incorrect RIFF tag\n");
-            return Sound{};
+            return Sound{InvalidID};
         }
 
         uint8_t filesize_bytes[4];
         if (!ReadBytes(&cursor, end, 4, filesize_bytes))
         {
             PrintLog(LOG_ERROR, "Could not read filesize hint\n");
-            return Sound{};
+            return Sound{InvalidID};
         }
         int32_t filesize = BYTES_TO_INT32(filesize_bytes);
         if (filesize != size - 8)
         {
             PrintLog(LOG_ERROR, "Incorrect filesize hint, file may be corrupted\n");
-            return Sound{};
+            return Sound{InvalidID};
         }
 
         if (!CompareBytes(&cursor, end, (const uint8_t*)"WAVE", 4))
         {
             PrintLog(LOG_ERROR, "Incorrect WAVE tag\n");
-            return Sound{};
+            return Sound{InvalidID};
         }
 
         if (!CompareBytes(&cursor, end, (const uint8_t*)"fmt ", 4))
         {
             PrintLog(LOG_ERROR, "Incorrect fmt tag\n");
-            return Sound{};
+            return Sound{InvalidID};
         }
         
         int32_t fmt_size = BYTES_TO_INT32(cursor);
@@ -236,7 +238,7 @@ using namespace Mln;
         if (!CompareBytes(&cursor, end, (const uint8_t*)"data", 4))
         {
             PrintLog(LOG_ERROR, "Incorrect data tag\n");
-            return Sound{};
+            return Sound{InvalidID};
         }
 
         int32_t data_size = BYTES_TO_INT32(cursor);
@@ -256,38 +258,22 @@ using namespace Mln;
 
     void UnloadSound(Sound* sound)
     {
-        // TODO: Remove the sound buffer from the list then free the sound itself
-        
-        SoundBufferNode* iterator = &gAudio.buffer_list;
-        SoundBufferNode* owner = NULL;
-        int index = 0;
-        while (iterator != NULL) 
+        ma_mutex_lock(&gAudio.lock);
+        SoundBuffer* buffer = (SoundBuffer*)GetPoolItem(&gAudio.buffers, sound->id);
+        if (buffer)
         {
-            for (int i = 0; i < iterator->count; i++) 
-            {
-                if (&iterator->buffers[i] == sound->buffer)
-                {
-                    owner = iterator;
-                    index = i;
-                    break;
-                }
-            }
-            
-            iterator = iterator->next;
+            free(buffer->data);
+            RemovePoolItem(&gAudio.buffers, sound->id);
         }
-        
-        if (!owner)
+        ma_mutex_unlock(&gAudio.lock);
+
+        if (!buffer)
         {
             PrintLog(LOG_ERROR, "Could not find sound to be removed.\n");
             return;
         }
 
-        free(sound->buffer->data);
-        sound->buffer = NULL;
-        
-        // Delete by swap with end
-        owner->buffers[index] = owner->buffers[owner->count - 1];
-        owner->count -= 1;
+        sound->id = InvalidID;
     }
 
 
@@ -359,46 +345,17 @@ using namespace Mln;
         buffer.playing = false;
         buffer.looping = false;
         
-        SoundBuffer* tracked_buffer = TrackSoundBuffer(buffer);
-        Sound result = {tracked_buffer};
-        return result;
+        return TrackSoundBuffer(buffer);
     }
 
-    SoundBuffer* TrackSoundBuffer(SoundBuffer buffer)
+    Sound TrackSoundBuffer(SoundBuffer buffer)
     {
+        // The pool can move its buffers while it grows, so the audio thread has to be kept out
         ma_mutex_lock(&gAudio.lock);
-
-        SoundBufferNode* free_node = NULL;
-        SoundBufferNode* last = &gAudio.buffer_list;
-        SoundBufferNode* iterator = &gAudio.buffer_list;
-        while (free_node == NULL && iterator != NULL) {
-            if (iterator->count < SoundBufferNodeCapacity)
-            {
-                // We found a node with free space
-                free_node = iterator;
-                break;
-            }
-            
-            last = iterator;
-            iterator = iterator->next;
-        }
-
-
-        if (!free_node)
-        {
-            free_node = (SoundBufferNode*) malloc(sizeof(SoundBufferNode));
-            free_node->count = 0;
-            free_node->next = NULL;
-            last->next = free_node;
-        }
-
-        SoundBuffer* tracked_buffer = &free_node->buffers[free_node->count++];
-        *tracked_buffer = buffer;
-
+        Sound result = {AddPoolItem(&gAudio.buffers, &buffer)};
         ma_mutex_unlock(&gAudio.lock);
 
-
-        return tracked_buffer;
+        return result;
     }
 
 
@@ -34,9 +34,9 @@ namespace Mln
         bool looping;
     };
 
-    // NOTE: This is a handle to the underlying sound buffer
+    // NOTE: This is a handle to the underlying sound buffer, it stays safe to use after the sound is unloaded
     struct Sound{
-        SoundBuffer* buffer;
+        id_t id;
     };
 }
 
@@ -49,6 +49,7 @@ extern "C"
     Mln::Sound LoadSoundFromMemoryWave(uint8_t* data, size_t size);
     
     void UnloadSound(Mln::Sound* sound);
+    size_t GetSoundMemory(Mln::Sound sound); // Bytes of the converted samples, 0 for unloaded sounds
     
     void PlaySound(Mln::Sound sound);
 }
@@ -32,6 +32,23 @@
 #include "graphics_api.hpp"
 
 #include "audio.hpp"
+#include "resources.hpp"
+#include "asset_pack.hpp"
+#include "jobs.hpp"
+
+#ifndef POWER_UNFOCUSED_FPS
+    #define POWER_UNFOCUSED_FPS 10
+#endif
+
+// Seconds between updates while minimized
+#ifndef POWER_MINIMIZED_INTERVAL
+    #define POWER_MINIMIZED_INTERVAL 0.5
+#endif
+
+// Update rate while the game reports unchanged frames, there is no swap to wait on vsync then. Input wakes it early
+#ifndef POWER_IDLE_FPS
+    #define POWER_IDLE_FPS 30
+#endif
 
 namespace Mln{
     CoreData gCore;
@@ -45,6 +62,10 @@ namespace Mln{
         PlatformInit();
         PlatformInitTimer();
 
+        // Optional, without a pack every asset is read from its own file
+        MountAssetPack(RESOURCES_PATH ASSET_PACK_FILE, RESOURCES_PATH);
+        InitJobs(JOB_THREADS);
+
         InitGraphics(width, height);
 
         InitAudio();
@@ -58,7 +79,10 @@ namespace Mln{
 
     void UnloadWindow()
     {
+        ShutdownJobs();
+        UnloadAllResources();
         ShutdownGraphics();
+        UnmountAssetPack();
         PlatformShutdown();
     }
 
@@ -88,6 +112,11 @@ namespace Mln{
         return gCore.delta;
     }
 
+    double GetTime()
+    {
+        return PlatformGetTime();
+    }
+
     double GetFPS()
     {
         double sum = 0;
@@ -102,16 +131,53 @@ namespace Mln{
     {
         gCore.input.previous = gCore.input.current;
         PlatformBeginFrame();
-        PlatformPollInput();
-        
+
+        PowerMode mode = POWER_MODE_ACTIVE;
+        if (PlatformIsWindowMinimized())
+        {
+            mode = POWER_MODE_MINIMIZED;
+        }
+        else if (!PlatformIsWindowFocused())
+        {
+            mode = POWER_MODE_UNFOCUSED;
+        }
+        gCore.powerModeChanged = mode != gCore.powerMode;
+        gCore.powerMode = mode;
+
+        if (!gCore.powerSaving)
+        {
+            PlatformPollInput();
+        }
+        else if (mode == POWER_MODE_MINIMIZED)
+        {
+            PlatformWaitInput(POWER_MINIMIZED_INTERVAL);
+        }
+        else if (mode == POWER_MODE_UNFOCUSED)
+        {
+            PlatformWaitInput(1.0 / POWER_UNFOCUSED_FPS);
+        }
+        else if (gCore.lastFrameSkipped)
+        {
+            PlatformWaitInput(1.0 / POWER_IDLE_FPS);
+        }
+        else
+        {
+            PlatformPollInput();
+        }
+
+        gCore.frameUnchanged = false;
         BeginDrawing();
     }
 
     void EndFrame()
     {
-        EndDrawing();
-
-        PlatformEndFrame();
+        bool draw = ShouldDrawFrame();
+        if (draw)
+        {
+            EndDrawing();
+            PlatformEndFrame();
+        }
+        gCore.lastFrameSkipped = !draw;
         gCore.windowResized = false;
 
         
@@ -129,6 +195,36 @@ namespace Mln{
     }
 
 
+    void SetPowerSaving(bool enabled)
+    {
+        gCore.powerSaving = enabled;
+    }
+
+    PowerMode GetPowerMode()
+    {
+        return gCore.powerMode;
+    }
+
+    void MarkFrameUnchanged()
+    {
+        gCore.frameUnchanged = true;
+    }
+
+    bool ShouldDrawFrame()
+    {
+        if (!gCore.powerSaving)
+        {
+            return true;
+        }
+        if (gCore.powerMode == POWER_MODE_MINIMIZED)
+        {
+            return false;
+        }
+        // The presented image may have been lost while minimized or resized, it is redrawn even if the game did not change
+        return !gCore.frameUnchanged || gCore.powerModeChanged || gCore.windowResized;
+    }
+
+
     Image LoadImage(const char *path)
     {
         Image image{0};
@@ -187,6 +283,24 @@ namespace Mln{
         }
     }
 
+    void ImagePremultiplyAlpha(Image image)
+    {
+        ASSERT(image.components == 4, "Premultiplying is only supported for images with 4 components");
+
+        int pixel_count = image.width * image.height;
+        for (int i = 0; i < pixel_count; i++)
+        {
+            unsigned char* pixel = image.data + i * 4;
+            unsigned int alpha = pixel[3];
+            // Rounded x * a / 255
+            for (int c = 0; c < 3; c++)
+            {
+                unsigned int value = pixel[c] * alpha + 128;
+                pixel[c] = (unsigned char)((value + (value >> 8)) >> 8);
+            }
+        }
+    }
+
     void WriteImage(Image image, const char* path)
     {
         stbi_write_png(path, image.width, image.height, image.components, image.data, 0);
@@ -288,14 +402,16 @@ namespace Mln{
             } break;
         }
 
-        char* body = stpcpy(gCore.textBuffer, prefix); // returns null terminator of dest
+        // Formatted on the stack rather than in gCore.textBuffer, jobs log from their own threads
+        char buffer[TEXT_BUFFER_SIZE];
+        char* body = stpcpy(buffer, prefix); // returns null terminator of dest
 
         va_list args;
         va_start(args, format);
-        int requiredByteCount = stbsp_vsnprintf(body, TEXT_BUFFER_SIZE, format, args);
+        int requiredByteCount = stbsp_vsnprintf(body, TEXT_BUFFER_SIZE - (int)(body - buffer), format, args);
         va_end(args);
 
-        PlatformPrint(gCore.textBuffer);
+        PlatformPrint(buffer);
 
     }
 
@@ -309,7 +425,11 @@ namespace Mln{
     unsigned char *LoadFileBinary(const char *fileName, size_t *dataSize)
     {
         size_t size = 0;
-        unsigned char* bytes = PlatformLoadFileBinary(fileName, &size);
+        unsigned char* bytes = FindPackedAsset(fileName, &size);
+        if (!bytes)
+        {
+            bytes = PlatformLoadFileBinary(fileName, &size);
+        }
         if (dataSize)
         {
             *dataSize = size;
@@ -319,6 +439,11 @@ namespace Mln{
 
     void UnloadFileBinary(unsigned char *data)
     {
+        // Views into the pack go away with the pack
+        if (IsPackedAsset(data))
+        {
+            return;
+        }
         PlatformUnloadFileBinary(data);
     }
 
@@ -327,6 +452,11 @@ namespace Mln{
         return PlatformSaveFileBinary(fileName, data, dataSize);
     }
 
+    bool GetFileInfo(const char *fileName, size_t *dataSize, long long *modTime)
+    {
+        return PlatformGetFileInfo(fileName, dataSize, modTime);
+    }
+
     char *LoadFileText(const char *fileName)
     {
         return PlatformLoadFileText(fileName);
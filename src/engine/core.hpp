@@ -26,15 +26,24 @@ namespace Mln
     Vector2 GetViewportSize();
 
     double GetFrameTime();
+    double GetTime(); // Seconds since InitWindow, safe to call from job threads
     double GetFPS();
 
     void BeginFrame();
     void EndFrame();
 
+    // Unfocused windows are throttled and minimized ones are not drawn. Frames the game reports as unchanged skip
+    // drawing and presenting, input keeps being polled in every mode. Enabled by default
+    void SetPowerSaving(bool enabled);
+    PowerMode GetPowerMode();
+    void MarkFrameUnchanged(); // Called from the update when the frame would look like the last one
+    bool ShouldDrawFrame(); // False when the draw can be skipped, EndFrame then does not present
+
     Image LoadImage(const char* path);
     Image CreateImage(int width, int height, int components);
     void UnloadImage(Image image);
     void ImageDrawImage(Image dst, RectI dst_rect, Image src, RectI src_rect);
+    void ImagePremultiplyAlpha(Image image); // RGBA only, the renderer expects premultiplied textures
     void WriteImage(Image image, const char* path);
     
 
@@ -60,9 +69,12 @@ namespace Mln
 
     void* GetProcAddressPtr();
 
+    // Files in the mounted asset pack come back as views into it without a copy (see asset_pack.hpp)
     unsigned char *LoadFileBinary(const char *fileName, size_t *dataSize);
     void UnloadFileBinary(unsigned char *data);
     bool SaveFileBinary(const char *fileName, void *data, size_t dataSize);
+    // Only looks at the file on disk, never at the asset pack
+    bool GetFileInfo(const char *fileName, size_t *dataSize, long long *modTime);
 
     char *LoadFileText(const char *fileName);
     void UnloadFileText(char *text);
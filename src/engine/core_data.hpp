@@ -27,6 +27,12 @@ namespace Mln
         bool shouldClose = false;
         bool windowResized = false;
         const char* windowTitle = nullptr;
+
+        bool powerSaving = true;
+        PowerMode powerMode = POWER_MODE_ACTIVE;
+        bool powerModeChanged = false;
+        bool frameUnchanged = false; // Reported by the game for the current frame
+        bool lastFrameSkipped = false;
         struct{
             int width;
             int height;
@@ -0,0 +1,94 @@
+#include "handle_pool.hpp"
+#include "core.hpp"
+#include <cstdlib>
+#include <cstring>
+
+constexpr uint32_t HandleIndexMask = (1u << HandleIndexBits) - 1;
+constexpr uint32_t HandleGenerationMask = (1u << (32 - HandleIndexBits)) - 1;
+// The last index stays unused so no generation can make a handle equal to InvalidID
+constexpr int MaxPoolCapacity = (int)HandleIndexMask;
+
+void _GrowHandlePool(HandlePool* pool, int capacity);
+
+void InitHandlePool(HandlePool* pool, int item_size, int initial_capacity)
+{
+    *pool = HandlePool{};
+    pool->item_size = item_size;
+    pool->free_head = -1;
+    _GrowHandlePool(pool, initial_capacity > 0 ? initial_capacity : 1);
+}
+
+void FreeHandlePool(HandlePool* pool)
+{
+    free(pool->items);
+    free(pool->generations);
+    free(pool->next_free);
+    *pool = HandlePool{};
+}
+
+Mln::id_t AddPoolItem(HandlePool* pool, const void* item)
+{
+    if (pool->free_head < 0)
+    {
+        ASSERT(pool->capacity < MaxPoolCapacity, "Handle pool is full");
+        _GrowHandlePool(pool, pool->capacity * 2 < MaxPoolCapacity ? pool->capacity * 2 : MaxPoolCapacity);
+    }
+
+    int index = pool->free_head;
+    pool->free_head = pool->next_free[index];
+    pool->generations[index]++;
+    pool->count++;
+    memcpy(pool->items + (size_t)index * pool->item_size, item, pool->item_size);
+
+    return ((pool->generations[index] & HandleGenerationMask) << HandleIndexBits) | (uint32_t)index;
+}
+
+void* GetPoolItem(const HandlePool* pool, Mln::id_t handle)
+{
+    uint32_t index = handle & HandleIndexMask;
+    uint32_t generation = handle >> HandleIndexBits;
+    if (index >= (uint32_t)pool->capacity || (pool->generations[index] & 1) == 0 || (pool->generations[index] & HandleGenerationMask) != generation)
+    {
+        return nullptr;
+    }
+    return pool->items + (size_t)index * pool->item_size;
+}
+
+bool RemovePoolItem(HandlePool* pool, Mln::id_t handle)
+{
+    if (!GetPoolItem(pool, handle))
+    {
+        return false;
+    }
+
+    int index = (int)(handle & HandleIndexMask);
+    pool->generations[index]++;
+    pool->next_free[index] = pool->free_head;
+    pool->free_head = index;
+    pool->count--;
+    return true;
+}
+
+void* GetPoolItemAt(const HandlePool* pool, int index)
+{
+    ASSERT(index >= 0 && index < pool->capacity, "Index outside the handle pool");
+    return (pool->generations[index] & 1) ? pool->items + (size_t)index * pool->item_size : nullptr;
+}
+
+
+void _GrowHandlePool(HandlePool* pool, int capacity)
+{
+    int old_capacity = pool->capacity;
+    pool->items = (unsigned char*)realloc(pool->items, (size_t)capacity * pool->item_size);
+    pool->generations = (uint32_t*)realloc(pool->generations, capacity * sizeof(uint32_t));
+    pool->next_free = (int*)realloc(pool->next_free, capacity * sizeof(int));
+
+    // New slots go on the free list in index order
+    for (int i = capacity - 1; i >= old_capacity; i--)
+    {
+        pool->generations[i] = 0;
+        pool->next_free[i] = pool->free_head;
+        pool->free_head = i;
+    }
+    pool->capacity = capacity;
+}
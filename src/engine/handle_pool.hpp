@@ -0,0 +1,33 @@
+#pragma once
+
+#include "melon_types.hpp"
+#include <cstdint>
+
+// Generational slot map behind the engine's handles. A handle is a slot index in the low HandleIndexBits and the
+// generation of the slot above it. The generation changes whenever a slot is emptied, so a handle to an unloaded
+// resource is caught instead of reaching whatever reused the slot. Lookups are an index and a compare and the pool
+// doubles when it is full. Items move when it grows, pointers from GetPoolItem are valid until the next AddPoolItem
+
+constexpr int HandleIndexBits = 20;
+
+struct HandlePool{
+    unsigned char* items;
+    uint32_t* generations; // Odd while the slot holds an item
+    int* next_free;        // Free list through the empty slots, -1 ends it
+    int item_size;
+    int capacity;
+    int count;
+    int free_head;
+};
+
+void InitHandlePool(HandlePool* pool, int item_size, int initial_capacity);
+void FreeHandlePool(HandlePool* pool);
+
+// Copies the item into a free slot. Handles are never 0 or InvalidID
+Mln::id_t AddPoolItem(HandlePool* pool, const void* item);
+// Null for stale, removed and invalid handles
+void* GetPoolItem(const HandlePool* pool, Mln::id_t handle);
+bool RemovePoolItem(HandlePool* pool, Mln::id_t handle);
+
+// Walks the slots from 0 to capacity, null for the empty ones
+void* GetPoolItemAt(const HandlePool* pool, int index);
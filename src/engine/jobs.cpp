@@ -0,0 +1,187 @@
+#include "jobs.hpp"
+#include "core.hpp"
+#include "HandmadeMath.h"
+
+#if !defined(PLATFORM_WEB_WASM)
+    #include <condition_variable>
+    #include <mutex>
+    #include <thread>
+#endif
+
+struct Job{
+    Mln::JobFunction function;
+    void* data;
+};
+
+#if defined(PLATFORM_WEB_WASM)
+
+// Built without a thread library, so there are no workers and no lock, WaitForJobs runs the queue
+struct {
+    Job queue[MAX_JOBS]; // Ring buffer
+    int head;
+    int queued;
+} state = {0};
+
+namespace Mln
+{
+    void InitJobs(int)
+    {
+    }
+
+    void ShutdownJobs()
+    {
+        WaitForJobs();
+    }
+
+    int GetJobThreadCount()
+    {
+        return 1;
+    }
+
+    void PushJob(JobFunction function, void* data)
+    {
+        if (state.queued < MAX_JOBS)
+        {
+            state.queue[(state.head + state.queued) % MAX_JOBS] = Job{function, data};
+            state.queued++;
+            return;
+        }
+        function(data);
+    }
+
+    void WaitForJobs()
+    {
+        while (state.queued > 0)
+        {
+            Job job = state.queue[state.head];
+            state.head = (state.head + 1) % MAX_JOBS;
+            state.queued--;
+            job.function(job.data);
+        }
+    }
+}
+
+#else
+
+constexpr int MaxJobThreads = 16;
+
+struct {
+    int worker_count;
+    std::thread workers[MaxJobThreads];
+    std::mutex mutex;
+    std::condition_variable wake; // Jobs were queued or the workers are quitting
+    std::condition_variable done; // A job finished
+    Job queue[MAX_JOBS];          // Ring buffer
+    int head;
+    int queued;
+    int running;
+    bool quitting;
+} state = {0};
+
+void _JobWorkerMain();
+void _RunNextJob(std::unique_lock<std::mutex>* lock);
+
+namespace Mln
+{
+    void InitJobs(int thread_count)
+    {
+#if defined(PLATFORM_WEB)
+        // Built without pthreads, jobs run in WaitForJobs
+        thread_count = 1;
+#endif
+        if (thread_count <= 0)
+        {
+            thread_count = (int)std::thread::hardware_concurrency();
+        }
+        // The thread waiting in WaitForJobs is one of them
+        state.worker_count = HMM_MIN(HMM_MAX(thread_count - 1, 0), MaxJobThreads);
+        state.quitting = false;
+        for (int i = 0; i < state.worker_count; i++)
+        {
+            state.workers[i] = std::thread(_JobWorkerMain);
+        }
+    }
+
+    void ShutdownJobs()
+    {
+        WaitForJobs();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.quitting = true;
+        }
+        state.wake.notify_all();
+        for (int i = 0; i < state.worker_count; i++)
+        {
+            state.workers[i].join();
+        }
+        state.worker_count = 0;
+    }
+
+    int GetJobThreadCount()
+    {
+        return state.worker_count + 1;
+    }
+
+    void PushJob(JobFunction function, void* data)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.queued < MAX_JOBS)
+            {
+                state.queue[(state.head + state.queued) % MAX_JOBS] = Job{function, data};
+                state.queued++;
+                state.wake.notify_one();
+                return;
+            }
+        }
+        function(data);
+    }
+
+    void WaitForJobs()
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        while (state.queued > 0 || state.running > 0)
+        {
+            if (state.queued > 0)
+            {
+                _RunNextJob(&lock);
+            }
+            else
+            {
+                state.done.wait(lock);
+            }
+        }
+    }
+}
+
+void _JobWorkerMain()
+{
+    std::unique_lock<std::mutex> lock(state.mutex);
+    for (;;)
+    {
+        state.wake.wait(lock, [] { return state.queued > 0 || state.quitting; });
+        if (state.queued == 0)
+        {
+            return;
+        }
+        _RunNextJob(&lock);
+    }
+}
+
+// Called and returns with the lock held, the job itself runs without it
+void _RunNextJob(std::unique_lock<std::mutex>* lock)
+{
+    Job job = state.queue[state.head];
+    state.head = (state.head + 1) % MAX_JOBS;
+    state.queued--;
+    state.running++;
+
+    lock->unlock();
+    job.function(job.data);
+    lock->lock();
+
+    state.running--;
+    state.done.notify_all();
+}
+
+#endif // PLATFORM_WEB_WASM
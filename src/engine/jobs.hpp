@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef MELON_JOBS_HPP
+#define MELON_JOBS_HPP
+
+// A few worker threads for independent CPU work, like decoding assets while the render thread uploads others.
+// Jobs run in any order and may push more jobs. The thread waiting in WaitForJobs runs queued jobs as well, so with
+// no workers (the web build, or JOB_THREADS 1) every job runs there
+
+#ifndef MAX_JOBS
+    #define MAX_JOBS 256
+#endif
+
+// Threads running jobs, the one waiting included. 0 is one per core
+#ifndef JOB_THREADS
+    #define JOB_THREADS 0
+#endif
+
+namespace Mln
+{
+    typedef void (*JobFunction)(void* data);
+
+    // InitWindow starts the workers and UnloadWindow stops them
+    void InitJobs(int thread_count);
+    void ShutdownJobs();
+    int GetJobThreadCount();
+
+    // Runs the job right away on the calling thread when the queue is full
+    void PushJob(JobFunction function, void* data);
+    // Returns once every pushed job has finished, including jobs pushed by jobs
+    void WaitForJobs();
+}
+
+#endif // MELON_JOBS_HPP
@@ -33,6 +33,13 @@ namespace Mln
         ERR_GENERIC
     };
 
+    enum PowerMode
+    {
+        POWER_MODE_ACTIVE,
+        POWER_MODE_UNFOCUSED, // Visible but in the background, frames are throttled
+        POWER_MODE_MINIMIZED, // Nothing is drawn, the loop only wakes up to keep updating
+    };
+
     typedef unsigned int id_t;
     static constexpr id_t InvalidID = -1;
 
@@ -72,6 +79,19 @@ namespace Mln
     {
         id_t id; 
     };
+
+    struct StaticBatch
+    {
+        id_t id;
+    };
+
+    struct RenderTarget
+    {
+        id_t id;
+        Texture texture; // Can be larger than the target, which covers the top left width x height texels
+        int width;
+        int height;
+    };
     
     struct Transform2D
     {
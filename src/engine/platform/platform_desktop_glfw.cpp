@@ -1,6 +1,10 @@
 #include "platform_api.hpp"
 #include "core_data.hpp"
 
+#if defined(GRAPHICS_SOFTWARE)
+    // No GL headers, nothing here draws
+    #define GLFW_INCLUDE_NONE
+#endif
 #include <GLFW/glfw3.h>
 
 #include <cstdlib>
@@ -11,6 +15,20 @@
 
 #include "core.hpp"
 
+#if defined(_WIN32)
+    // Keeps the DrawText, LoadImage and PlaySound macros of the full header away from the engine functions
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 void _FramebufferSizeCallback(GLFWwindow* window, int width, int height);
 
 using namespace Mln;
@@ -33,6 +51,11 @@ void PlatformInit()
     // ------------------------------
     glfwInit();
     
+#if defined(GRAPHICS_SOFTWARE)
+    // The CPU rasterizer needs no context. The window only delivers input, the frames stay in the software
+    // framebuffer and are read back with CaptureFramebuffer
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+#else
 #if defined (OPENGL_ES)
     glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -47,6 +70,7 @@ void PlatformInit()
 
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
 #endif
 
     // glfw window creation
@@ -58,12 +82,14 @@ void PlatformInit()
         glfwTerminate();
         return;
     }
+#if !defined(GRAPHICS_SOFTWARE)
     glfwMakeContextCurrent(gPlatform.window);
+#endif
     
     glfwSetFramebufferSizeCallback(gPlatform.window, _FramebufferSizeCallback);
 
     
-    #if !defined(PLATFORM_WEB)
+    #if !defined(PLATFORM_WEB) && !defined(GRAPHICS_SOFTWARE)
     glfwSwapInterval(1);
     #endif
 }
@@ -78,10 +104,42 @@ void PlatformSetWindowTitle(const char* title)
     glfwSetWindowTitle(gPlatform.window, title);
 }
 
+void _ReadInput();
+
 void PlatformPollInput()
 {
     glfwPollEvents();
+    _ReadInput();
+}
+
+void PlatformWaitInput(double timeout)
+{
+#if defined(PLATFORM_WEB)
+    // The browser paces the main loop, blocking in it would stall the page
+    (void)timeout;
+    glfwPollEvents();
+#else
+    glfwWaitEventsTimeout(timeout);
+#endif
+    _ReadInput();
+}
+
+bool PlatformIsWindowMinimized()
+{
+    return glfwGetWindowAttrib(gPlatform.window, GLFW_ICONIFIED) != 0;
+}
+
+bool PlatformIsWindowFocused()
+{
+#if defined(PLATFORM_WEB)
+    return true;
+#else
+    return glfwGetWindowAttrib(gPlatform.window, GLFW_FOCUSED) != 0;
+#endif
+}
 
+void _ReadInput()
+{
     for (int key = 0; key < KEY__COUNT; key++) 
     {
         gCore.input.current.keys[key] = glfwGetKey(gPlatform.window, key) == GLFW_PRESS;
@@ -117,7 +175,9 @@ void PlatformBeginFrame()
 
 void PlatformEndFrame()
 {
+#if !defined(GRAPHICS_SOFTWARE)
     glfwSwapBuffers(gPlatform.window);
+#endif
 }
 
 void PlatformInitTimer()
@@ -133,7 +193,11 @@ double PlatformGetTime()
 
 void* PlatformGetProcAddressPtr()
 {
+#if defined(GRAPHICS_SOFTWARE)
+    return nullptr;
+#else
     return (void*)glfwGetProcAddress;
+#endif
 }
 
 
@@ -184,7 +248,7 @@ bool PlatformSaveFileBinary(const char *fileName, void *data, size_t dataSize)
 {
     bool success = false;
 
-    if (fileName != NULL)
+    if (fileName == NULL)
     {
         PrintLog(LOG_ERROR, "File name not valid\n");
         return false;
@@ -204,13 +268,103 @@ bool PlatformSaveFileBinary(const char *fileName, void *data, size_t dataSize)
         // else 
         //     error = OK;
 
+        // A short write leaves a truncated file behind, which is not a success either
         int result = fclose(file);
-        success = result == 0;
+        success = count == dataSize && result == 0;
     }
 
     return success;
 }
 
+unsigned char *PlatformMapFile(const char *fileName, size_t *dataSize)
+{
+    *dataSize = 0;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    }
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        return nullptr;
+    }
+
+    // The view keeps the mapping alive on its own
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == NULL)
+    {
+        return nullptr;
+    }
+    *dataSize = (size_t)size.QuadPart;
+    return (unsigned char*)data;
+#else
+    int file = open(fileName, O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    *dataSize = (size_t)info.st_size;
+    return (unsigned char*)data;
+#endif
+}
+
+void PlatformUnmapFile(unsigned char *data, size_t dataSize)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+#else
+    munmap(data, dataSize);
+#endif
+}
+
+bool PlatformGetFileInfo(const char *fileName, size_t *dataSize, long long *modTime)
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(fileName, GetFileExInfoStandard, &info))
+    {
+        return false;
+    }
+    *dataSize = (size_t)(((unsigned long long)info.nFileSizeHigh << 32) | info.nFileSizeLow);
+    // 100 ns ticks since 1601
+    unsigned long long ticks = ((unsigned long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    *modTime = (long long)(ticks / 10000000ull) - 11644473600ll;
+    return true;
+#else
+    struct stat info;
+    if (stat(fileName, &info) != 0)
+    {
+        return false;
+    }
+    *dataSize = (size_t)info.st_size;
+    *modTime = (long long)info.st_mtime;
+    return true;
+#endif
+}
+
 char *PlatformLoadFileText(const char *fileName)
 {
     char *data = NULL;
@@ -255,7 +409,7 @@ bool PlatformSaveFileText(const char *fileName, char *text)
 {
     bool success = false;
 
-    if (fileName != NULL)
+    if (fileName == NULL)
     {
         PrintLog(LOG_ERROR, "File name not valid\n");
         return false;
@@ -277,8 +431,9 @@ bool PlatformSaveFileText(const char *fileName, char *text)
         // else 
         //     error = OK;
 
+        // A short write leaves a truncated file behind, which is not a success either
         int result = fclose(file);
-        success = result == 0;
+        success = count == textSize && result == 0;
     }
 
     return success;
@@ -287,6 +442,12 @@ bool PlatformSaveFileText(const char *fileName, char *text)
 
 void _FramebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
+    // Minimizing reports an empty framebuffer on some systems, the last size stays until the window is restored
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
     gCore.viewport.width = width;
     gCore.viewport.height = height;
     gCore.windowResized = true;
@@ -79,12 +79,35 @@ void PlatformPollInput()
     JsClearInput();
 }
 
-void BeginDrawing()
+void PlatformWaitInput(double)
 {
+    // The browser paces the main loop
+    PlatformPollInput();
+}
+
+// Nothing to map in the browser, the pack is fetched into memory like any other file
+unsigned char *PlatformMapFile(const char *fileName, size_t *dataSize)
+{
+    return PlatformLoadFileBinary(fileName, dataSize);
+}
+
+void PlatformUnmapFile(unsigned char *data, size_t)
+{
+    PlatformUnloadFileBinary(data);
+}
 
+// The server doesn't say without a request, callers treat the file as unknown
+bool PlatformGetFileInfo(const char *, size_t *, long long *)
+{
+    return false;
 }
 
-void EndDrawing()
+bool PlatformIsWindowMinimized()
 {
+    return false;
+}
 
+bool PlatformIsWindowFocused()
+{
+    return true;
 }
\ No newline at end of file
@@ -16,6 +16,10 @@ void PlatformSetWindowTitle(const char* title);
 
 void PlatformSwapScreenBuffer();
 void PlatformPollInput();
+void PlatformWaitInput(double timeout); // Like PlatformPollInput but sleeps until an event arrives or timeout seconds pass
+
+bool PlatformIsWindowMinimized();
+bool PlatformIsWindowFocused();
 
 bool PlatformWindowShouldClose();
 
@@ -32,6 +36,11 @@ void* PlatformGetProcAddressPtr();
 unsigned char *PlatformLoadFileBinary(const char *fileName, size_t *dataSize);
 void PlatformUnloadFileBinary(unsigned char *data);
 bool PlatformSaveFileBinary(const char *fileName, void *data, size_t dataSize);
+// Read only file mapped copy on write, writes to the memory stay private. Null when the file can't be mapped
+unsigned char *PlatformMapFile(const char *fileName, size_t *dataSize);
+void PlatformUnmapFile(unsigned char *data, size_t dataSize);
+// Size and last modification time in seconds without reading the file. False when there is no such file
+bool PlatformGetFileInfo(const char *fileName, size_t *dataSize, long long *modTime);
 
 char *PlatformLoadFileText(const char *fileName);
 void PlatformUnloadFileText(char *text);
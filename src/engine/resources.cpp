@@ -0,0 +1,432 @@
+#include "resources.hpp"
+#include "core.hpp"
+#include "graphics_api.hpp"
+#include "audio.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#if !defined(PLATFORM_WEB_WASM)
+    #include <mutex>
+#endif
+
+#ifndef RESOURCE_CACHE_BUCKETS
+    #define RESOURCE_CACHE_BUCKETS 256
+#endif
+
+constexpr int InitialResourceCapacity = 32;
+
+// How a path was loaded, part of the key next to the path
+enum ResourceVariant
+{
+    VARIANT_FONT_TTF = 0,
+    VARIANT_FONT_SDF = 1,
+    VARIANT_FONT_BAKE = 2,
+    VARIANT_TEXTURE_FILTER = 1, // Texture variants are these two bits
+    VARIANT_TEXTURE_MIPMAPS = 2,
+};
+
+struct ResourceEntry{
+    Mln::ResourceType type;
+    int variant;
+    uint64_t hash;
+    char* path;           // Interned copy, null while the entry is free
+    int references;
+    int next;             // Next entry in the same bucket, or the next free entry. -1 ends both
+
+    Mln::Image image;
+    Mln::Texture texture;
+    Mln::Font font;
+    Mln::Sound sound;
+};
+
+struct {
+    ResourceEntry* entries;
+    int entry_count;      // Entries handed out so far, free ones included
+    int entry_capacity;
+    int free_head;
+    int buckets[RESOURCE_CACHE_BUCKETS];
+    bool initialized;
+} state = {0};
+
+#if defined(PLATFORM_WEB_WASM)
+// Built without a thread library, every job runs on the main thread so there is nothing to lock
+struct CacheLock{
+    CacheLock() {}
+};
+#else
+// Held while the cache is read or changed but not while loading, so a slow load doesn't hold up the other threads.
+// Outside state since UnloadAllResources resets that
+std::mutex cache_mutex;
+
+struct CacheLock{
+    std::lock_guard<std::mutex> lock;
+    CacheLock() : lock(cache_mutex) {}
+};
+#endif
+
+uint64_t _HashResource(Mln::ResourceType type, int variant, const char* path);
+ResourceEntry* _FindResource(Mln::ResourceType type, int variant, const char* path, uint64_t hash);
+ResourceEntry* _AddResource(Mln::ResourceType type, int variant, const char* path, uint64_t hash);
+void _ReleaseEntry(ResourceEntry* entry);
+void _UnloadEntry(ResourceEntry* entry);
+Mln::Font _AcquireFont(const char* path, int variant, const char* ttf_path);
+
+namespace Mln
+{
+    Image AcquireImage(const char* path)
+    {
+        uint64_t hash = _HashResource(RESOURCE_IMAGE, 0, path);
+        {
+            CacheLock lock;
+            ResourceEntry* entry = _FindResource(RESOURCE_IMAGE, 0, path, hash);
+            if (entry)
+            {
+                return entry->image;
+            }
+        }
+
+        Image image = LoadImage(path);
+        if (image.data)
+        {
+            CacheLock lock;
+            ResourceEntry* entry = _FindResource(RESOURCE_IMAGE, 0, path, hash);
+            if (entry)
+            {
+                // Another thread loaded the same path meanwhile
+                UnloadImage(image);
+                return entry->image;
+            }
+            _AddResource(RESOURCE_IMAGE, 0, path, hash)->image = image;
+        }
+        return image;
+    }
+
+    Texture AcquireTexture(const char* path, bool filter, bool mipmaps)
+    {
+        int variant = (filter ? VARIANT_TEXTURE_FILTER : 0) | (mipmaps ? VARIANT_TEXTURE_MIPMAPS : 0);
+        uint64_t hash = _HashResource(RESOURCE_TEXTURE, variant, path);
+        {
+            CacheLock lock;
+            ResourceEntry* entry = _FindResource(RESOURCE_TEXTURE, variant, path, hash);
+            if (entry)
+            {
+                return entry->texture;
+            }
+        }
+
+        // Only the render thread loads textures, nothing can have added this one meanwhile
+        Texture texture = LoadTexture(path, filter, mipmaps);
+        if (texture.id != InvalidID)
+        {
+            CacheLock lock;
+            _AddResource(RESOURCE_TEXTURE, variant, path, hash)->texture = texture;
+        }
+        return texture;
+    }
+
+    Font AcquireFont(const char* path)
+    {
+        return _AcquireFont(path, VARIANT_FONT_TTF, nullptr);
+    }
+
+    Font AcquireFontSDF(const char* path)
+    {
+        return _AcquireFont(path, VARIANT_FONT_SDF, nullptr);
+    }
+
+    Font AcquireFontBake(const char* path, const char* ttf_path)
+    {
+        return _AcquireFont(path, VARIANT_FONT_BAKE, ttf_path);
+    }
+
+    Sound AcquireSound(const char* path)
+    {
+        uint64_t hash = _HashResource(RESOURCE_SOUND, 0, path);
+        {
+            CacheLock lock;
+            ResourceEntry* entry = _FindResource(RESOURCE_SOUND, 0, path, hash);
+            if (entry)
+            {
+                return entry->sound;
+            }
+        }
+
+        Sound sound = LoadSoundFromFileWave(path);
+        if (sound.id != InvalidID)
+        {
+            CacheLock lock;
+            ResourceEntry* entry = _FindResource(RESOURCE_SOUND, 0, path, hash);
+            if (entry)
+            {
+                UnloadSound(&sound);
+                return entry->sound;
+            }
+            _AddResource(RESOURCE_SOUND, 0, path, hash)->sound = sound;
+        }
+        return sound;
+    }
+
+    // Releases walk the entries instead of keeping a second index, they only happen when scenes change
+    void ReleaseImage(Image image)
+    {
+        CacheLock lock;
+        for (int i = 0; i < state.entry_count; i++)
+        {
+            ResourceEntry* entry = &state.entries[i];
+            if (entry->path && entry->type == RESOURCE_IMAGE && entry->image.data == image.data)
+            {
+                _ReleaseEntry(entry);
+                return;
+            }
+        }
+        ASSERT(false, "Image was not acquired");
+    }
+
+    void ReleaseTexture(Texture texture)
+    {
+        CacheLock lock;
+        for (int i = 0; i < state.entry_count; i++)
+        {
+            ResourceEntry* entry = &state.entries[i];
+            if (entry->path && entry->type == RESOURCE_TEXTURE && entry->texture.id == texture.id)
+            {
+                _ReleaseEntry(entry);
+                return;
+            }
+        }
+        ASSERT(false, "Texture was not acquired");
+    }
+
+    void ReleaseFont(Font font)
+    {
+        CacheLock lock;
+        for (int i = 0; i < state.entry_count; i++)
+        {
+            ResourceEntry* entry = &state.entries[i];
+            if (entry->path && entry->type == RESOURCE_FONT && entry->font == font)
+            {
+                _ReleaseEntry(entry);
+                return;
+            }
+        }
+        ASSERT(false, "Font was not acquired");
+    }
+
+    void ReleaseSound(Sound sound)
+    {
+        CacheLock lock;
+        for (int i = 0; i < state.entry_count; i++)
+        {
+            ResourceEntry* entry = &state.entries[i];
+            if (entry->path && entry->type == RESOURCE_SOUND && entry->sound.id == sound.id)
+            {
+                _ReleaseEntry(entry);
+                return;
+            }
+        }
+        ASSERT(false, "Sound was not acquired");
+    }
+
+    // Sizes are read now rather than at load, fonts keep growing as glyphs are rasterized
+    ResourceStats GetResourceStats()
+    {
+        ResourceStats stats = {};
+        CacheLock lock;
+        for (int i = 0; i < state.entry_count; i++)
+        {
+            const ResourceEntry* entry = &state.entries[i];
+            if (!entry->path)
+            {
+                continue;
+            }
+
+            size_t bytes = 0;
+            switch (entry->type)
+            {
+                case RESOURCE_IMAGE:
+                    bytes = (size_t)entry->image.width * entry->image.height * entry->image.components;
+                    break;
+                case RESOURCE_TEXTURE:
+                    bytes = (size_t)entry->texture.width * entry->texture.height * 4;
+                    if (entry->variant & VARIANT_TEXTURE_MIPMAPS)
+                    {
+                        bytes += bytes / 3;
+                    }
+                    break;
+                case RESOURCE_FONT:
+                    bytes = GetFontMemory(entry->font);
+                    break;
+                case RESOURCE_SOUND:
+                    bytes = GetSoundMemory(entry->sound);
+                    break;
+                default:
+                    break;
+            }
+
+            stats.resources[entry->type]++;
+            stats.references[entry->type] += entry->references;
+            stats.bytes[entry->type] += bytes;
+        }
+        return stats;
+    }
+
+    void UnloadAllResources()
+    {
+        CacheLock lock;
+        for (int i = 0; i < state.entry_count; i++)
+        {
+            if (state.entries[i].path)
+            {
+                _UnloadEntry(&state.entries[i]);
+            }
+        }
+        free(state.entries);
+        state = {};
+    }
+
+} // namespace Mln
+
+
+Mln::Font _AcquireFont(const char* path, int variant, const char* ttf_path)
+{
+    uint64_t hash = _HashResource(Mln::RESOURCE_FONT, variant, path);
+    {
+        CacheLock lock;
+        ResourceEntry* entry = _FindResource(Mln::RESOURCE_FONT, variant, path, hash);
+        if (entry)
+        {
+            return entry->font;
+        }
+    }
+
+    Mln::Font font = variant == VARIANT_FONT_BAKE ? LoadFontBake(path, ttf_path) : variant == VARIANT_FONT_SDF ? LoadFontSDF(path) : LoadFont(path);
+    if (font)
+    {
+        CacheLock lock;
+        _AddResource(Mln::RESOURCE_FONT, variant, path, hash)->font = font;
+    }
+    return font;
+}
+
+// FNV-1a over the path with the type and variant mixed in, like the glyph run keys
+uint64_t _HashResource(Mln::ResourceType type, int variant, const char* path)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* c = path; *c; c++)
+    {
+        hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+    }
+    hash = (hash ^ (uint64_t)type) * 1099511628211ull;
+    hash = (hash ^ (uint64_t)variant) * 1099511628211ull;
+    return hash;
+}
+
+// A hit adds the reference the caller is acquiring
+ResourceEntry* _FindResource(Mln::ResourceType type, int variant, const char* path, uint64_t hash)
+{
+    if (!state.initialized)
+    {
+        return nullptr;
+    }
+
+    for (int i = state.buckets[hash % RESOURCE_CACHE_BUCKETS]; i >= 0; i = state.entries[i].next)
+    {
+        ResourceEntry* entry = &state.entries[i];
+        if (entry->hash == hash && entry->type == type && entry->variant == variant && strcmp(entry->path, path) == 0)
+        {
+            entry->references++;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+ResourceEntry* _AddResource(Mln::ResourceType type, int variant, const char* path, uint64_t hash)
+{
+    if (!state.initialized)
+    {
+        for (int i = 0; i < RESOURCE_CACHE_BUCKETS; i++)
+        {
+            state.buckets[i] = -1;
+        }
+        state.free_head = -1;
+        state.initialized = true;
+    }
+
+    int index = state.free_head;
+    if (index >= 0)
+    {
+        state.free_head = state.entries[index].next;
+    }
+    else
+    {
+        if (state.entry_count == state.entry_capacity)
+        {
+            state.entry_capacity = state.entry_capacity ? state.entry_capacity * 2 : InitialResourceCapacity;
+            state.entries = (ResourceEntry*)realloc(state.entries, state.entry_capacity * sizeof(ResourceEntry));
+        }
+        index = state.entry_count++;
+    }
+
+    size_t length = strlen(path);
+    ResourceEntry* entry = &state.entries[index];
+    *entry = ResourceEntry{};
+    entry->type = type;
+    entry->variant = variant;
+    entry->hash = hash;
+    entry->path = (char*)malloc(length + 1);
+    memcpy(entry->path, path, length + 1);
+    entry->references = 1;
+
+    int* bucket = &state.buckets[hash % RESOURCE_CACHE_BUCKETS];
+    entry->next = *bucket;
+    *bucket = index;
+    return entry;
+}
+
+void _ReleaseEntry(ResourceEntry* entry)
+{
+    ASSERT(entry->references > 0, "Resource released more often than it was acquired");
+    if (--entry->references > 0)
+    {
+        return;
+    }
+
+    int index = (int)(entry - state.entries);
+    int* link = &state.buckets[entry->hash % RESOURCE_CACHE_BUCKETS];
+    while (*link != index)
+    {
+        ASSERT(*link >= 0, "Resource missing from its bucket");
+        link = &state.entries[*link].next;
+    }
+    *link = entry->next;
+
+    _UnloadEntry(entry);
+    *entry = ResourceEntry{};
+    entry->next = state.free_head;
+    state.free_head = index;
+}
+
+void _UnloadEntry(ResourceEntry* entry)
+{
+    switch (entry->type)
+    {
+        case Mln::RESOURCE_IMAGE:
+            Mln::UnloadImage(entry->image);
+            break;
+        case Mln::RESOURCE_TEXTURE:
+            UnloadTexture(entry->texture);
+            break;
+        case Mln::RESOURCE_FONT:
+            UnloadFont(entry->font);
+            break;
+        case Mln::RESOURCE_SOUND:
+            UnloadSound(&entry->sound);
+            break;
+        default:
+            break;
+    }
+    free(entry->path);
+    entry->path = nullptr;
+}
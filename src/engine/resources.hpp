@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef MELON_RESOURCES_HPP
+#define MELON_RESOURCES_HPP
+
+#include "melon_types.hpp"
+#include "audio.hpp"
+#include <cstddef>
+
+// Loads shared by path. Acquiring a path that is already loaded returns the same resource and adds a reference,
+// it is unloaded when the last reference is released. Resources are keyed by path and by how they were loaded, so
+// a texture with mipmaps and one without are separate. Failed loads are not cached.
+// Images and sounds can be acquired from job threads, they load outside the cache lock. Textures and fonts talk to
+// the renderer and stay on the render thread
+
+namespace Mln
+{
+    enum ResourceType
+    {
+        RESOURCE_IMAGE,
+        RESOURCE_TEXTURE,
+        RESOURCE_FONT,
+        RESOURCE_SOUND,
+        RESOURCE_TYPE__COUNT
+    };
+
+    struct ResourceStats{
+        int resources[RESOURCE_TYPE__COUNT];
+        int references[RESOURCE_TYPE__COUNT];
+        size_t bytes[RESOURCE_TYPE__COUNT]; // Resident memory, textures are counted as RGBA8
+    };
+
+    Image AcquireImage(const char* path); // Shared, the pixels must not be modified or passed to UnloadImage
+    Texture AcquireTexture(const char* path, bool filter, bool mipmaps);
+    Font AcquireFont(const char* path);
+    Font AcquireFontSDF(const char* path);
+    Font AcquireFontBake(const char* path, const char* ttf_path); // Checked against ttf_path like LoadFontBake
+    Sound AcquireSound(const char* path);
+
+    void ReleaseImage(Image image);
+    void ReleaseTexture(Texture texture);
+    void ReleaseFont(Font font);
+    void ReleaseSound(Sound sound);
+
+    ResourceStats GetResourceStats();
+    // Unloads everything still acquired, UnloadWindow calls it before the renderer shuts down
+    void UnloadAllResources();
+
+} // namespace Mln
+
+#endif // MELON_RESOURCES_HPP
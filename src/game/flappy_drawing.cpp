@@ -2,111 +2,66 @@
 #include "HandmadeMath.h"
 #include "graphics_api.hpp"
 #include "melon_types.hpp"
+#include "sprite_atlas_bake.hpp"
 #include "stb_rect_pack.h"
 
 #include <cstring>
 #include <cassert>
 #include "core.hpp"
+#include "jobs.hpp"
 
 #include "graphics_api.hpp"
 
+#include <cstdint>
+
 constexpr unsigned int MaxSpriteSheetSize = 1024 * 2;
+constexpr int MaxBakeLevels = 16;
 
 struct {
     Mln::Texture sprite_atlas_texture;
     int sprite_coords[SpriteAtlas::Sprite::_LENGTH][4];
+
+    // Filled by the DecodeSpriteAtlas jobs, LoadSpriteAtlas uploads them
+    bool decoded;
+    unsigned char* bake;  // The bake file the levels point into, null when the PNGs were decoded instead
+    Mln::Image bake_levels[MaxBakeLevels];
+    int bake_level_count;
+    Mln::Image images[SpriteAtlas::Sprite::_LENGTH];
 } state;
 
+void _DecodeSpriteAtlasJob(void*);
+void _DecodeSpriteJob(void* data);
+bool _DecodeSpriteAtlasBake(const char* path);
 
-void FeatherEdges(Mln::Image image, int feather_amount)
+void DecodeSpriteAtlas()
 {
-    ASSERT(image.data, "Feathering only supported for valid images");
-    ASSERT(image.components == 4, "Feathering only supported for images with 4 components");
-
-    Mln::Image temp_image = Mln::CreateImage(image.width, image.height, image.components);
+    state.decoded = true;
+    Mln::PushJob(_DecodeSpriteAtlasJob, nullptr);
+}
 
-    struct Pixel4
+void LoadSpriteAtlas()
+{
+    if (!state.decoded)
     {
-        unsigned char r;
-        unsigned char g;
-        unsigned char b;
-        unsigned char a;
-    };
-
-    Pixel4* pixels = (Pixel4*)image.data;
-    Pixel4* out_pixels = (Pixel4*)temp_image.data;
+        DecodeSpriteAtlas();
+        Mln::WaitForJobs();
+    }
+    state.decoded = false;
 
-    for (int j = 0; j < image.height; j++)
+    if (state.bake)
     {
-        for (int i = 0; i < image.width; i++)
-        {
-            int index = i + j * image.width;
-            if (pixels[index].a != 0)
-            {
-                out_pixels[index] = pixels[index];
-                continue;
-            }
-
-            bool has_neighbour = false;
-            int close_offset_x = 0;
-            int close_offset_y = 0;
-
-            for (int off_y = -feather_amount; off_y < feather_amount; off_y++)
-            {
-                int neighbour_y = j + off_y;
-                if (neighbour_y < 0 || neighbour_y >= image.height)
-                {
-                    continue;
-                }
-
-                for (int off_x = -feather_amount; off_x < feather_amount; off_x++)
-                {
-                    int neighbour_x = i + off_x;
-                    if (neighbour_x < 0 || neighbour_x >= image.width)
-                    {
-                        continue;
-                    }
-
-                    int neighbour_index = neighbour_x + neighbour_y * image.width;
-                    if (pixels[neighbour_index].a == 0)
-                    {
-                        continue;
-                    }
-
-                    if (!has_neighbour || off_x * off_x + off_y * off_y < close_offset_x * close_offset_x + close_offset_y * close_offset_y)
-                    {
-                        has_neighbour = true;
-                        close_offset_x = off_x;
-                        close_offset_y = off_y;
-                    }
-                }
-            }
-            
-            if (has_neighbour)
-            {
-                int neighbour_index = (i + close_offset_x) + (j + close_offset_y) * image.width;
-                out_pixels[index] = pixels[neighbour_index];
-                out_pixels[index].a = 0;
-            }
-        }
+        state.sprite_atlas_texture = ::LoadTextureFromMipChain(state.bake_levels, state.bake_level_count, true);
+        Mln::UnloadFileBinary(state.bake);
+        state.bake = nullptr;
+        return;
     }
-    memcpy(image.data, temp_image.data, image.width * image.height * image.components * sizeof(unsigned char));
-    Mln::UnloadImage(temp_image);
-}
 
-void LoadSpriteAtlas()
-{
+    // Without a bake from tools/atlas_baker the decoded PNGs are packed here
     constexpr int padding = 2;
-    Mln::Image images[SpriteAtlas::Sprite::_LENGTH];
+    Mln::Image* images = state.images;
     stbrp_rect pack_rects[SpriteAtlas::Sprite::_LENGTH];
     for (int i = 0; i < SpriteAtlas::Sprite::_LENGTH; i++)
     {
-        char buffer[256];
-        buffer[0] = 0;
-        strncat(buffer, RESOURCES_PATH, 255);
-        strncat(buffer, SpriteAtlas::file_list[i], 255);
-        buffer[255] = 0;
-        images[i] = Mln::LoadImage(buffer);
         pack_rects[i].w = images[i].width + padding * 2;
         pack_rects[i].h = images[i].height + padding * 2;
     }
@@ -135,17 +90,16 @@ void LoadSpriteAtlas()
         Mln::ImageDrawImage(image, dst_rect, images[i], src_rect);
 
         Mln::UnloadImage(images[i]);
+        images[i] = Mln::Image{};
     }
 
-    // TODO: Use premultiplied alpha instead
-#if defined(FEATHER_SPRITE_ATLAS)
-    FeatherEdges(image, 5);
-#endif
-
 #if defined(GENERATE_SPRITE_ATLAS)
     Mln::WriteImage(image, "demo.png");
 #endif
 
+    // Premultiplied once here so filtering and mipmaps never pull in the color of transparent texels
+    Mln::ImagePremultiplyAlpha(image);
+
     state.sprite_atlas_texture = ::LoadTextureFromImage(image, true, true);
     Mln::UnloadImage(image);
 }
@@ -173,8 +127,31 @@ void DrawSprite(Mln::Vector2 position, Mln::Vector2 size, Mln::Color color, Spri
 
 void DrawSprite(Mln::Transform2D transform, Mln::Color color, SpriteAtlas::Sprite sprite)
 {
-    Mln::Matrix matrix = HMM_Translate({transform.position.X, transform.position.Y, 0.f}) * HMM_Rotate_LH(transform.rotation, {0.f, 0.f, 1.f}) * HMM_Scale({transform.scale.X, transform.scale.Y, 1.f});
-    DrawSprite(matrix, color, sprite);
+    int sprite_x = state.sprite_coords[sprite][0];
+    int sprite_y = state.sprite_coords[sprite][1];
+    int sprite_w = state.sprite_coords[sprite][2];
+    int sprite_h = state.sprite_coords[sprite][3];
+    DrawRectTexturedInstanced(transform, state.sprite_atlas_texture, Mln::RectI{sprite_x, sprite_y, sprite_w, sprite_h}, color);
+}
+
+void DrawSprites(const SpriteInstance* instances, int count)
+{
+    TexturedRect rects[128];
+    while (count > 0)
+    {
+        int chunk = count < 128 ? count : 128;
+        for (int i = 0; i < chunk; i++)
+        {
+            SpriteAtlas::Sprite sprite = instances[i].sprite;
+            rects[i].transform = instances[i].transform;
+            rects[i].texture_source = Mln::RectI{state.sprite_coords[sprite][0], state.sprite_coords[sprite][1], state.sprite_coords[sprite][2], state.sprite_coords[sprite][3]};
+            rects[i].color = instances[i].color;
+        }
+        DrawRectsTextured(state.sprite_atlas_texture, rects, chunk);
+
+        instances += chunk;
+        count -= chunk;
+    }
 }
 
 void DrawSprite(Mln::Matrix transform, Mln::Color color, SpriteAtlas::Sprite sprite)
@@ -202,4 +179,73 @@ void DrawSpriteNinePatch(Mln::Rect rect, Mln::Color color, SpriteAtlas::Sprite s
     int sprite_w = state.sprite_coords[sprite][2];
     int sprite_h = state.sprite_coords[sprite][3];
     DrawRectTexturedNinePatch(HMM_M4D(1.0f), rect, state.sprite_atlas_texture, Mln::RectI{sprite_x, sprite_y, sprite_w, sprite_h}, color, offsets);
-}
\ No newline at end of file
+}
+
+void _DecodeSpriteAtlasJob(void*)
+{
+    if (_DecodeSpriteAtlasBake(RESOURCES_PATH SPRITE_ATLAS_BAKE_FILE))
+    {
+        return;
+    }
+
+    // The PNGs are independent, each one is a job of its own
+    for (int i = 0; i < SpriteAtlas::Sprite::_LENGTH; i++)
+    {
+        Mln::PushJob(_DecodeSpriteJob, (void*)(intptr_t)i);
+    }
+}
+
+void _DecodeSpriteJob(void* data)
+{
+    int sprite = (int)(intptr_t)data;
+    char buffer[256];
+    buffer[0] = 0;
+    strncat(buffer, RESOURCES_PATH, 255);
+    strncat(buffer, SpriteAtlas::file_list[sprite], 255);
+    buffer[255] = 0;
+    state.images[sprite] = Mln::LoadImage(buffer);
+}
+
+// Keeps the file when it is valid, LoadSpriteAtlas uploads the levels from it
+bool _DecodeSpriteAtlasBake(const char* path)
+{
+    size_t size = 0;
+    unsigned char* file = Mln::LoadFileBinary(path, &size);
+    if (!file)
+    {
+        return false;
+    }
+
+    SpriteAtlasBakeHeader header = {};
+    if (size >= sizeof(header))
+    {
+        memcpy(&header, file, sizeof(header));
+    }
+
+    // The levels are validated against the file size before anything points into it
+    size_t expected = sizeof(header) + sizeof(state.sprite_coords);
+    bool valid = header.magic == SpriteAtlasBakeMagic && header.version == SpriteAtlasBakeVersion && header.file_list_hash == HashSpriteFileList()
+              && header.sprite_count == SpriteAtlas::Sprite::_LENGTH && header.level_count > 0 && header.level_count <= MaxBakeLevels
+              && header.width > 0 && header.height > 0 && header.width <= (int)MaxSpriteSheetSize && header.height <= (int)MaxSpriteSheetSize;
+
+    Mln::Image* levels = state.bake_levels;
+    for (int i = 0; valid && i < header.level_count; i++)
+    {
+        int width = HMM_MAX(header.width >> i, 1);
+        int height = HMM_MAX(header.height >> i, 1);
+        levels[i] = Mln::Image{file + expected, width, height, 4};
+        expected += (size_t)width * height * 4;
+    }
+    valid = valid && expected == size && levels[header.level_count - 1].width == 1 && levels[header.level_count - 1].height == 1;
+    if (!valid)
+    {
+        Mln::PrintLog(LOG_WARNING, "Sprite atlas bake %s is out of date, packing the sprites instead\n", path);
+        Mln::UnloadFileBinary(file);
+        return false;
+    }
+
+    memcpy(state.sprite_coords, file + sizeof(header), sizeof(state.sprite_coords));
+    state.bake = file;
+    state.bake_level_count = header.level_count;
+    return true;
+}
@@ -6,6 +6,9 @@
 #include "melon_types.hpp"
 #include "sprite_atlas.hpp"
 
+// Pushes the jobs reading the bake or decoding the PNGs without it, LoadSpriteAtlas uploads them after WaitForJobs.
+// LoadSpriteAtlas alone decodes first and waits for the jobs itself
+void DecodeSpriteAtlas();
 void LoadSpriteAtlas();
 void UnloadSpriteAtlas();
 Mln::Vector2 GetSpriteSize(SpriteAtlas::Sprite sprite);
@@ -15,6 +18,14 @@ void DrawSprite(Mln::Vector2 position, Mln::Vector2 size, Mln::Color color, Spri
 void DrawSprite(Mln::Transform2D transform, Mln::Color color, SpriteAtlas::Sprite sprite);
 void DrawSprite(Mln::Matrix transform, Mln::Color color, SpriteAtlas::Sprite sprite);
 
+struct SpriteInstance{
+    Mln::Transform2D transform;
+    Mln::Color color;
+    SpriteAtlas::Sprite sprite;
+};
+// Same as calling DrawSprite with a Transform2D for each instance, with the transforms batched
+void DrawSprites(const SpriteInstance* instances, int count);
+
 void DrawSpriteNinePatch(Mln::Matrix transform, Mln::Rect rect, Mln::Color color, SpriteAtlas::Sprite sprite, Mln::Vector4 offsets);
 void DrawSpriteNinePatch(Mln::Rect rect, Mln::Color color, SpriteAtlas::Sprite sprite, Mln::Vector4 offsets);
 
@@ -2,6 +2,8 @@
 #include "HandmadeMath.h"
 #include "audio.hpp"
 #include "core.hpp"
+#include "resources.hpp"
+#include "jobs.hpp"
 #include "game/sprite_atlas.hpp"
 #include "keys.h"
 #include <cmath>
@@ -57,6 +59,16 @@ float DampAngle(float a, float b, float smoothing, float delta)
 namespace Game
 {
     void TriggerGameOver();
+    Font LoadGameFont(const char* ttf_path, const char* bake_path, bool sdf);
+    struct SoundJob{
+        const char* path;
+        Sound* sound;
+    };
+    void LoadSoundJob(void* data); // data is a SoundJob
+
+    void DrawBackground(float player_ratio);
+    void RenderGameOverPanel(Rect panel_rect, Rect button_rect);
+    void GetGameOverLayout(Rect* panel_rect, Rect* button_rect, Vector2* button_text_position);
 
     void ChangeSceneTo(const Scene* scene);
 
@@ -100,16 +112,34 @@ void Game::Init()
     state.view_matrix = HMM_Translate({viewportSize.X / 2, viewportSize.Y / 2, 0}) * HMM_Scale({state.game_scale, state.game_scale, 1.f});
     SetView(state.view_matrix);
 
-    state.coin_sound = LoadSoundFromFileWave(RESOURCES_PATH "coin.wav");
-    state.hurt_sound = LoadSoundFromFileWave(RESOURCES_PATH "hurt.wav");
-    state.jump_sound = LoadSoundFromFileWave(RESOURCES_PATH "jump.wav");
+    // Sounds and the sprite atlas decode on the job threads while this thread loads the fonts, which upload their
+    // glyph pages as they load. The atlas is uploaded once the jobs are done
+    double start_time = GetTime();
+    SoundJob sound_jobs[] = {
+        {RESOURCES_PATH "coin.wav", &state.coin_sound},
+        {RESOURCES_PATH "hurt.wav", &state.hurt_sound},
+        {RESOURCES_PATH "jump.wav", &state.jump_sound},
+    };
+    for (SoundJob& job : sound_jobs)
+    {
+        PushJob(LoadSoundJob, &job);
+    }
+    DecodeSpriteAtlas();
 
+    state.pixel_font = LoadGameFont(RESOURCES_PATH "Kenney Pixel.ttf", RESOURCES_PATH "Kenney Pixel.fontbake", false);
+    state.font = LoadGameFont(RESOURCES_PATH "Kenney Future Narrow.ttf", RESOURCES_PATH "Kenney Future Narrow.fontbake", true);
+    double fonts_time = GetTime();
+
+    WaitForJobs();
+    double decode_time = GetTime();
 
-    state.pixel_font = LoadFont(RESOURCES_PATH "Kenney Pixel.ttf");
-    state.font = LoadFont(RESOURCES_PATH "Kenney Future Narrow.ttf");
-    
     LoadSpriteAtlas();
+    double upload_time = GetTime();
+    PrintLog(LOG_INFO, "Startup on %d threads: fonts %.1f ms, decoding %.1f ms, upload %.1f ms, %.1f ms in total\n", GetJobThreadCount(),
+             (fonts_time - start_time) * 1000.0, (decode_time - start_time) * 1000.0, (upload_time - decode_time) * 1000.0, (upload_time - start_time) * 1000.0);
 
+    state.background_batch = CreateStaticBatch();
+    state.game_over_target = RenderTarget{InvalidID};
 
     ChangeSceneTo(&MainMenuScene);
 }
@@ -126,6 +156,9 @@ void Game::Update(float delta)
         state.game_scale = HMM_MIN(horizontal_scale, vertical_scale);
         state.view_matrix = HMM_Translate({viewportSize.X / 2, viewportSize.Y / 2, 0}) * HMM_Scale({state.game_scale, state.game_scale, 1.f});
         SetView(state.view_matrix);
+
+        // The panel is rendered at screen resolution
+        state.game_over_dirty = true;
     }
 
     state.current_scene->Update(delta);
@@ -143,23 +176,171 @@ void Game::Unload()
 {
     state.current_scene->Unload();
 
-    UnloadFont(state.font);
-    UnloadFont(state.pixel_font);
+    UnloadStaticBatch(state.background_batch);
+    if (state.game_over_target.id != InvalidID)
+    {
+        UnloadRenderTarget(state.game_over_target);
+    }
+
+    ReleaseFont(state.font);
+    ReleaseFont(state.pixel_font);
+    ReleaseSound(state.coin_sound);
+    ReleaseSound(state.hurt_sound);
+    ReleaseSound(state.jump_sound);
     UnloadSpriteAtlas();
 }
 
-void Game::DrawGap(Vector2 position)
+// Runs on a job thread, sounds are safe to acquire from there
+void Game::LoadSoundJob(void* data)
 {
-    float bottom_border = position.Y + GAP_HEIGHT * 0.5f;
-    float top_border = position.Y - GAP_HEIGHT * 0.5f;
-    
+    SoundJob* job = (SoundJob*)data;
+    *job->sound = AcquireSound(job->path);
+}
+
+// The bake next to the TTF starts the font with its glyphs already rasterized. Without one the printable ASCII range
+// is rasterized once and baked for the next launch, a bake made from an older version of the TTF is baked again
+Font Game::LoadGameFont(const char* ttf_path, const char* bake_path, bool sdf)
+{
+    Font font = AcquireFontBake(bake_path, ttf_path);
+    if (font)
+    {
+        return font;
+    }
+
+    font = sdf ? AcquireFontSDF(ttf_path) : AcquireFont(ttf_path);
+    if (font)
+    {
+        char ascii[96];
+        for (int i = 0; i < 95; i++)
+        {
+            ascii[i] = (char)(' ' + i);
+        }
+        ascii[95] = '\0';
+        MeasureText(font, ascii);
+        SaveFontBake(font, bake_path);
+    }
+    return font;
+}
+
+void Game::DrawGaps(const Vector2* positions, int count)
+{
+    ASSERT(count <= WALL_COUNT, "More gaps than walls");
     Vector2 spriteSize = GetSpriteSize(SpriteAtlas::WALL);
-    
-    DrawSprite(Mln::Transform2D{{position.X, bottom_border + spriteSize.Y / 2.f}, {1.f, 1.f}, 0}, {0, 0, 0, 0}, SpriteAtlas::WALL);
-    DrawSprite(Mln::Transform2D{{position.X, top_border - spriteSize.Y / 2.f}, {1.f, 1.f}, HMM_PI32}, {0, 0, 0, 0}, SpriteAtlas::WALL);
+
+    SpriteInstance sprites[2 * WALL_COUNT];
+    for (int i = 0; i < count; i++)
+    {
+        float bottom_border = positions[i].Y + GAP_HEIGHT * 0.5f;
+        float top_border = positions[i].Y - GAP_HEIGHT * 0.5f;
+
+        sprites[2 * i + 0] = SpriteInstance{Mln::Transform2D{{positions[i].X, bottom_border + spriteSize.Y / 2.f}, {1.f, 1.f}, 0}, {0, 0, 0, 0}, SpriteAtlas::WALL};
+        sprites[2 * i + 1] = SpriteInstance{Mln::Transform2D{{positions[i].X, top_border - spriteSize.Y / 2.f}, {1.f, 1.f}, HMM_PI32}, {0, 0, 0, 0}, SpriteAtlas::WALL};
+    }
+    DrawSprites(sprites, 2 * count);
+}
+
+
+
+void Game::DrawBackground(float player_ratio)
+{
+    // The three tiles only ever move together, they are recorded once and scrolled as a whole
+    if (IsStaticBatchDirty(state.background_batch))
+    {
+        float background_size = floorf(GAME_HEIGHT * 1.2f);
+
+        BeginStaticBatch(state.background_batch);
+        DrawSprite({-background_size + 1, 0}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
+        DrawSprite({0, 0}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
+        DrawSprite({background_size - 1, 0}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
+        EndStaticBatch();
+    }
+
+    SetDrawLayer(LAYER_BACKGROUND);
+    DrawStaticBatch(state.background_batch, HMM_Translate({state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f, 0.f}), WHITE);
 }
 
+void Game::RenderGameOverPanel(Rect panel_rect, Rect button_rect)
+{
+    int width = (int)ceilf(panel_rect.width * state.game_scale);
+    int height = (int)ceilf(panel_rect.height * state.game_scale);
+    if (state.game_over_target.id == InvalidID || state.game_over_target.width != width || state.game_over_target.height != height)
+    {
+        if (state.game_over_target.id != InvalidID)
+        {
+            UnloadRenderTarget(state.game_over_target);
+        }
+        state.game_over_target = LoadRenderTarget(width, height);
+    }
+
+    BeginRenderTarget(state.game_over_target);
+    ClearBackground(NO_COLOR);
+    SetProjection(HMM_Orthographic_LH_NO(0, (float)width, (float)height, 0, -1.f, 1.f));
+    SetView(HMM_Scale({state.game_scale, state.game_scale, 1.f}) * HMM_Translate({-panel_rect.x, -panel_rect.y, 0.f}));
+    SetDrawLayer(LAYER_UI);
+
+    DrawSpriteNinePatch(panel_rect, NO_COLOR, SpriteAtlas::BLUE_FRAME, Mln::Vector4{20, 20, 20, 20});
+
+    Vector2 panel_center_top = {panel_rect.x + panel_rect.width / 2.f, panel_rect.y};
+    Vector2 position = panel_center_top;
+    position.Y += 15;
+
+    position.Y += 20;
+    Vector2 coin_size = GetSpriteSize(SpriteAtlas::GOLD);
+    position.Y += coin_size.Y / 2.f;
+    DrawSprite({position + Vector2{-(coin_size.X + 12), 15}, {1.f, 1.f},  HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::COIN_SLOT);
+    if (state.score >= 5)
+    {
+        DrawSprite({position + Vector2{-(coin_size.X + 12), 15}, {1.f, 1.f},  HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::BRONZE);
+    }
+
+    DrawSprite({position, {1.f, 1.f}, 0.f}, NO_COLOR, SpriteAtlas::COIN_SLOT);
+    if (state.score >= 20) 
+    {
+        DrawSprite({position, {1.f, 1.f}, 0.f}, NO_COLOR, SpriteAtlas::GOLD);
+    }
+    
+    DrawSprite({position + Vector2{ (coin_size.X + 12), 15}, {1.f, 1.f}, -HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::COIN_SLOT);
+    if (state.score >= 10)
+    {
+        DrawSprite({position + Vector2{ (coin_size.X + 12), 15}, {1.f, 1.f}, -HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::SILVER);
+    }
+    position.Y += coin_size.Y / 2.f;
+    
+    position.Y += 15;
+    position.Y += 30;
+    position.Y += 30; // TODO: Get font height measurements
+    DrawText(state.font, TextFormat("Score: %d", state.score), position, 1.f, TEXT_COLOR, TEXT_ALIGN_CENTER);
+
+    position.Y += 20;
+    position.Y += 30; // TODO: Get font height measurements
+    if (state.new_high_score)
+    {
+        DrawText(state.font, "New Record!", position, 1.f, YELLOW, TEXT_ALIGN_CENTER);
+    }
+    else
+    {
+        DrawText(state.font, TextFormat("High-Score: %d", state.high_score), position, 1.f, TEXT_COLOR, TEXT_ALIGN_CENTER);
+    }
+
+    DrawSpriteNinePatch(button_rect, NO_COLOR, SpriteAtlas::BUTTON_PANEL, {10, 10, 10, 20});
 
+    EndRenderTarget();
+    state.game_over_dirty = false;
+}
+
+void Game::GetGameOverLayout(Rect* panel_rect, Rect* button_rect, Vector2* button_text_position)
+{
+    Vector2 panel_position = {0, 25};
+    Vector2 panel_size = {420, 450};
+    *panel_rect = {panel_position.X - panel_size.X / 2.f, panel_position.Y - panel_size.Y / 2.f, panel_size.X, panel_size.Y};
+
+    Vector2 panel_center_bottom = {panel_position.X, panel_position.Y + panel_size.Y / 2.f};
+    Vector2 bottom_position = panel_center_bottom;
+    bottom_position.Y -= 50;
+    float text_width = MeasureText(state.font, "Play Again!");
+    *button_rect = {bottom_position.X - (text_width + 30) / 2.f, bottom_position.Y - 12 - (60) / 2.0f, text_width + 30, 60};
+    *button_text_position = bottom_position;
+}
 
 void Game::TriggerGameOver()
 {
@@ -178,6 +359,8 @@ void Game::TriggerGameOver()
         state.new_high_score = true;
     }
 
+    state.game_over_dirty = true;
+
 }
 
 void Game::ChangeSceneTo(const Scene *scene)
@@ -245,18 +428,12 @@ void Game::DrawSceneMainMenu()
 {
     float player_ratio = sinf(state.game_time * 0.9f) * 0.25f;
 
-    float background_size = floorf(GAME_HEIGHT * 1.2f);
+    DrawBackground(player_ratio);
 
-    DrawSprite({-background_size + 1 + state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
-    DrawSprite({state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
-    DrawSprite({background_size - 1 + state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
-
-    // for (int i = 0; i < state.active_walls; i++)
-    // {
-    //     DrawGap(state.walls[i]);
-    // }
+    // DrawGaps(state.walls, state.active_walls);
 
 
+    SetDrawLayer(LAYER_UI_TEXT);
     DrawText(state.font, "FLAPPY ALIEN", {0, GAME_HEIGHT * -0.5f + 100}, 1.2f, TEXT_COLOR, TEXT_ALIGN_CENTER);
     DrawText(state.font, "Press SPACE to start", {0, 0}, 1.0f, {TEXT_COLOR.RGB, 0.75f}, TEXT_ALIGN_CENTER);
 }
@@ -282,6 +459,7 @@ void Game::InitSceneGame()
     state.score = 0;
     state.new_high_score = false;
     state.death_time = 0;
+    state.button_hovered = false;
 
     state.background_scroll = 0.f;
 }
@@ -406,6 +584,33 @@ void Game::UpdateSceneGame(float delta)
     }
 
 
+    // Game over screen
+    if (state.is_game_over)
+    {
+        Rect panel_rect, button_rect;
+        Vector2 button_text_position;
+        GetGameOverLayout(&panel_rect, &button_rect, &button_text_position);
+
+        Vector2 world_mouse_position = InvTransformVector(state.view_matrix, GetMousePosition());
+        bool was_hovered = state.button_hovered;
+        state.button_hovered = world_mouse_position.X > button_rect.x && world_mouse_position.X < button_rect.x + button_rect.width
+            && world_mouse_position.Y > button_rect.y && world_mouse_position.Y < button_rect.y + button_rect.height;
+
+        if (state.button_hovered && IsMouseButtonJustPressed(MOUSE_BUTTON_LEFT))
+        {
+            ChangeSceneTo(&GameScene);
+            return;
+        }
+
+        // Once the player and the wings have fallen out of view only the button hover changes the screen
+        float screen_bottom = (Mln::GetViewportSize().Y / state.game_scale) * 0.5f + 100;
+        if (state.player_position.Y > screen_bottom && state.wing_position.Y > screen_bottom && state.button_hovered == was_hovered && !state.game_over_dirty)
+        {
+            MarkFrameUnchanged();
+        }
+    }
+
+
     // if (state.is_game_over && state.game_time > state.death_time + 5.f)
     // {
     //     ChangeSceneTo(&GameScene);
@@ -416,23 +621,18 @@ void Game::DrawSceneGame()
 {
     
     float player_ratio = HMM_Clamp(-1, state.player_position.Y / (GAME_HEIGHT * 0.5f), 1);
-    float background_size = floorf(GAME_HEIGHT * 1.2f);
+    DrawBackground(player_ratio);
 
-    DrawSprite({-background_size + 1 + state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
-    DrawSprite({state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
-    DrawSprite({background_size - 1 + state.background_scroll, -player_ratio * GAME_HEIGHT * 0.1f}, {background_size, background_size}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::BACKGROUND_1));
 
 
-
-    for (int i = 0; i < state.active_walls; i++)
-    {
-        DrawGap(state.walls[i]);
-    }
+    SetDrawLayer(LAYER_WALLS);
+    DrawGaps(state.walls, state.active_walls);
     
     
     Mln::Transform2D playerTransform = Mln::Transform2D{state.player_position, {.5f, .5f}, state.player_rotation};
     Matrix playerMatrix = Mln::GetMatrix(playerTransform);
     Matrix wingMatrix = playerMatrix * HMM_Rotate_LH(state.wing_rotation, {0.f, 0.f, 1.f}) * Mln::GetMatrix(Mln::Transform2D{Vector2{-50.f , 2.f}, {1.2f, 1.2f}, 0});
+    SetDrawLayer(LAYER_WINGS);
     if (state.is_game_over)
     {
         DrawSprite(Mln::Transform2D{state.wing_position, {.5f * 1.2f, .5f * 1.2f}, state.wing_rotation}, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(SpriteAtlas::WINGS));
@@ -447,10 +647,12 @@ void Game::DrawSceneGame()
     {
         playerSprite = SpriteAtlas::PLAYER_HIT;
     }
+    SetDrawLayer(LAYER_PLAYER);
     DrawSprite(playerMatrix, {0, 0, 0, 0}, static_cast<SpriteAtlas::Sprite>(playerSprite));
 
 
     
+    SetDrawLayer(LAYER_HUD);
     const char* score_text = TextFormat("%d", state.score);
     DrawText(state.font, score_text, {0, -GAME_HEIGHT / 2.0f + 48}, 1.f, TEXT_COLOR, TEXT_ALIGN_CENTER);
 
@@ -460,82 +662,28 @@ void Game::DrawSceneGame()
     // std::snprintf(buffer, 64, "%02.f", floorf(fmodf(state.game_time, 60.f)));
     // DrawText(state.font, buffer, {10, -GAME_HEIGHT / 2.0f + 48}, 1.f, TEXT_COLOR, TEXT_ALIGN_LEFT);
 
-    Vector2 world_mouse_position = InvTransformVector(state.view_matrix, GetMousePosition());
-
     if (state.is_game_over)
     {
-        Vector2 panel_position = {0, 25};
-        Vector2 panel_size = {420, 450};
-        Rect panel_rect = {panel_position.X - panel_size.X / 2.f, panel_position.Y - panel_size.Y / 2.f, panel_size.X, panel_size.Y};
-        DrawSpriteNinePatch(panel_rect, NO_COLOR, SpriteAtlas::BLUE_FRAME, Mln::Vector4{20, 20, 20, 20});
-
-        Vector2 panel_center_top = {panel_position.X, panel_position.Y - panel_size.Y / 2.f};
-        Vector2 position = panel_center_top;
-        position.Y += 15;
-
-        position.Y += 20;
-        Vector2 coin_size = GetSpriteSize(SpriteAtlas::GOLD);
-        position.Y += coin_size.Y / 2.f;
-        DrawSprite({position + Vector2{-(coin_size.X + 12), 15}, {1.f, 1.f},  HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::COIN_SLOT);
-        if (state.score >= 5)
-        {
-            DrawSprite({position + Vector2{-(coin_size.X + 12), 15}, {1.f, 1.f},  HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::BRONZE);
-        }
+        Rect panel_rect, button_rect;
+        Vector2 bottom_position;
+        GetGameOverLayout(&panel_rect, &button_rect, &bottom_position);
 
-        DrawSprite({position, {1.f, 1.f}, 0.f}, NO_COLOR, SpriteAtlas::COIN_SLOT);
-        if (state.score >= 20) 
+        // Everything but the hover state of the button is fixed once the round is over
+        if (state.game_over_dirty)
         {
-            DrawSprite({position, {1.f, 1.f}, 0.f}, NO_COLOR, SpriteAtlas::GOLD);
+            RenderGameOverPanel(panel_rect, button_rect);
         }
-        
-        DrawSprite({position + Vector2{ (coin_size.X + 12), 15}, {1.f, 1.f}, -HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::COIN_SLOT);
-        if (state.score >= 10)
-        {
-            DrawSprite({position + Vector2{ (coin_size.X + 12), 15}, {1.f, 1.f}, -HMM_PI32 * 0.1f}, NO_COLOR, SpriteAtlas::SILVER);
-        }
-        position.Y += coin_size.Y / 2.f;
-        
-        position.Y += 15;
-        position.Y += 30;
-        position.Y += 30; // TODO: Get font height measurements
-        DrawText(state.font, TextFormat("Score: %d", state.score), position, 1.f, TEXT_COLOR, TEXT_ALIGN_CENTER);
-
-        position.Y += 20;
-        position.Y += 30; // TODO: Get font height measurements
-        if (state.new_high_score)
-        {
-            DrawText(state.font, "New Record!", position, 1.f, YELLOW, TEXT_ALIGN_CENTER);
-        }
-        else
-        {
-            DrawText(state.font, TextFormat("High-Score: %d", state.high_score), position, 1.f, TEXT_COLOR, TEXT_ALIGN_CENTER);
-        }
-
-        Vector2 panel_center_bottom = {panel_position.X, panel_position.Y + panel_size.Y / 2.f};
-        Vector2 bottom_position = panel_center_bottom;
-        bottom_position.Y -= 50;
-        float text_width = MeasureText(state.font, "Play Again!");
-        Rect button_rect = {bottom_position.X - (text_width + 30) / 2.f, bottom_position.Y - 12 - (60) / 2.0f, text_width + 30, 60};
-
-        DrawSpriteNinePatch(button_rect, NO_COLOR, SpriteAtlas::BUTTON_PANEL, {10, 10, 10, 20});
+        float target_width = state.game_over_target.width / state.game_scale;
+        float target_height = state.game_over_target.height / state.game_scale;
+        Matrix panel_matrix = HMM_Translate({panel_rect.x + target_width / 2.f, panel_rect.y + target_height / 2.f, 0.f}) * HMM_Scale({1.f / state.game_scale, 1.f / state.game_scale, 1.f});
+        SetDrawLayer(LAYER_UI);
+        DrawRectTextured(panel_matrix, state.game_over_target.texture, RectI{0, 0, state.game_over_target.width, state.game_over_target.height}, NO_COLOR);
         
         Color button_text_color = {TEXT_COLOR.RGB, 0.8f};
         Color button_hovered_text_color = TEXT_COLOR;
-        bool button_hovered = false;
-        if (world_mouse_position.X > button_rect.x && world_mouse_position.X < button_rect.x + button_rect.width
-            && world_mouse_position.Y > button_rect.y && world_mouse_position.Y < button_rect.y + button_rect.height)
-        {
-            button_hovered = true;
-        }
-
-        DrawText(state.font, "Play Again!", bottom_position, 1.f, button_hovered ? button_hovered_text_color : button_text_color, TEXT_ALIGN_CENTER);
-
-        if (button_hovered && IsMouseButtonJustPressed(MOUSE_BUTTON_LEFT))
-        {
-            ChangeSceneTo(&GameScene);
-
-        }
 
+        SetDrawLayer(LAYER_UI_TEXT);
+        DrawText(state.font, "Play Again!", bottom_position, 1.f, state.button_hovered ? button_hovered_text_color : button_text_color, TEXT_ALIGN_CENTER);
     }
 
 }
@@ -29,6 +29,18 @@ namespace Game{
 
     constexpr Mln::Color TEXT_COLOR = WHITE;
 
+    // Draws are sorted by layer before submission, sprites and text on the same layer may be reordered
+    enum DrawLayer
+    {
+        LAYER_BACKGROUND,
+        LAYER_WALLS,
+        LAYER_WINGS,
+        LAYER_PLAYER,
+        LAYER_HUD,
+        LAYER_UI,
+        LAYER_UI_TEXT,
+    };
+
     struct Scene
     {
         void (*Init)(void);
@@ -83,6 +95,13 @@ namespace Game{
         // Background
         float background_scroll;
 
+        Mln::StaticBatch background_batch;
+
+        // The game over panel is drawn into a target once per round and shown as a single quad
+        Mln::RenderTarget game_over_target;
+        bool game_over_dirty;
+        bool button_hovered;
+
     };
 
     void Init();
@@ -92,7 +111,7 @@ namespace Game{
 
     
 
-    void DrawGap(Mln::Vector2 position);
+    void DrawGaps(const Mln::Vector2* positions, int count);
 }
 
 #endif // GAME_HPP
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef SPRITE_ATLAS_BAKE_HPP
+#define SPRITE_ATLAS_BAKE_HPP
+
+#include "sprite_atlas.hpp"
+#include <cstdint>
+
+// Sprite atlas packed and mipmapped offline by tools/atlas_baker, so loading it is one read and one upload.
+// The file is a SpriteAtlasBakeHeader, sprite_count rects of x, y, width, height in SpriteAtlas::Sprite order, then
+// level_count levels of premultiplied RGBA8 from width x height down to 1x1, each halving the one before
+
+#define SPRITE_ATLAS_BAKE_FILE "sprites.atlasbake"
+
+constexpr uint32_t SpriteAtlasBakeMagic = 0x414E4C4D; // "MLNA"
+constexpr uint32_t SpriteAtlasBakeVersion = 1;
+
+struct SpriteAtlasBakeHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t file_list_hash; // Bakes made from another sprite list are ignored
+    int32_t sprite_count;
+    int32_t width;
+    int32_t height;
+    int32_t level_count;
+};
+
+// FNV-1a over the names in SpriteAtlas::file_list, the list order is part of the hash
+inline uint32_t HashSpriteFileList()
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < SpriteAtlas::Sprite::_LENGTH; i++)
+    {
+        for (const char* c = SpriteAtlas::file_list[i]; *c; c++)
+        {
+            hash = (hash ^ (unsigned char)*c) * 16777619u;
+        }
+        hash *= 16777619u; // The terminator, so moving a character between names changes the hash
+    }
+    return hash;
+}
+
+#endif // SPRITE_ATLAS_BAKE_HPP
@@ -0,0 +1,10 @@
+#pragma once
+
+// Signed distance field glyphs for LoadFontSDF. Glyphs are baked at FontSdfBakeSize and the text shader rebuilds a
+// sharp edge at whatever size they end up on screen, so one small atlas serves every scale
+
+constexpr float FontSdfBakeSize = 32.f;
+constexpr int FontSdfPadding = 4;              // Texels of falloff around each glyph
+constexpr unsigned char FontSdfOnEdge = 128;   // Texel value on the outline, 0.5 in the shader
+constexpr float FontSdfDistanceScale = (float)FontSdfOnEdge / FontSdfPadding; // Value change per texel of distance
+constexpr float FontLayoutSize = 48.f;         // Size bitmap fonts are rasterized at, the SDF metrics are scaled to match
@@ -1,2 +1,2 @@
 //Auto generated with shader_packer DO NOT EDIT
-static const char default_vs[] = "\x23\x76\x65\x72\x73\x69\x6f\x6e\x20\x33\x33\x30\x20\x63\x6f\x72\x65\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x30\x29\x20\x69\x6e\x20\x76\x65\x63\x32\x20\x61\x50\x6f\x73\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x31\x29\x20\x69\x6e\x20\x76\x65\x63\x34\x20\x61\x43\x6f\x6c\x6f\x72\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x32\x29\x20\x69\x6e\x20\x76\x65\x63\x32\x20\x61\x54\x65\x78\x43\x6f\x6f\x72\x64\x3b\xa\xa\x6f\x75\x74\x20\x76\x65\x63\x32\x20\x75\x76\x3b\xa\x6f\x75\x74\x20\x76\x65\x63\x34\x20\x63\x6f\x6c\x6f\x72\x3b\xa\xa\x76\x6f\x69\x64\x20\x6d\x61\x69\x6e\x28\x29\xa\x7b\xa\x20\x20\x20\x20\x67\x6c\x5f\x50\x6f\x73\x69\x74\x69\x6f\x6e\x20\x3d\x20\x76\x65\x63\x34\x28\x61\x50\x6f\x73\x2e\x78\x2c\x20\x61\x50\x6f\x73\x2e\x79\x2c\x20\x30\x2e\x30\x2c\x20\x31\x2e\x30\x29\x3b\xa\x20\x20\x20\x20\x63\x6f\x6c\x6f\x72\x20\x3d\x20\x61\x43\x6f\x6c\x6f\x72\x3b\xa\x20\x20\x20\x20\x75\x76\x20\x3d\x20\x61\x54\x65\x78\x43\x6f\x6f\x72\x64\x3b\xa\x7d";
\ No newline at end of file
+static const char default_vs[] = "\x23\x76\x65\x72\x73\x69\x6f\x6e\x20\x33\x33\x30\x20\x63\x6f\x72\x65\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x30\x29\x20\x69\x6e\x20\x76\x65\x63\x32\x20\x61\x50\x6f\x73\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x31\x29\x20\x69\x6e\x20\x76\x65\x63\x34\x20\x61\x43\x6f\x6c\x6f\x72\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x32\x29\x20\x69\x6e\x20\x76\x65\x63\x32\x20\x61\x54\x65\x78\x43\x6f\x6f\x72\x64\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x33\x29\x20\x69\x6e\x20\x66\x6c\x6f\x61\x74\x20\x61\x54\x65\x78\x53\x6c\x6f\x74\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x34\x29\x20\x69\x6e\x20\x66\x6c\x6f\x61\x74\x20\x61\x4d\x6f\x64\x65\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x35\x29\x20\x69\x6e\x20\x66\x6c\x6f\x61\x74\x20\x61\x41\x64\x64\x69\x74\x69\x76\x65\x3b\xa\xa\x2f\x2f\x20\x49\x64\x65\x6e\x74\x69\x74\x79\x20\x66\x6f\x72\x20\x73\x74\x72\x65\x61\x6d\x65\x64\x20\x71\x75\x61\x64\x73\x2c\x20\x77\x68\x69\x63\x68\x20\x61\x72\x72\x69\x76\x65\x20\x69\x6e\x20\x63\x6c\x69\x70\x20\x73\x70\x61\x63\x65\x2c\x20\x61\x6e\x64\x20\x74\x68\x65\x20\x66\x75\x6c\x6c\x20\x74\x72\x61\x6e\x73\x66\x6f\x72\x6d\x20\x66\x6f\x72\x20\x73\x74\x61\x74\x69\x63\x20\x62\x61\x74\x63\x68\x65\x73\xa\x75\x6e\x69\x66\x6f\x72\x6d\x20\x6d\x61\x74\x34\x20\x75\x56\x69\x65\x77\x50\x72\x6f\x6a\x65\x63\x74\x69\x6f\x6e\x3b\xa\xa\x6f\x75\x74\x20\x76\x65\x63\x32\x20\x75\x76\x3b\xa\x6f\x75\x74\x20\x76\x65\x63\x34\x20\x63\x6f\x6c\x6f\x72\x3b\xa\x6f\x75\x74\x20\x66\x6c\x6f\x61\x74\x20\x74\x65\x78\x53\x6c\x6f\x74\x3b\xa\x6f\x75\x74\x20\x66\x6c\x6f\x61\x74\x20\x6d\x6f\x64\x65\x3b\xa\x6f\x75\x74\x20\x66\x6c\x6f\x61\x74\x20\x61\x64\x64\x69\x74\x69\x76\x65\x3b\xa\xa\x76\x6f\x69\x64\x20\x6d\x61\x69\x6e\x28\x29\xa\x7b\xa\x20\x20\x20\x20\x67\x6c\x5f\x50\x6f\x73\x69\x74\x69\x6f\x6e\x20\x3d\x20\x75\x56\x69\x65\x77\x50\x72\x6f\x6a\x65\x63\x74\x69\x6f\x6e\x20\x2a\x20\x76\x65\x63\x34\x28\x61\x50\x6f\x73\x2e\x78\x2c\x20\x61\x50\x6f\x73\x2e\x79\x2c\x20\x30\x2e\x30\x2c\x20\x31\x2e\x30\x29\x3b\xa\x20\x20\x20\x20\x63\x6f\x6c\x6f\x72\x20\x3d\x20\x61\x43\x6f\x6c\x6f\x72\x3b\xa\x20\x20\x20\x20\x75\x76\x20\x3d\x20\x61\x54\x65\x78\x43\x6f\x6f\x72\x64\x3b\xa\x20\x20\x20\x20\x74\x65\x78\x53\x6c\x6f\x74\x20\x3d\x20\x61\x54\x65\x78\x53\x6c\x6f\x74\x3b\xa\x20\x20\x20\x20\x6d\x6f\x64\x65\x20\x3d\x20\x61\x4d\x6f\x64\x65\x3b\xa\x20\x20\x20\x20\x61\x64\x64\x69\x74\x69\x76\x65\x20\x3d\x20\x61\x41\x64\x64\x69\x74\x69\x76\x65\x3b\xa\x7d";
\ No newline at end of file
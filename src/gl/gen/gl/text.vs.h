@@ -1,2 +0,0 @@
-//Auto generated with shader_packer DO NOT EDIT
-static const char text_vs[] = "\x23\x76\x65\x72\x73\x69\x6f\x6e\x20\x33\x33\x30\x20\x63\x6f\x72\x65\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x30\x29\x20\x69\x6e\x20\x76\x65\x63\x32\x20\x61\x50\x6f\x73\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x31\x29\x20\x69\x6e\x20\x76\x65\x63\x34\x20\x61\x43\x6f\x6c\x6f\x72\x3b\xa\x6c\x61\x79\x6f\x75\x74\x20\x28\x6c\x6f\x63\x61\x74\x69\x6f\x6e\x20\x3d\x20\x32\x29\x20\x69\x6e\x20\x76\x65\x63\x32\x20\x61\x54\x65\x78\x43\x6f\x6f\x72\x64\x3b\xa\xa\x6f\x75\x74\x20\x76\x65\x63\x32\x20\x75\x76\x3b\xa\x6f\x75\x74\x20\x76\x65\x63\x34\x20\x63\x6f\x6c\x6f\x72\x3b\xa\xa\x76\x6f\x69\x64\x20\x6d\x61\x69\x6e\x28\x29\xa\x7b\xa\x20\x20\x20\x20\x67\x6c\x5f\x50\x6f\x73\x69\x74\x69\x6f\x6e\x20\x3d\x20\x76\x65\x63\x34\x28\x61\x50\x6f\x73\x2e\x78\x2c\x20\x61\x50\x6f\x73\x2e\x79\x2c\x20\x30\x2e\x30\x2c\x20\x31\x2e\x30\x29\x3b\xa\x20\x20\x20\x20\x63\x6f\x6c\x6f\x72\x20\x3d\x20\x61\x43\x6f\x6c\x6f\x72\x3b\xa\x20\x20\x20\x20\x75\x76\x20\x3d\x20\x61\x54\x65\x78\x43\x6f\x6f\x72\x64\x3b\xa\x7d";
\ No newline at end of file
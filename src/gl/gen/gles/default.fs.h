@@ -1,2 +1,2 @@
 //Auto generated with shader_packer DO NOT EDIT
-static const char default_fs[] = "\x2f\x2f\x23\x76\x65\x72\x73\x69\x6f\x6e\x20\x33\x33\x30\x20\x63\x6f\x72\x65\xa\x2f\x2f\x6f\x75\x74\x20\x76\x65\x63\x34\x20\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x3b\xa\x70\x72\x65\x63\x69\x73\x69\x6f\x6e\x20\x6d\x65\x64\x69\x75\x6d\x70\x20\x66\x6c\x6f\x61\x74\x3b\x20\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x76\x65\x63\x34\x20\x63\x6f\x6c\x6f\x72\x3b\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x76\x65\x63\x32\x20\x75\x76\x3b\xa\xa\x75\x6e\x69\x66\x6f\x72\x6d\x20\x73\x61\x6d\x70\x6c\x65\x72\x32\x44\x20\x75\x54\x65\x78\x74\x75\x72\x65\x3b\xa\xa\x76\x6f\x69\x64\x20\x6d\x61\x69\x6e\x28\x29\xa\x7b\xa\x20\x20\x20\x20\x76\x65\x63\x34\x20\x75\x76\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x75\x76\x2e\x78\x2c\x20\x75\x76\x2e\x79\x2c\x20\x30\x2c\x20\x31\x2e\x30\x29\x3b\xa\x20\x20\x20\x20\x76\x65\x63\x34\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x2c\x20\x75\x76\x29\x3b\xa\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x6d\x69\x78\x28\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x2c\x20\x63\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x2c\x20\x63\x6f\x6c\x6f\x72\x2e\x61\x29\x2c\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x61\x29\x3b\xa\x7d\x20";
\ No newline at end of file
+static const char default_fs[] = "\x2f\x2f\x23\x76\x65\x72\x73\x69\x6f\x6e\x20\x33\x33\x30\x20\x63\x6f\x72\x65\xa\x2f\x2f\x6f\x75\x74\x20\x76\x65\x63\x34\x20\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x3b\xa\x23\x69\x66\x64\x65\x66\x20\x47\x4c\x5f\x4f\x45\x53\x5f\x73\x74\x61\x6e\x64\x61\x72\x64\x5f\x64\x65\x72\x69\x76\x61\x74\x69\x76\x65\x73\xa\x23\x65\x78\x74\x65\x6e\x73\x69\x6f\x6e\x20\x47\x4c\x5f\x4f\x45\x53\x5f\x73\x74\x61\x6e\x64\x61\x72\x64\x5f\x64\x65\x72\x69\x76\x61\x74\x69\x76\x65\x73\x20\x3a\x20\x65\x6e\x61\x62\x6c\x65\xa\x23\x65\x6e\x64\x69\x66\xa\x70\x72\x65\x63\x69\x73\x69\x6f\x6e\x20\x6d\x65\x64\x69\x75\x6d\x70\x20\x66\x6c\x6f\x61\x74\x3b\x20\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x76\x65\x63\x34\x20\x63\x6f\x6c\x6f\x72\x3b\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x76\x65\x63\x32\x20\x75\x76\x3b\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x66\x6c\x6f\x61\x74\x20\x74\x65\x78\x53\x6c\x6f\x74\x3b\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x66\x6c\x6f\x61\x74\x20\x6d\x6f\x64\x65\x3b\x20\x2f\x2f\x20\x30\x20\x74\x69\x6e\x74\x73\x20\x74\x68\x65\x20\x74\x65\x78\x65\x6c\x2c\x20\x31\x20\x75\x73\x65\x73\x20\x74\x68\x65\x20\x72\x65\x64\x20\x63\x68\x61\x6e\x6e\x65\x6c\x20\x61\x73\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x20\x66\x6f\x72\x20\x74\x65\x78\x74\x2c\x20\x32\x20\x61\x73\x20\x61\x20\x64\x69\x73\x74\x61\x6e\x63\x65\x20\x66\x69\x65\x6c\x64\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x66\x6c\x6f\x61\x74\x20\x61\x64\x64\x69\x74\x69\x76\x65\x3b\xa\xa\x75\x6e\x69\x66\x6f\x72\x6d\x20\x73\x61\x6d\x70\x6c\x65\x72\x32\x44\x20\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x38\x5d\x3b\xa\x75\x6e\x69\x66\x6f\x72\x6d\x20\x76\x65\x63\x34\x20\x75\x54\x69\x6e\x74\x3b\xa\xa\x2f\x2f\x20\x53\x61\x6d\x70\x6c\x65\x72\x20\x61\x72\x72\x61\x79\x73\x20\x6d\x61\x79\x20\x6f\x6e\x6c\x79\x20\x62\x65\x20\x69\x6e\x64\x65\x78\x65\x64\x20\x77\x69\x74\x68\x20\x63\x6f\x6e\x73\x74\x61\x6e\x74\x73\x20\x6f\x6e\x20\x47\x4c\x45\x53\x2c\x20\x74\x68\x65\x20\x73\x6c\x6f\x74\x20\x70\x69\x63\x6b\x73\x20\x61\x20\x62\x72\x61\x6e\x63\x68\x20\x69\x6e\x73\x74\x65\x61\x64\xa\x76\x65\x63\x34\x20\x53\x61\x6d\x70\x6c\x65\x53\x6c\x6f\x74\x28\x66\x6c\x6f\x61\x74\x20\x73\x6c\x6f\x74\x2c\x20\x76\x65\x63\x32\x20\x63\x6f\x6f\x72\x64\x73\x29\xa\x7b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x30\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x30\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x31\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x31\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x32\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x32\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x33\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x33\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x34\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x34\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x35\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x35\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x69\x66\x20\x28\x73\x6c\x6f\x74\x20\x3c\x20\x36\x2e\x35\x29\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x36\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x20\x20\x20\x20\x72\x65\x74\x75\x72\x6e\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x73\x5b\x37\x5d\x2c\x20\x63\x6f\x6f\x72\x64\x73\x29\x3b\xa\x7d\xa\xa\x76\x6f\x69\x64\x20\x6d\x61\x69\x6e\x28\x29\xa\x7b\xa\x20\x20\x20\x20\x76\x65\x63\x34\x20\x75\x76\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x75\x76\x2e\x78\x2c\x20\x75\x76\x2e\x79\x2c\x20\x30\x2c\x20\x31\x2e\x30\x29\x3b\xa\x20\x20\x20\x20\x2f\x2f\x20\x54\x65\x78\x74\x75\x72\x65\x73\x20\x61\x72\x65\x20\x70\x72\x65\x6d\x75\x6c\x74\x69\x70\x6c\x69\x65\x64\x20\x61\x6e\x64\x20\x73\x6f\x20\x69\x73\x20\x74\x68\x65\x20\x6f\x75\x74\x70\x75\x74\x2c\x20\x62\x6c\x65\x6e\x64\x69\x6e\x67\x20\x69\x73\x20\x4f\x4e\x45\x2c\x20\x4f\x4e\x45\x5f\x4d\x49\x4e\x55\x53\x5f\x53\x52\x43\x5f\x41\x4c\x50\x48\x41\xa\x20\x20\x20\x20\x76\x65\x63\x34\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x53\x61\x6d\x70\x6c\x65\x53\x6c\x6f\x74\x28\x74\x65\x78\x53\x6c\x6f\x74\x2c\x20\x75\x76\x29\x3b\xa\x20\x20\x20\x20\x2f\x2f\x20\x44\x65\x72\x69\x76\x61\x74\x69\x76\x65\x73\x20\x61\x72\x65\x20\x74\x61\x6b\x65\x6e\x20\x62\x65\x66\x6f\x72\x65\x20\x62\x72\x61\x6e\x63\x68\x69\x6e\x67\x2c\x20\x74\x68\x65\x20\x73\x6d\x6f\x6f\x74\x68\x69\x6e\x67\x20\x66\x6f\x6c\x6c\x6f\x77\x73\x20\x68\x6f\x77\x20\x66\x61\x73\x74\x20\x74\x68\x65\x20\x64\x69\x73\x74\x61\x6e\x63\x65\x20\x63\x68\x61\x6e\x67\x65\x73\x20\x6f\x6e\x20\x73\x63\x72\x65\x65\x6e\xa\x23\x69\x66\x64\x65\x66\x20\x47\x4c\x5f\x4f\x45\x53\x5f\x73\x74\x61\x6e\x64\x61\x72\x64\x5f\x64\x65\x72\x69\x76\x61\x74\x69\x76\x65\x73\xa\x20\x20\x20\x20\x66\x6c\x6f\x61\x74\x20\x73\x6d\x6f\x6f\x74\x68\x69\x6e\x67\x20\x3d\x20\x6d\x61\x78\x28\x30\x2e\x37\x20\x2a\x20\x66\x77\x69\x64\x74\x68\x28\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x72\x29\x2c\x20\x30\x2e\x30\x30\x31\x29\x3b\xa\x23\x65\x6c\x73\x65\xa\x20\x20\x20\x20\x66\x6c\x6f\x61\x74\x20\x73\x6d\x6f\x6f\x74\x68\x69\x6e\x67\x20\x3d\x20\x30\x2e\x30\x39\x3b\x20\x2f\x2f\x20\x41\x62\x6f\x75\x74\x20\x61\x20\x70\x69\x78\x65\x6c\x20\x77\x68\x65\x6e\x20\x64\x72\x61\x77\x6e\x20\x61\x74\x20\x74\x68\x65\x20\x73\x69\x7a\x65\x20\x74\x68\x65\x20\x67\x6c\x79\x70\x68\x73\x20\x77\x65\x72\x65\x20\x62\x61\x6b\x65\x64\xa\x23\x65\x6e\x64\x69\x66\xa\x20\x20\x20\x20\x69\x66\x20\x28\x6d\x6f\x64\x65\x20\x3c\x20\x30\x2e\x35\x29\xa\x20\x20\x20\x20\x7b\xa\x20\x20\x20\x20\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x6d\x69\x78\x28\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x2c\x20\x63\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x20\x2a\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x61\x2c\x20\x63\x6f\x6c\x6f\x72\x2e\x61\x29\x2c\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x61\x29\x3b\xa\x20\x20\x20\x20\x7d\xa\x20\x20\x20\x20\x65\x6c\x73\x65\x20\x69\x66\x20\x28\x6d\x6f\x64\x65\x20\x3c\x20\x31\x2e\x35\x29\xa\x20\x20\x20\x20\x7b\xa\x20\x20\x20\x20\x20\x20\x20\x20\x66\x6c\x6f\x61\x74\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x20\x3d\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x72\x20\x2a\x20\x63\x6f\x6c\x6f\x72\x2e\x61\x3b\xa\x20\x20\x20\x20\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x63\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x20\x2a\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x2c\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x29\x3b\xa\x20\x20\x20\x20\x7d\xa\x20\x20\x20\x20\x65\x6c\x73\x65\xa\x20\x20\x20\x20\x7b\xa\x20\x20\x20\x20\x20\x20\x20\x20\x66\x6c\x6f\x61\x74\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x20\x3d\x20\x73\x6d\x6f\x6f\x74\x68\x73\x74\x65\x70\x28\x30\x2e\x35\x20\x2d\x20\x73\x6d\x6f\x6f\x74\x68\x69\x6e\x67\x2c\x20\x30\x2e\x35\x20\x2b\x20\x73\x6d\x6f\x6f\x74\x68\x69\x6e\x67\x2c\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x72\x29\x20\x2a\x20\x63\x6f\x6c\x6f\x72\x2e\x61\x3b\xa\x20\x20\x20\x20\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x63\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x20\x2a\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x2c\x20\x63\x6f\x76\x65\x72\x61\x67\x65\x29\x3b\xa\x20\x20\x20\x20\x7d\xa\x20\x20\x20\x20\x2f\x2f\x20\x4c\x65\x73\x73\x20\x61\x6c\x70\x68\x61\x20\x6f\x6e\x6c\x79\x20\x6c\x65\x74\x73\x20\x6d\x6f\x72\x65\x20\x6f\x66\x20\x74\x68\x65\x20\x64\x65\x73\x74\x69\x6e\x61\x74\x69\x6f\x6e\x20\x74\x68\x72\x6f\x75\x67\x68\x2c\x20\x61\x74\x20\x30\x20\x74\x68\x65\x20\x63\x6f\x6c\x6f\x72\x20\x69\x73\x20\x61\x64\x64\x65\x64\xa\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x2e\x61\x20\x2a\x3d\x20\x31\x2e\x30\x20\x2d\x20\x61\x64\x64\x69\x74\x69\x76\x65\x3b\xa\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x20\x2a\x3d\x20\x76\x65\x63\x34\x28\x75\x54\x69\x6e\x74\x2e\x72\x67\x62\x20\x2a\x20\x75\x54\x69\x6e\x74\x2e\x61\x2c\x20\x75\x54\x69\x6e\x74\x2e\x61\x29\x3b\xa\x7d\x20";
\ No newline at end of file
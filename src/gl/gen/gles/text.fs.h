@@ -1,2 +0,0 @@
-//Auto generated with shader_packer DO NOT EDIT
-static const char text_fs[] = "\x2f\x2f\x23\x76\x65\x72\x73\x69\x6f\x6e\x20\x33\x33\x30\x20\x63\x6f\x72\x65\xa\x2f\x2f\x6f\x75\x74\x20\x76\x65\x63\x34\x20\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x3b\xa\x70\x72\x65\x63\x69\x73\x69\x6f\x6e\x20\x6d\x65\x64\x69\x75\x6d\x70\x20\x66\x6c\x6f\x61\x74\x3b\x20\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x76\x65\x63\x34\x20\x63\x6f\x6c\x6f\x72\x3b\xa\x76\x61\x72\x79\x69\x6e\x67\x20\x76\x65\x63\x32\x20\x75\x76\x3b\xa\xa\x75\x6e\x69\x66\x6f\x72\x6d\x20\x73\x61\x6d\x70\x6c\x65\x72\x32\x44\x20\x75\x54\x65\x78\x74\x75\x72\x65\x3b\xa\xa\x76\x6f\x69\x64\x20\x6d\x61\x69\x6e\x28\x29\xa\x7b\xa\x20\x20\x20\x20\x76\x65\x63\x34\x20\x75\x76\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x75\x76\x2e\x78\x2c\x20\x75\x76\x2e\x79\x2c\x20\x30\x2c\x20\x31\x2e\x30\x29\x3b\xa\x20\x20\x20\x20\x76\x65\x63\x34\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x74\x65\x78\x74\x75\x72\x65\x32\x44\x28\x75\x54\x65\x78\x74\x75\x72\x65\x2c\x20\x75\x76\x29\x3b\xa\x20\x20\x20\x20\x67\x6c\x5f\x46\x72\x61\x67\x43\x6f\x6c\x6f\x72\x20\x3d\x20\x76\x65\x63\x34\x28\x63\x6f\x6c\x6f\x72\x2e\x72\x67\x62\x2c\x20\x74\x65\x78\x74\x75\x72\x65\x43\x6f\x6c\x6f\x72\x2e\x72\x20\x2a\x20\x63\x6f\x6c\x6f\x72\x2e\x61\x29\x3b\xa\x7d\x20";
\ No newline at end of file
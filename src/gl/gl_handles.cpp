@@ -0,0 +1,55 @@
+#include "gl_handles.hpp"
+#include "handle_pool.hpp"
+#include "core.hpp"
+
+constexpr int InitialTextureHandles = 64;
+constexpr int InitialShaderHandles = 8;
+
+struct {
+    HandlePool textures; // GLuint texture names
+    HandlePool programs; // GLuint program names
+} state = {0};
+
+void InitGLHandles()
+{
+    InitHandlePool(&state.textures, sizeof(GLuint), InitialTextureHandles);
+    InitHandlePool(&state.programs, sizeof(GLuint), InitialShaderHandles);
+}
+
+void ShutdownGLHandles()
+{
+    FreeHandlePool(&state.textures);
+    FreeHandlePool(&state.programs);
+}
+
+Mln::id_t AddTextureHandle(GLuint texture)
+{
+    return AddPoolItem(&state.textures, &texture);
+}
+
+GLuint GetTextureName(Mln::id_t texture)
+{
+    const GLuint* name = (const GLuint*)GetPoolItem(&state.textures, texture);
+    ASSERT(name || texture == Mln::InvalidID, "Texture was unloaded");
+    return name ? *name : 0;
+}
+
+void RemoveTextureHandle(Mln::id_t texture)
+{
+    if (!RemovePoolItem(&state.textures, texture))
+    {
+        ASSERT(false, "Texture was already unloaded");
+    }
+}
+
+Mln::id_t AddShaderHandle(GLuint program)
+{
+    return AddPoolItem(&state.programs, &program);
+}
+
+GLuint GetProgramName(Mln::id_t shader)
+{
+    const GLuint* name = (const GLuint*)GetPoolItem(&state.programs, shader);
+    ASSERT(name || shader == Mln::InvalidID, "Shader was unloaded");
+    return name ? *name : 0;
+}
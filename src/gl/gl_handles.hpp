@@ -0,0 +1,17 @@
+#pragma once
+
+#include "melon_types.hpp"
+#include <glad/glad.h>
+
+// Mln::Texture and Mln::Shader ids are generational handles to the GL objects (see handle_pool.hpp). A texture or
+// shader used after it was unloaded is caught here instead of binding whatever object GL gave the name to next
+
+void InitGLHandles();
+void ShutdownGLHandles();
+
+Mln::id_t AddTextureHandle(GLuint texture);
+GLuint GetTextureName(Mln::id_t texture); // 0 for InvalidID and stale handles
+void RemoveTextureHandle(Mln::id_t texture);
+
+Mln::id_t AddShaderHandle(GLuint program);
+GLuint GetProgramName(Mln::id_t shader); // 0 for InvalidID and stale handles
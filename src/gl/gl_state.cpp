@@ -0,0 +1,204 @@
+#include "gl_state.hpp"
+#include "core.hpp"
+
+// Never a valid object name, forces the next bind through
+constexpr GLuint UnknownBinding = (GLuint)-1;
+
+struct {
+    GLuint program;
+    int active_unit;
+    GLuint textures[GLStateTextureUnits];
+    GLuint array_buffer;
+    GLuint element_buffer; // Part of the vertex array state, unknown again after every vertex array switch
+    GLuint vao;
+    GLuint framebuffer;
+
+    int blend_enabled; // -1 while unknown
+    GLenum blend_source;
+    GLenum blend_destination;
+
+    GLStateStats frame;
+    GLStateStats last_frame;
+} state = {0};
+
+
+void InvalidateGLState()
+{
+    state.program = UnknownBinding;
+    state.active_unit = -1;
+    for (int i = 0; i < GLStateTextureUnits; i++)
+    {
+        state.textures[i] = UnknownBinding;
+    }
+    state.array_buffer = UnknownBinding;
+    state.element_buffer = UnknownBinding;
+    state.vao = UnknownBinding;
+    state.framebuffer = UnknownBinding;
+
+    state.blend_enabled = -1;
+    state.blend_source = GL_NONE;
+    state.blend_destination = GL_NONE;
+}
+
+void BindProgram(GLuint program)
+{
+    if (state.program == program)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    glUseProgram(program);
+    state.program = program;
+    state.frame.issued++;
+    state.frame.program_binds++;
+}
+
+void BindTexture2D(int unit, GLuint texture)
+{
+    ASSERT(unit >= 0 && unit < GLStateTextureUnits, "Texture unit out of range");
+    if (state.textures[unit] == texture)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    if (state.active_unit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        state.active_unit = unit;
+        state.frame.issued++;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    state.textures[unit] = texture;
+    state.frame.issued++;
+    state.frame.texture_binds++;
+}
+
+void BindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* bound = target == GL_ELEMENT_ARRAY_BUFFER ? &state.element_buffer : &state.array_buffer;
+    ASSERT(target == GL_ELEMENT_ARRAY_BUFFER || target == GL_ARRAY_BUFFER, "Buffer target is not tracked");
+    if (*bound == buffer)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    glBindBuffer(target, buffer);
+    *bound = buffer;
+    state.frame.issued++;
+}
+
+void BindVertexArray(GLuint vao)
+{
+    if (state.vao == vao)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    glBindVertexArray(vao);
+    state.vao = vao;
+    state.element_buffer = UnknownBinding;
+    state.frame.issued++;
+}
+
+void BindFramebuffer(GLuint framebuffer)
+{
+    if (state.framebuffer == framebuffer)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    state.framebuffer = framebuffer;
+    state.frame.issued++;
+}
+
+void SetBlendEnabled(bool enabled)
+{
+    if (state.blend_enabled == (int)enabled)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    if (enabled)
+    {
+        glEnable(GL_BLEND);
+    }
+    else
+    {
+        glDisable(GL_BLEND);
+    }
+    state.blend_enabled = (int)enabled;
+    state.frame.issued++;
+}
+
+void SetBlendFunc(GLenum source, GLenum destination)
+{
+    if (state.blend_source == source && state.blend_destination == destination)
+    {
+        state.frame.filtered++;
+        return;
+    }
+
+    glBlendFunc(source, destination);
+    state.blend_source = source;
+    state.blend_destination = destination;
+    state.frame.issued++;
+}
+
+void ForgetTexture(GLuint texture)
+{
+    for (int i = 0; i < GLStateTextureUnits; i++)
+    {
+        if (state.textures[i] == texture)
+        {
+            state.textures[i] = 0;
+        }
+    }
+}
+
+void ForgetBuffer(GLuint buffer)
+{
+    if (state.array_buffer == buffer)
+    {
+        state.array_buffer = 0;
+    }
+    if (state.element_buffer == buffer)
+    {
+        state.element_buffer = 0;
+    }
+}
+
+void ForgetVertexArray(GLuint vao)
+{
+    if (state.vao == vao)
+    {
+        state.vao = 0;
+        state.element_buffer = UnknownBinding;
+    }
+}
+
+void ForgetFramebuffer(GLuint framebuffer)
+{
+    if (state.framebuffer == framebuffer)
+    {
+        state.framebuffer = 0;
+    }
+}
+
+void EndGLStateFrame()
+{
+    state.last_frame = state.frame;
+    state.frame = GLStateStats{};
+}
+
+GLStateStats GetGLStateStats()
+{
+    return state.last_frame;
+}
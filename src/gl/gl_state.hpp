@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Shadows the GL bindings the renderer touches so calls that would not change anything never reach the driver.
+// Anything that changes these bindings behind its back has to call InvalidateGLState afterwards.
+
+constexpr int GLStateTextureUnits = 16;
+
+struct GLStateStats{
+    int issued;   // Calls forwarded to GL
+    int filtered; // Calls dropped because the state already matched
+    int program_binds; // Part of issued
+    int texture_binds; // Part of issued
+};
+
+void InvalidateGLState();
+
+void BindProgram(GLuint program);
+void BindTexture2D(int unit, GLuint texture);
+void BindBuffer(GLenum target, GLuint buffer); // GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+void BindVertexArray(GLuint vao);
+void BindFramebuffer(GLuint framebuffer); // 0 is the window
+void SetBlendEnabled(bool enabled);
+void SetBlendFunc(GLenum source, GLenum destination);
+
+// GL drops deleted objects from every binding point, the shadow has to do the same
+void ForgetTexture(GLuint texture);
+void ForgetBuffer(GLuint buffer);
+void ForgetVertexArray(GLuint vao);
+void ForgetFramebuffer(GLuint framebuffer);
+
+void EndGLStateFrame();
+GLStateStats GetGLStateStats(); // Counters of the last finished frame
@@ -0,0 +1,504 @@
+#include "glyph_cache.hpp"
+#include "font_sdf.hpp"
+#include "graphics_api.hpp"
+#include "core.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+constexpr int GlyphTableMinCapacity = 128;
+constexpr int GlyphPadding = 2; // Texels between glyphs so linear filtering never reaches a neighbour
+constexpr uint32_t ReplacementCodepoint = 0xFFFD;
+
+constexpr uint32_t GlyphBakeMagic = 0x474E4C4D; // "MLNG"
+constexpr uint32_t GlyphBakeVersion = 3;
+
+// A bake is the header, a GlyphBakePage per page, the glyphs, the used rows of every page and then the TTF
+struct GlyphBakeHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t glyph_struct_size; // Catches CachedGlyph layout changes between builds
+    uint32_t page_size;
+    uint32_t sdf;
+    uint32_t page_count;
+    uint32_t glyph_count;
+    uint32_t ttf_size;
+    int64_t ttf_mod_time;       // With ttf_size the stamp of the TTF the bake was made from, a bake of an older one is ignored
+};
+
+struct GlyphBakePage{
+    int32_t shelf_x, shelf_y, shelf_height;
+    int32_t rows; // Rows stored, the rest of the page is empty
+};
+
+int _FindGlyphSlot(const CachedGlyph* glyphs, int capacity, uint32_t codepoint);
+void _GrowGlyphTable(GlyphFont* font);
+const CachedGlyph* _InsertGlyph(GlyphFont* font, const CachedGlyph* glyph);
+void _RasterizeGlyph(GlyphFont* font, int glyph_index, CachedGlyph* glyph);
+unsigned char* _ReserveGlyphRect(GlyphFont* font, int width, int height, int* page_index, Mln::RectI* rect);
+bool _IsBakeOfFont(const GlyphBakeHeader* header, const char* ttf_path);
+
+bool LoadGlyphFont(GlyphFont* font, const char* path, bool sdf)
+{
+    *font = GlyphFont{};
+
+    size_t size = 0;
+    font->file = Mln::LoadFileBinary(path, &size);
+    if (!font->file)
+    {
+        Mln::PrintLog(LOG_ERROR, "Font %s could not be read\n", path);
+        return false;
+    }
+    if (!stbtt_InitFont(&font->info, font->file, stbtt_GetFontOffsetForIndex(font->file, 0)))
+    {
+        Mln::PrintLog(LOG_ERROR, "Font %s is not a TrueType font\n", path);
+        Mln::UnloadFileBinary(font->file);
+        font->file = nullptr;
+        return false;
+    }
+
+    font->file_size = size;
+    font->ttf_size = size;
+    size_t disk_size = 0;
+    Mln::GetFileInfo(path, &disk_size, &font->ttf_mod_time);
+    font->sdf = sdf;
+    font->scale = stbtt_ScaleForPixelHeight(&font->info, sdf ? FontSdfBakeSize : FontLayoutSize);
+    return true;
+}
+
+bool LoadGlyphFontBake(GlyphFont* font, const char* path, const char* ttf_path)
+{
+    *font = GlyphFont{};
+
+    size_t size = 0;
+    unsigned char* file = Mln::LoadFileBinary(path, &size);
+    if (!file)
+    {
+        Mln::PrintLog(LOG_INFO, "Font bake %s could not be read\n", path);
+        return false;
+    }
+
+    GlyphBakeHeader header = {};
+    if (size >= sizeof(header))
+    {
+        memcpy(&header, file, sizeof(header));
+    }
+    if (header.magic != GlyphBakeMagic || header.version != GlyphBakeVersion || header.glyph_struct_size != sizeof(CachedGlyph) ||
+        header.page_size != GLYPH_PAGE_SIZE || header.page_count > MAX_GLYPH_PAGES)
+    {
+        Mln::PrintLog(LOG_ERROR, "Font bake %s was written by a different build\n", path);
+        Mln::UnloadFileBinary(file);
+        return false;
+    }
+    if (ttf_path && !_IsBakeOfFont(&header, ttf_path))
+    {
+        Mln::PrintLog(LOG_WARNING, "Font bake %s was made from another version of %s\n", path, ttf_path);
+        Mln::UnloadFileBinary(file);
+        return false;
+    }
+
+    const GlyphBakePage* bake_pages = (const GlyphBakePage*)(file + sizeof(header));
+    const CachedGlyph* bake_glyphs = (const CachedGlyph*)(bake_pages + header.page_count);
+    size_t offset = sizeof(header) + header.page_count * sizeof(GlyphBakePage) + (size_t)header.glyph_count * sizeof(CachedGlyph);
+    for (uint32_t i = 0; i < header.page_count && offset <= size; i++)
+    {
+        int rows = bake_pages[i].rows;
+        offset += rows >= 0 && rows <= GLYPH_PAGE_SIZE ? (size_t)rows * GLYPH_PAGE_SIZE : size + 1;
+    }
+    if (offset > size || size - offset != header.ttf_size)
+    {
+        Mln::PrintLog(LOG_ERROR, "Font bake %s is truncated\n", path);
+        Mln::UnloadFileBinary(file);
+        return false;
+    }
+
+    unsigned char* ttf = file + offset;
+    if (!stbtt_InitFont(&font->info, ttf, stbtt_GetFontOffsetForIndex(ttf, 0)))
+    {
+        Mln::PrintLog(LOG_ERROR, "Font bake %s holds no TrueType font\n", path);
+        Mln::UnloadFileBinary(file);
+        return false;
+    }
+    font->file = file;
+    font->file_size = size;
+    font->ttf_size = header.ttf_size;
+    font->ttf_mod_time = header.ttf_mod_time;
+    font->sdf = header.sdf != 0;
+    font->scale = stbtt_ScaleForPixelHeight(&font->info, font->sdf ? FontSdfBakeSize : FontLayoutSize);
+
+    // Pages are copied out since glyphs missing from the bake keep being added to them
+    const unsigned char* rows = (const unsigned char*)(bake_glyphs + header.glyph_count);
+    for (uint32_t i = 0; i < header.page_count; i++)
+    {
+        GlyphPage* page = &font->pages[font->page_count++];
+        page->image = Mln::CreateImage(GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, 1);
+        memcpy(page->image.data, rows, (size_t)bake_pages[i].rows * GLYPH_PAGE_SIZE);
+        rows += (size_t)bake_pages[i].rows * GLYPH_PAGE_SIZE;
+        page->texture = LoadTextureFromImage(page->image, true, false);
+        page->shelf_x = bake_pages[i].shelf_x;
+        page->shelf_y = bake_pages[i].shelf_y;
+        page->shelf_height = bake_pages[i].shelf_height;
+    }
+
+    for (uint32_t i = 0; i < header.glyph_count; i++)
+    {
+        CachedGlyph glyph;
+        memcpy(&glyph, bake_glyphs + i, sizeof(glyph));
+        if (glyph.page < (int)header.page_count && glyph.codepoint != UINT32_MAX)
+        {
+            _InsertGlyph(font, &glyph);
+        }
+    }
+    return true;
+}
+
+bool SaveGlyphFontBake(const GlyphFont* font, const char* path)
+{
+    GlyphBakeHeader header = {};
+    header.magic = GlyphBakeMagic;
+    header.version = GlyphBakeVersion;
+    header.glyph_struct_size = sizeof(CachedGlyph);
+    header.page_size = GLYPH_PAGE_SIZE;
+    header.sdf = font->sdf ? 1 : 0;
+    header.page_count = font->page_count;
+    header.glyph_count = font->glyph_count;
+    header.ttf_size = (uint32_t)font->ttf_size;
+    header.ttf_mod_time = font->ttf_mod_time;
+
+    GlyphBakePage bake_pages[MAX_GLYPH_PAGES];
+    size_t size = sizeof(header) + font->page_count * sizeof(GlyphBakePage) + (size_t)font->glyph_count * sizeof(CachedGlyph) + font->ttf_size;
+    for (int i = 0; i < font->page_count; i++)
+    {
+        const GlyphPage* page = &font->pages[i];
+        int rows = page->shelf_y + page->shelf_height;
+        bake_pages[i] = GlyphBakePage{page->shelf_x, page->shelf_y, page->shelf_height, rows < GLYPH_PAGE_SIZE ? rows : GLYPH_PAGE_SIZE};
+        size += (size_t)bake_pages[i].rows * GLYPH_PAGE_SIZE;
+    }
+
+    unsigned char* data = (unsigned char*)malloc(size);
+    unsigned char* cursor = data;
+    memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    memcpy(cursor, bake_pages, font->page_count * sizeof(GlyphBakePage));
+    cursor += font->page_count * sizeof(GlyphBakePage);
+    for (int i = 0; i < font->glyph_capacity; i++)
+    {
+        if (font->glyphs[i].codepoint != UINT32_MAX)
+        {
+            memcpy(cursor, &font->glyphs[i], sizeof(CachedGlyph));
+            cursor += sizeof(CachedGlyph);
+        }
+    }
+    for (int i = 0; i < font->page_count; i++)
+    {
+        memcpy(cursor, font->pages[i].image.data, (size_t)bake_pages[i].rows * GLYPH_PAGE_SIZE);
+        cursor += (size_t)bake_pages[i].rows * GLYPH_PAGE_SIZE;
+    }
+    memcpy(cursor, font->info.data, font->ttf_size);
+
+    bool saved = Mln::SaveFileBinary(path, data, size);
+    free(data);
+    if (!saved)
+    {
+        Mln::PrintLog(LOG_WARNING, "Font bake %s could not be written\n", path);
+    }
+    return saved;
+}
+
+void UnloadGlyphFont(GlyphFont* font)
+{
+    for (int i = 0; i < font->page_count; i++)
+    {
+#if defined(GENERATE_FONT_ATLAS)
+        char page_path[32];
+        snprintf(page_path, sizeof(page_path), "font_page%d.png", i);
+        Mln::WriteImage(font->pages[i].image, page_path);
+#endif
+        UnloadTexture(font->pages[i].texture);
+        Mln::UnloadImage(font->pages[i].image);
+    }
+
+    free(font->glyphs);
+    if (font->file)
+    {
+        Mln::UnloadFileBinary(font->file);
+    }
+    *font = GlyphFont{};
+}
+
+size_t GetGlyphFontMemory(const GlyphFont* font)
+{
+    size_t page_bytes = (size_t)GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE;
+    return font->file_size + (size_t)font->glyph_capacity * sizeof(CachedGlyph) + 2 * page_bytes * font->page_count;
+}
+
+const CachedGlyph* GetGlyph(GlyphFont* font, uint32_t codepoint)
+{
+    if (font->glyph_capacity > 0)
+    {
+        int slot = _FindGlyphSlot(font->glyphs, font->glyph_capacity, codepoint);
+        if (font->glyphs[slot].codepoint == codepoint)
+        {
+            return &font->glyphs[slot];
+        }
+    }
+
+    // Every codepoint the font lacks draws the box of glyph 0, which is only rasterized once under codepoint 0
+    CachedGlyph glyph = {};
+    int glyph_index = stbtt_FindGlyphIndex(&font->info, (int)codepoint);
+    if (glyph_index == 0 && codepoint != 0)
+    {
+        glyph = *GetGlyph(font, 0);
+    }
+    else
+    {
+        _RasterizeGlyph(font, glyph_index, &glyph);
+    }
+    glyph.codepoint = codepoint;
+    return _InsertGlyph(font, &glyph);
+}
+
+void UploadGlyphPages(GlyphFont* font)
+{
+    for (int i = 0; i < font->page_count; i++)
+    {
+        GlyphPage* page = &font->pages[i];
+        if (page->dirty.width == 0)
+        {
+            continue;
+        }
+        UpdateTextureRect(page->texture, page->image, page->dirty);
+        page->dirty = Mln::RectI{};
+    }
+}
+
+uint32_t DecodeUtf8(const char** str)
+{
+    const unsigned char* s = (const unsigned char*)*str;
+    uint32_t codepoint;
+    int length;
+    if (s[0] < 0x80)
+    {
+        *str += 1;
+        return s[0];
+    }
+    else if ((s[0] & 0xE0) == 0xC0)
+    {
+        codepoint = s[0] & 0x1F;
+        length = 2;
+    }
+    else if ((s[0] & 0xF0) == 0xE0)
+    {
+        codepoint = s[0] & 0x0F;
+        length = 3;
+    }
+    else if ((s[0] & 0xF8) == 0xF0)
+    {
+        codepoint = s[0] & 0x07;
+        length = 4;
+    }
+    else
+    {
+        *str += 1;
+        return ReplacementCodepoint;
+    }
+
+    // Stops at the terminator too, since it isn't a continuation byte
+    for (int i = 1; i < length; i++)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            *str += 1;
+            return ReplacementCodepoint;
+        }
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
+    }
+
+    // Overlong forms, surrogates and values past the last plane
+    static const uint32_t min_codepoint[5] = {0, 0, 0x80, 0x800, 0x10000};
+    if (codepoint < min_codepoint[length] || (codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF)
+    {
+        *str += 1;
+        return ReplacementCodepoint;
+    }
+
+    *str += length;
+    return codepoint;
+}
+
+
+// Empty slots hold codepoint UINT32_MAX, which no decoded codepoint can be
+int _FindGlyphSlot(const CachedGlyph* glyphs, int capacity, uint32_t codepoint)
+{
+    uint32_t mask = (uint32_t)capacity - 1;
+    uint32_t slot = (codepoint * 2654435761u) & mask;
+    while (glyphs[slot].codepoint != codepoint && glyphs[slot].codepoint != UINT32_MAX)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return (int)slot;
+}
+
+void _GrowGlyphTable(GlyphFont* font)
+{
+    int capacity = font->glyph_capacity > 0 ? font->glyph_capacity * 2 : GlyphTableMinCapacity;
+    CachedGlyph* glyphs = (CachedGlyph*)malloc(capacity * sizeof(CachedGlyph));
+    for (int i = 0; i < capacity; i++)
+    {
+        glyphs[i].codepoint = UINT32_MAX;
+    }
+
+    for (int i = 0; i < font->glyph_capacity; i++)
+    {
+        if (font->glyphs[i].codepoint != UINT32_MAX)
+        {
+            glyphs[_FindGlyphSlot(glyphs, capacity, font->glyphs[i].codepoint)] = font->glyphs[i];
+        }
+    }
+
+    free(font->glyphs);
+    font->glyphs = glyphs;
+    font->glyph_capacity = capacity;
+}
+
+const CachedGlyph* _InsertGlyph(GlyphFont* font, const CachedGlyph* glyph)
+{
+    // Kept under half full so probes stay short
+    if (2 * (font->glyph_count + 1) > font->glyph_capacity)
+    {
+        _GrowGlyphTable(font);
+    }
+    int slot = _FindGlyphSlot(font->glyphs, font->glyph_capacity, glyph->codepoint);
+    font->glyphs[slot] = *glyph;
+    font->glyph_count++;
+    return &font->glyphs[slot];
+}
+
+void _RasterizeGlyph(GlyphFont* font, int glyph_index, CachedGlyph* glyph)
+{
+    int advance = 0;
+    stbtt_GetGlyphHMetrics(&font->info, glyph_index, &advance, nullptr);
+    // SDF glyphs are baked smaller, their metrics are scaled up so both kinds of font lay out the same
+    float layout_scale = font->sdf ? FontLayoutSize / FontSdfBakeSize : 1.f;
+    glyph->advance = advance * font->scale * layout_scale;
+    glyph->page = -1;
+
+    int width = 0, height = 0, xoff = 0, yoff = 0;
+    unsigned char* sdf = nullptr;
+    if (font->sdf)
+    {
+        sdf = stbtt_GetGlyphSDF(&font->info, font->scale, glyph_index, FontSdfPadding, FontSdfOnEdge, FontSdfDistanceScale,
+                                &width, &height, &xoff, &yoff);
+        if (!sdf)
+        {
+            return;
+        }
+    }
+    else
+    {
+        int x1, y1;
+        stbtt_GetGlyphBitmapBox(&font->info, glyph_index, font->scale, font->scale, &xoff, &yoff, &x1, &y1);
+        width = x1 - xoff;
+        height = y1 - yoff;
+        if (width <= 0 || height <= 0)
+        {
+            return;
+        }
+    }
+
+    Mln::RectI rect;
+    unsigned char* pixels = _ReserveGlyphRect(font, width, height, &glyph->page, &rect);
+    if (pixels)
+    {
+        if (sdf)
+        {
+            for (int y = 0; y < height; y++)
+            {
+                memcpy(pixels + y * GLYPH_PAGE_SIZE, sdf + y * width, width);
+            }
+        }
+        else
+        {
+            stbtt_MakeGlyphBitmap(&font->info, pixels, width, height, GLYPH_PAGE_SIZE, font->scale, font->scale, glyph_index);
+        }
+
+        glyph->x0 = xoff * layout_scale;
+        glyph->y0 = yoff * layout_scale;
+        glyph->x1 = (xoff + width) * layout_scale;
+        glyph->y1 = (yoff + height) * layout_scale;
+        glyph->s0 = rect.x / (float)GLYPH_PAGE_SIZE;
+        glyph->t0 = rect.y / (float)GLYPH_PAGE_SIZE;
+        glyph->s1 = (rect.x + width) / (float)GLYPH_PAGE_SIZE;
+        glyph->t1 = (rect.y + height) / (float)GLYPH_PAGE_SIZE;
+    }
+
+    if (sdf)
+    {
+        stbtt_FreeSDF(sdf, nullptr);
+    }
+}
+
+// Shelf packing, glyphs of one font have similar heights so the shelves waste little. Returns null when every page is
+// full, the glyph then only advances the pen
+unsigned char* _ReserveGlyphRect(GlyphFont* font, int width, int height, int* page_index, Mln::RectI* rect)
+{
+    int padded_width = width + GlyphPadding;
+    int padded_height = height + GlyphPadding;
+    ASSERT(padded_width <= GLYPH_PAGE_SIZE && padded_height <= GLYPH_PAGE_SIZE, "Glyph larger than a glyph page");
+
+    GlyphPage* page = font->page_count > 0 ? &font->pages[font->page_count - 1] : nullptr;
+    if (page && page->shelf_x + padded_width > GLYPH_PAGE_SIZE)
+    {
+        page->shelf_x = 0;
+        page->shelf_y += page->shelf_height;
+        page->shelf_height = 0;
+    }
+    if (!page || page->shelf_y + padded_height > GLYPH_PAGE_SIZE)
+    {
+        if (font->page_count == MAX_GLYPH_PAGES)
+        {
+            Mln::PrintLog(LOG_ERROR, "All %d glyph pages of the font are full\n", MAX_GLYPH_PAGES);
+            *page_index = -1;
+            return nullptr;
+        }
+
+        page = &font->pages[font->page_count++];
+        *page = GlyphPage{};
+        page->image = Mln::CreateImage(GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, 1);
+        // No mipmaps, the whole chain would have to be rebuilt for every uploaded glyph
+        page->texture = LoadTextureFromImage(page->image, true, false);
+    }
+
+    *rect = Mln::RectI{page->shelf_x, page->shelf_y, width, height};
+    page->shelf_x += padded_width;
+    page->shelf_height = padded_height > page->shelf_height ? padded_height : page->shelf_height;
+
+    if (page->dirty.width == 0)
+    {
+        page->dirty = *rect;
+    }
+    else
+    {
+        int x0 = rect->x < page->dirty.x ? rect->x : page->dirty.x;
+        int y0 = rect->y < page->dirty.y ? rect->y : page->dirty.y;
+        int x1 = rect->x + width > page->dirty.x + page->dirty.width ? rect->x + width : page->dirty.x + page->dirty.width;
+        int y1 = rect->y + height > page->dirty.y + page->dirty.height ? rect->y + height : page->dirty.y + page->dirty.height;
+        page->dirty = Mln::RectI{x0, y0, x1 - x0, y1 - y0};
+    }
+
+    *page_index = font->page_count - 1;
+    return page->image.data + rect->y * GLYPH_PAGE_SIZE + rect->x;
+}
+
+// Compares the stamp of the TTF instead of reading it, so loading the bake stays a single read.
+// A TTF that isn't on disk doesn't invalidate the bake, it carries its own copy
+bool _IsBakeOfFont(const GlyphBakeHeader* header, const char* ttf_path)
+{
+    size_t size = 0;
+    long long mod_time = 0;
+    if (!Mln::GetFileInfo(ttf_path, &size, &mod_time))
+    {
+        return true;
+    }
+    return size == header->ttf_size && mod_time == header->ttf_mod_time;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "melon_types.hpp"
+#include "stb_truetype.h"
+#include <cstdint>
+
+// Glyphs rasterized the first time they are asked for. Each font shelf packs its glyphs into single channel atlas
+// pages, only the rectangles filled since the last upload are sent to the texture and a new page is started when one
+// is full. Nothing is rasterized when a font is loaded
+
+#ifndef GLYPH_PAGE_SIZE
+    #define GLYPH_PAGE_SIZE 512
+#endif
+
+#ifndef MAX_GLYPH_PAGES
+    #define MAX_GLYPH_PAGES 8
+#endif
+
+struct CachedGlyph{
+    uint32_t codepoint;
+    int page;                 // -1 for glyphs without an outline, like the space
+    float x0, y0, x1, y1;     // Offsets from the pen position in FontLayoutSize units
+    float s0, t0, s1, t1;
+    float advance;
+};
+
+struct GlyphPage{
+    Mln::Image image;         // CPU copy the glyphs are rasterized into
+    Mln::Texture texture;
+    int shelf_x, shelf_y, shelf_height;
+    Mln::RectI dirty;         // Not uploaded yet, empty when width is 0
+};
+
+struct GlyphFont{
+    unsigned char* file;      // The TTF, or the bake the TTF is embedded in
+    size_t file_size;
+    size_t ttf_size;          // info.data points at the TTF inside file
+    long long ttf_mod_time;   // Of the TTF on disk when it was loaded, bakes keep it to notice a changed TTF
+    stbtt_fontinfo info;
+    float scale;
+    bool sdf;
+
+    CachedGlyph* glyphs;      // Open addressing on the codepoint, capacity is a power of two
+    int glyph_count;
+    int glyph_capacity;
+
+    GlyphPage pages[MAX_GLYPH_PAGES];
+    int page_count;
+};
+
+bool LoadGlyphFont(GlyphFont* font, const char* path, bool sdf);
+// A bake is the font file with the pages and glyphs rasterized so far, it loads with one read and no rasterization.
+// The layout is the raw structs, so bakes are only read back by builds of the same version and architecture.
+// A bake is rejected when the size or modification time of the TTF at ttf_path changed since it was saved, without
+// reading the TTF. ttf_path can be null to skip the check
+bool LoadGlyphFontBake(GlyphFont* font, const char* path, const char* ttf_path);
+bool SaveGlyphFontBake(const GlyphFont* font, const char* path);
+void UnloadGlyphFont(GlyphFont* font);
+// The file, the glyph table and the pages, each page counted once for its image and once for its texture
+size_t GetGlyphFontMemory(const GlyphFont* font);
+
+// Rasterizes the glyph the first time, codepoints the font doesn't have share its missing glyph box
+const CachedGlyph* GetGlyph(GlyphFont* font, uint32_t codepoint);
+// Sends what was rasterized since the last call to the page textures, called before the pages are drawn
+void UploadGlyphPages(GlyphFont* font);
+
+// Decodes one codepoint and moves str past it, malformed sequences decode as U+FFFD one byte at a time
+uint32_t DecodeUtf8(const char** str);
@@ -0,0 +1,225 @@
+#include "glyph_runs.hpp"
+#include "core.hpp"
+#include <cstdlib>
+#include <cstring>
+
+constexpr int BucketCount = 2 * GLYPH_RUN_CACHE_SIZE;
+
+struct CachedRun{
+    bool used;
+    uint64_t hash;
+    uintptr_t font_id;
+    TextAlign alignment;
+    GlyphQuad* quads; // One allocation, the string follows the quads
+    const char* str;
+    int length;
+    int count;
+    float width;
+    int bytes;
+    uint64_t last_used;
+    int next; // Next run in the same bucket, -1 ends the chain
+};
+
+struct {
+    CachedRun runs[GLYPH_RUN_CACHE_SIZE];
+    int buckets[BucketCount];
+    uint64_t use_counter;
+
+    GlyphRunStats stats;
+} state = {0};
+
+uint64_t _HashRun(uintptr_t font_id, const char* str, int length, TextAlign alignment);
+int _TakeFreeRun();
+void _RemoveRun(int index);
+void _LayoutRun(CachedRun* run, GlyphFont* font);
+
+void InitGlyphRuns()
+{
+    state = {};
+    for (int i = 0; i < BucketCount; i++)
+    {
+        state.buckets[i] = -1;
+    }
+}
+
+void ShutdownGlyphRuns()
+{
+    for (int i = 0; i < GLYPH_RUN_CACHE_SIZE; i++)
+    {
+        if (state.runs[i].used)
+        {
+            _RemoveRun(i);
+        }
+    }
+}
+
+GlyphRun GetGlyphRun(uintptr_t font_id, GlyphFont* font, const char* str, TextAlign alignment)
+{
+    int length = (int)strlen(str);
+    uint64_t hash = _HashRun(font_id, str, length, alignment);
+    int* bucket = &state.buckets[hash % BucketCount];
+
+    for (int i = *bucket; i >= 0; i = state.runs[i].next)
+    {
+        CachedRun* run = &state.runs[i];
+        if (run->hash == hash && run->font_id == font_id && run->alignment == alignment && run->length == length && memcmp(run->str, str, length) == 0)
+        {
+            run->last_used = ++state.use_counter;
+            state.stats.hits++;
+            return GlyphRun{run->quads, run->count, run->width};
+        }
+    }
+
+    state.stats.misses++;
+
+    int index = _TakeFreeRun();
+    CachedRun* run = &state.runs[index];
+    // A codepoint takes at least one byte, so the length bounds the quad count
+    run->bytes = (int)(length * sizeof(GlyphQuad) + length + 1);
+    run->quads = (GlyphQuad*)malloc(run->bytes);
+    char* copy = (char*)(run->quads + length);
+    memcpy(copy, str, length + 1);
+
+    run->used = true;
+    run->hash = hash;
+    run->font_id = font_id;
+    run->alignment = alignment;
+    run->str = copy;
+    run->length = length;
+    run->last_used = ++state.use_counter;
+    _LayoutRun(run, font);
+
+    run->next = *bucket;
+    *bucket = index;
+    state.stats.runs++;
+    state.stats.bytes += run->bytes;
+
+    return GlyphRun{run->quads, run->count, run->width};
+}
+
+void ForgetGlyphRuns(uintptr_t font_id)
+{
+    for (int i = 0; i < GLYPH_RUN_CACHE_SIZE; i++)
+    {
+        if (state.runs[i].used && state.runs[i].font_id == font_id)
+        {
+            _RemoveRun(i);
+        }
+    }
+}
+
+// Text is only moved and scaled in the plane, the 2D part of the matrix is all it needs.
+// Matrix elements are [column][row]
+void GetGlyphCorners(const GlyphQuad* glyph, const Mln::Matrix& transform, Mln::Vector2 positions[4], Mln::Vector2 uvs[4])
+{
+    const float (*m)[4] = transform.Elements;
+    float x0_x = m[0][0] * glyph->x0 + m[3][0], x0_y = m[0][1] * glyph->x0 + m[3][1];
+    float x1_x = m[0][0] * glyph->x1 + m[3][0], x1_y = m[0][1] * glyph->x1 + m[3][1];
+    float y0_x = m[1][0] * glyph->y0, y0_y = m[1][1] * glyph->y0;
+    float y1_x = m[1][0] * glyph->y1, y1_y = m[1][1] * glyph->y1;
+
+    // This positions the text so the baseline is at the target position
+    positions[0] = Mln::Vector2{x1_x + y0_x, x1_y + y0_y};
+    positions[1] = Mln::Vector2{x1_x + y1_x, x1_y + y1_y};
+    positions[2] = Mln::Vector2{x0_x + y1_x, x0_y + y1_y};
+    positions[3] = Mln::Vector2{x0_x + y0_x, x0_y + y0_y};
+
+    uvs[0] = Mln::Vector2{glyph->s1, glyph->t0};
+    uvs[1] = Mln::Vector2{glyph->s1, glyph->t1};
+    uvs[2] = Mln::Vector2{glyph->s0, glyph->t1};
+    uvs[3] = Mln::Vector2{glyph->s0, glyph->t0};
+}
+
+GlyphRunStats EndGlyphRunFrame()
+{
+    GlyphRunStats stats = state.stats;
+    state.stats.hits = 0;
+    state.stats.misses = 0;
+    return stats;
+}
+
+
+// FNV-1a over the string, then the font and the alignment mixed in
+uint64_t _HashRun(uintptr_t font_id, const char* str, int length, TextAlign alignment)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (int i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char)str[i]) * 1099511628211ull;
+    }
+    hash = (hash ^ (uint64_t)font_id) * 1099511628211ull;
+    hash = (hash ^ (uint64_t)alignment) * 1099511628211ull;
+    return hash;
+}
+
+// An unused slot while there is one, otherwise the run that was drawn the longest ago is evicted
+int _TakeFreeRun()
+{
+    int oldest = 0;
+    for (int i = 0; i < GLYPH_RUN_CACHE_SIZE; i++)
+    {
+        if (!state.runs[i].used)
+        {
+            return i;
+        }
+        if (state.runs[i].last_used < state.runs[oldest].last_used)
+        {
+            oldest = i;
+        }
+    }
+
+    _RemoveRun(oldest);
+    return oldest;
+}
+
+void _RemoveRun(int index)
+{
+    CachedRun* run = &state.runs[index];
+    int* link = &state.buckets[run->hash % BucketCount];
+    while (*link != index)
+    {
+        ASSERT(*link >= 0, "Glyph run missing from its bucket");
+        link = &state.runs[*link].next;
+    }
+    *link = run->next;
+
+    state.stats.runs--;
+    state.stats.bytes -= run->bytes;
+    free(run->quads);
+    *run = CachedRun{};
+}
+
+// Measures and lays out in one walk. The width is the right edge of the last glyph, which is what MeasureText
+// used to add up from the advances. Glyphs without an outline only move the pen
+void _LayoutRun(CachedRun* run, GlyphFont* font)
+{
+    float x = 0;
+    run->count = 0;
+    run->width = 0.f;
+    const char* str = run->str;
+    while (*str)
+    {
+        const CachedGlyph* glyph = GetGlyph(font, DecodeUtf8(&str));
+        run->width = x + glyph->x1;
+        if (glyph->page >= 0)
+        {
+            run->quads[run->count++] = GlyphQuad{x + glyph->x0, glyph->y0, x + glyph->x1, glyph->y1, glyph->s0, glyph->t0, glyph->s1, glyph->t1, glyph->page};
+        }
+        x += glyph->advance;
+    }
+
+    float offset = 0.f;
+    if (run->alignment == TEXT_ALIGN_CENTER)
+    {
+        offset = -run->width * 0.5f;
+    }
+    else if (run->alignment == TEXT_ALIGN_RIGHT)
+    {
+        offset = -run->width;
+    }
+    for (int i = 0; i < run->count; i++)
+    {
+        run->quads[i].x0 += offset;
+        run->quads[i].x1 += offset;
+    }
+}
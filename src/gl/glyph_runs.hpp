@@ -0,0 +1,44 @@
+#pragma once
+
+#include "graphics_api.hpp"
+#include "glyph_cache.hpp"
+#include <cstdint>
+
+// Laid out strings kept between frames. A run holds the glyph quads of one string in font space with the alignment
+// already applied, so drawing a string that was seen before only has to transform the quads
+
+#ifndef GLYPH_RUN_CACHE_SIZE
+    #define GLYPH_RUN_CACHE_SIZE 256
+#endif
+
+struct GlyphQuad{
+    float x0, y0, x1, y1;
+    float s0, t0, s1, t1;
+    int page; // Glyph page of the font the quad samples
+};
+
+struct GlyphRun{
+    const GlyphQuad* quads;
+    int count;
+    float width; // What MeasureText reports
+};
+
+struct GlyphRunStats{
+    int hits;
+    int misses;
+    int runs;  // Cached right now
+    int bytes; // Heap memory held by the cached runs
+};
+
+void InitGlyphRuns();
+void ShutdownGlyphRuns();
+
+// The run stays valid until the next GetGlyphRun call. str is UTF-8, glyphs seen for the first time are rasterized
+// into the font's pages and still have to be uploaded with UploadGlyphPages before drawing
+GlyphRun GetGlyphRun(uintptr_t font_id, GlyphFont* font, const char* str, TextAlign alignment);
+void ForgetGlyphRuns(uintptr_t font_id);
+
+// Corners in WriteQuad order, transform is the model view projection of the whole string
+void GetGlyphCorners(const GlyphQuad* glyph, const Mln::Matrix& transform, Mln::Vector2 positions[4], Mln::Vector2 uvs[4]);
+
+GlyphRunStats EndGlyphRunFrame(); // Hits and misses restart every frame
@@ -3,6 +3,13 @@
 #include "core.hpp"
 #include "melon_types.hpp"
 #include "quad_renderer.hpp"
+#include "gl_state.hpp"
+#include "render_targets.hpp"
+#include "gl_handles.hpp"
+#include "sprite_transform.hpp"
+#include "glyph_runs.hpp"
+#include "glyph_cache.hpp"
+#include "handle_pool.hpp"
 
 #include <cstdint>
 #include <glad/glad.h>
@@ -10,47 +17,57 @@
 #if defined (OPENGL_ES)
     #include "gen/gles/default.fs.h"
     #include "gen/gles/default.vs.h"
-    #include "gen/gles/text.fs.h"
-    #include "gen/gles/text.vs.h"
+    #include "gen/gles/sprite.vs.h"
 #else
     #include "gen/gl/default.fs.h"
     #include "gen/gl/default.vs.h"
-    #include "gen/gl/text.fs.h"
-    #include "gen/gl/text.vs.h"
+    #include "gen/gl/sprite.vs.h"
 #endif
 
 #include <cstring>
 #include <cstdio>
 
-#include "stb_rect_pack.h"
+constexpr int InitialFontCapacity = 8;
 
-#include "stb_truetype.h"
+// Sprites transformed per ReserveQuads call in DrawRectsTextured
+constexpr int SpriteChunk = 256;
 
-#ifndef MAX_FONTS
-    #define MAX_FONTS 16
+#ifndef RENDER_STATS_HISTORY
+    #define RENDER_STATS_HISTORY 120
 #endif
 
 struct AtlasFont{
-    stbtt_packedchar packed_chars[256];
-    Mln::Texture texture;
+    GlyphFont glyphs;
+    QuadMode mode; // QUAD_MODE_TEXT_SDF for LoadFontSDF fonts
 };
 
 struct {
     Mln::Matrix view;
     Mln::Matrix projection;
+    int viewport_width;
+    int viewport_height;
+
+    // Set between BeginRenderTarget and EndRenderTarget
+    bool in_render_target;
+    Mln::RenderTarget render_target;
+    Mln::Matrix window_view;
+    Mln::Matrix window_projection;
 
     Mln::Shader sprite_shader;
-    Mln::Shader text_shader;
+    Mln::Shader sprite_instanced_shader;
+
+    HandlePool fonts; // AtlasFont, Mln::Font is the handle
 
-    AtlasFont fonts[MAX_FONTS];
-    int font_count;
-    uintptr_t font_ids[MAX_FONTS];
-    uintptr_t last_font_id;
+    RenderStats stats_history[RENDER_STATS_HISTORY];
+    uint64_t stats_frame;
 
 } state = {0};
 
 Mln::Shader _LoadShader(const char *vertexText, const char *fragmentText);
-AtlasFont* _FindFont(Mln::Font font, int* font_index);
+Mln::Font _LoadFont(const char* path, const char* ttf_path, bool sdf, bool bake);
+AtlasFont* _GetFont(Mln::Font font);
+Mln::Matrix _GetViewProjection();
+Mln::Matrix _GetProjection();
 
 void InitGraphics(int width, int height)
 {
@@ -67,13 +84,25 @@ void InitGraphics(int width, int height)
     }
 
 
+    InvalidateGLState();
+
     glViewport(0, 0, width, height);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // TODO: premultiplied alpha
+    state.viewport_width = width;
+    state.viewport_height = height;
+    SetBlendEnabled(true);
+    SetBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // Textures and shader output are premultiplied
 
-    state.sprite_shader = _LoadShader(default_vs, default_fs);
-    state.text_shader = _LoadShader(text_vs, text_fs);
+    InitGLHandles();
     InitQuadRenderer();
+    InitRenderTargets();
+    InitGlyphRuns();
+    InitHandlePool(&state.fonts, sizeof(AtlasFont), InitialFontCapacity);
+
+    // Sprites and text share one program and pick the sampling mode per vertex
+    state.sprite_shader = _LoadShader(default_vs, default_fs);
+    state.sprite_instanced_shader = _LoadShader(sprite_vs, default_fs);
+    RegisterShader(state.sprite_shader);
+    RegisterShader(state.sprite_instanced_shader);
 
 
     state.view = HMM_M4D(1.0);
@@ -82,12 +111,22 @@ void InitGraphics(int width, int height)
 
 void ShutdownGraphics()
 {
+    FreeHandlePool(&state.fonts);
+    ShutdownGlyphRuns();
+    ShutdownRenderTargets();
     ShutdownQuadRenderer();
+    ShutdownGLHandles();
 }
 
 void ResizeViewport(int width, int height)
 {
-    glViewport(0, 0, width, height);
+    // A bound render target keeps its own viewport, EndRenderTarget applies the new size
+    if (!state.in_render_target)
+    {
+        glViewport(0, 0, width, height);
+    }
+    state.viewport_width = width;
+    state.viewport_height = height;
 }
 
 void SetView(Mln::Matrix view)
@@ -102,22 +141,109 @@ void SetProjection(Mln::Matrix proj)
 
 void ClearBackground(Mln::Color color)
 {
+    // Draws are deferred until EndDrawing, anything recorded so far has to land before the clear
+    FlushBatches(FLUSH_CAUSE_EXPLICIT);
     glClearColor(color.R, color.G, color.B, color.A);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void BeginDrawing()
 {
+    SetLayer(0);
+    SetAdditive(0.f);
+}
+
+void SetDrawLayer(int layer)
+{
+    SetLayer(layer);
+}
+
+void SetDrawAdditive(float additive)
+{
+    SetAdditive(additive);
 }
 
 void EndDrawing()
 {
-    DrawBatch();
+    FlushBatches(FLUSH_CAUSE_END_OF_FRAME);
+
+    RenderStats stats = EndQuadRendererFrame();
+    EndGLStateFrame();
+    GLStateStats gl_stats = GetGLStateStats();
+    stats.texture_binds = gl_stats.texture_binds;
+    stats.shader_binds = gl_stats.program_binds;
+    stats.gl_calls_issued = gl_stats.issued;
+    stats.gl_calls_filtered = gl_stats.filtered;
+    GlyphRunStats glyph_stats = EndGlyphRunFrame();
+    stats.glyph_run_hits = glyph_stats.hits;
+    stats.glyph_run_misses = glyph_stats.misses;
+    stats.glyph_run_bytes = glyph_stats.bytes;
+
+    state.stats_history[state.stats_frame % RENDER_STATS_HISTORY] = stats;
+    state.stats_frame++;
+}
+
+RenderStats GetRenderStats()
+{
+    if (state.stats_frame == 0)
+    {
+        return RenderStats{};
+    }
+    return state.stats_history[(state.stats_frame - 1) % RENDER_STATS_HISTORY];
+}
+
+int GetRenderStatsHistory(RenderStats* stats, int max_count)
+{
+    int count = state.stats_frame < RENDER_STATS_HISTORY ? (int)state.stats_frame : RENDER_STATS_HISTORY;
+    if (count > max_count)
+    {
+        count = max_count;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        stats[i] = state.stats_history[(state.stats_frame - count + i) % RENDER_STATS_HISTORY];
+    }
+    return count;
+}
+
+Mln::Image CaptureFramebuffer()
+{
+    FlushBatches(FLUSH_CAUSE_EXPLICIT);
+
+    int width = state.in_render_target ? state.render_target.width : state.viewport_width;
+    int height = state.in_render_target ? state.render_target.height : state.viewport_height;
+    Mln::Image image = Mln::CreateImage(width, height, 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
+    if (state.in_render_target)
+    {
+        return image;
+    }
+
+    // GL reads the window bottom up, render targets are drawn upside down already
+    size_t row_size = (size_t)image.width * 4;
+    unsigned char* row = (unsigned char*)malloc(row_size);
+    for (int y = 0; y < image.height / 2; y++)
+    {
+        unsigned char* top = image.data + y * row_size;
+        unsigned char* bottom = image.data + (image.height - 1 - y) * row_size;
+        memcpy(row, top, row_size);
+        memcpy(top, bottom, row_size);
+        memcpy(bottom, row, row_size);
+    }
+    free(row);
+
+    return image;
 }
 
 Mln::Texture LoadTexture(const char* path, bool filter, bool mipmaps)
 {
     Mln::Image image = Mln::LoadImage(path);
+    if (image.data && image.components == 4)
+    {
+        Mln::ImagePremultiplyAlpha(image);
+    }
     Mln::Texture texture = LoadTextureFromImage(image, filter, mipmaps);
     Mln::UnloadImage(image);
     return texture;
@@ -136,7 +262,7 @@ Mln::Texture LoadTextureFromImage(Mln::Image image, bool filter, bool mipmaps)
     // -------------------------
     unsigned int texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
+    BindTexture2D(0, texture); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
     // set the texture wrapping parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -182,15 +308,76 @@ Mln::Texture LoadTextureFromImage(Mln::Image image, bool filter, bool mipmaps)
     
     result.width = image.width;
     result.height = image.height;
-    result.id = texture;
+    result.id = AddTextureHandle(texture);
 
     return result;
 
 }
 
+Mln::Texture LoadTextureFromMipChain(const Mln::Image* levels, int level_count, bool filter)
+{
+    ASSERT(level_count > 0 && levels[0].data, "A mip chain needs a base level");
+    ASSERT(levels[level_count - 1].width == 1 && levels[level_count - 1].height == 1, "A mip chain ends at 1x1");
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    BindTexture2D(0, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter ? GL_LINEAR : GL_NEAREST);
+
+    for (int i = 0; i < level_count; i++)
+    {
+        ASSERT(levels[i].components == 4, "Mip chains are RGBA");
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, levels[i].width, levels[i].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[i].data);
+    }
+
+    return Mln::Texture{AddTextureHandle(texture), levels[0].width, levels[0].height};
+}
+
+void UpdateTextureRect(Mln::Texture texture, Mln::Image image, Mln::RectI rect)
+{
+    ASSERT(image.width == texture.width && image.height == texture.height, "Image and texture sizes differ");
+    GLenum componentTypes[] = {
+        0,
+#if !defined(OPENGL_ES)
+        GL_RED,
+        GL_RG,
+        GL_RGB,
+        GL_RGBA
+#else
+        GL_LUMINANCE,
+        GL_LUMINANCE_ALPHA,
+        GL_RGB,
+        GL_RGBA
+#endif
+    };
+
+    // GLES 2 has no GL_UNPACK_ROW_LENGTH, so the rows of the rectangle are gathered first
+    size_t row_size = (size_t)rect.width * image.components;
+    unsigned char* pixels = (unsigned char*)malloc(row_size * rect.height);
+    for (int y = 0; y < rect.height; y++)
+    {
+        memcpy(pixels + y * row_size, image.data + ((size_t)(rect.y + y) * image.width + rect.x) * image.components, row_size);
+    }
+
+    BindTexture2D(0, GetTextureName(texture.id));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, componentTypes[image.components], GL_UNSIGNED_BYTE, pixels);
+    free(pixels);
+}
+
 void UnloadTexture(Mln::Texture texture)
 {
-    glDeleteTextures(1, &texture.id);
+    GLuint name = GetTextureName(texture.id);
+    if (name == 0)
+    {
+        return;
+    }
+    ForgetTexture(name);
+    glDeleteTextures(1, &name);
+    RemoveTextureHandle(texture.id);
     texture.id = -1;
     texture.width = 0;
     texture.height = 0;
@@ -211,20 +398,23 @@ void _DrawRectTextured(Mln::Matrix transform, Mln::Rect rect, Mln::Texture textu
     SetTexture(texture);
     SetShader(state.sprite_shader);
 
-    Quad quad = {0};
-    
     Mln::Vector2 top_right    = Mln::Vector2{rect.x + rect.width, rect.y              };
     Mln::Vector2 bottom_right = Mln::Vector2{rect.x + rect.width, rect.y + rect.height};
     Mln::Vector2 bottom_left  = Mln::Vector2{rect.x             , rect.y + rect.height};
     Mln::Vector2 top_left     = Mln::Vector2{rect.x             , rect.y              };
     
-    Mln::Matrix mvp = state.projection * state.view * transform;
-    
-    quad.vertices[0] = (mvp * HMM_Vec4{top_right.X   , top_right.Y   , 0, 1}).XY;
-    quad.vertices[1] = (mvp * HMM_Vec4{bottom_right.X, bottom_right.Y, 0, 1}).XY;
-    quad.vertices[2] = (mvp * HMM_Vec4{bottom_left.X , bottom_left.Y , 0, 1}).XY;
-    quad.vertices[3] = (mvp * HMM_Vec4{top_left.X    , top_left.Y    , 0, 1}).XY;
+    Mln::Matrix mvp = _GetViewProjection() * transform;
     
+    Mln::Vector2 positions[4];
+    positions[0] = (mvp * HMM_Vec4{top_right.X   , top_right.Y   , 0, 1}).XY;
+    positions[1] = (mvp * HMM_Vec4{bottom_right.X, bottom_right.Y, 0, 1}).XY;
+    positions[2] = (mvp * HMM_Vec4{bottom_left.X , bottom_left.Y , 0, 1}).XY;
+    positions[3] = (mvp * HMM_Vec4{top_left.X    , top_left.Y    , 0, 1}).XY;
+    if (CullQuad(positions))
+    {
+        return;
+    }
+
     float texture_w = texture.width;
     float texture_h = texture.height;
 
@@ -233,15 +423,13 @@ void _DrawRectTextured(Mln::Matrix transform, Mln::Rect rect, Mln::Texture textu
     float sprite_uv_w = coords.width / texture_w;
     float sprite_uv_h = coords.height / texture_h;
 
-    quad.uvs[0] = Mln::Vector2{sprite_uv_x + sprite_uv_w, sprite_uv_y};
-    quad.uvs[1] = Mln::Vector2{sprite_uv_x + sprite_uv_w, sprite_uv_y + sprite_uv_h};
-    quad.uvs[2] = Mln::Vector2{sprite_uv_x, sprite_uv_y + sprite_uv_h};
-    quad.uvs[3] = Mln::Vector2{sprite_uv_x, sprite_uv_y};
+    Mln::Vector2 uvs[4];
+    uvs[0] = Mln::Vector2{sprite_uv_x + sprite_uv_w, sprite_uv_y};
+    uvs[1] = Mln::Vector2{sprite_uv_x + sprite_uv_w, sprite_uv_y + sprite_uv_h};
+    uvs[2] = Mln::Vector2{sprite_uv_x, sprite_uv_y + sprite_uv_h};
+    uvs[3] = Mln::Vector2{sprite_uv_x, sprite_uv_y};
 
-    quad.color = color;
-
-
-    PushQuad(quad);
+    WriteQuad(ReserveQuads(1), positions, uvs, color, QUAD_MODE_SPRITE);
 }
 
 void DrawRectTextured(Mln::Rect rect, Mln::Texture texture, Mln::RectI texture_coords, Mln::Color color)
@@ -254,6 +442,86 @@ void DrawRectTextured(Mln::Matrix transform, Mln::Texture texture, Mln::RectI co
     _DrawRectTextured(transform, Mln::Rect{-(float)coords.width / 2.f, -(float)coords.height / 2.f, (float)coords.width, (float)coords.height}, texture, coords, color);
 }
 
+void DrawRectTexturedInstanced(Mln::Transform2D transform, Mln::Texture texture, Mln::RectI coords, Mln::Color color, Mln::Vector2 pivot)
+{
+    if (!SupportsInstancing() || IsRecordingStaticGeometry())
+    {
+        Mln::Rect rect = {-pivot.X * coords.width, -pivot.Y * coords.height, (float)coords.width, (float)coords.height};
+        _DrawRectTextured(Mln::GetMatrix(transform), rect, texture, coords, color);
+        return;
+    }
+
+    SetTexture(texture);
+    SetShader(state.sprite_instanced_shader);
+    SetViewProjection(_GetProjection() * state.view);
+
+    float texture_w = texture.width;
+    float texture_h = texture.height;
+
+    QuadInstance instance;
+    instance.position = transform.position;
+    instance.size = Mln::Vector2{coords.width * transform.scale.X, coords.height * transform.scale.Y};
+    instance.rotation = transform.rotation;
+    instance.uv_rect[0] = PackUnorm16(coords.x / texture_w);
+    instance.uv_rect[1] = PackUnorm16(coords.y / texture_h);
+    instance.uv_rect[2] = PackUnorm16(coords.width / texture_w);
+    instance.uv_rect[3] = PackUnorm16(coords.height / texture_h);
+    instance.pivot[0] = PackUnorm16(pivot.X);
+    instance.pivot[1] = PackUnorm16(pivot.Y);
+    instance.color = PackColor(color);
+
+    PushInstance(instance);
+}
+
+void DrawRectsTextured(Mln::Texture texture, const TexturedRect* rects, int count)
+{
+    SetTexture(texture);
+    SetShader(state.sprite_shader);
+
+    Mln::Matrix view_projection = _GetViewProjection();
+
+    float texture_w = texture.width;
+    float texture_h = texture.height;
+
+    while (count > 0)
+    {
+        int chunk = count < SpriteChunk ? count : SpriteChunk;
+        QuadVertex* vertices = ReserveQuads(chunk);
+
+        // Off screen sprites are skipped while the vertices are written and their quads handed back at the end
+        Mln::Vector2 corners[SpriteChunk * 4];
+        TransformSpriteCorners(rects, chunk, view_projection, &corners[0].X, sizeof(Mln::Vector2));
+
+        int kept = 0;
+        for (int i = 0; i < chunk; i++)
+        {
+            if (CullQuad(corners + 4 * i))
+            {
+                continue;
+            }
+
+            const Mln::RectI& coords = rects[i].texture_source;
+            float sprite_uv_x = coords.x / texture_w;
+            float sprite_uv_y = coords.y / texture_h;
+            float sprite_uv_w = coords.width / texture_w;
+            float sprite_uv_h = coords.height / texture_h;
+
+            Mln::Vector2 uvs[4];
+            uvs[0] = Mln::Vector2{sprite_uv_x + sprite_uv_w, sprite_uv_y};
+            uvs[1] = Mln::Vector2{sprite_uv_x + sprite_uv_w, sprite_uv_y + sprite_uv_h};
+            uvs[2] = Mln::Vector2{sprite_uv_x, sprite_uv_y + sprite_uv_h};
+            uvs[3] = Mln::Vector2{sprite_uv_x, sprite_uv_y};
+
+            WriteQuad(vertices + 4 * kept, corners + 4 * i, uvs, rects[i].color, QUAD_MODE_SPRITE);
+            kept++;
+        }
+        ReleaseQuads(chunk - kept);
+
+        rects += chunk;
+        count -= chunk;
+    }
+}
+
 void DrawRectTexturedNinePatch(Mln::Matrix transform, Mln::Rect rect, Mln::Texture texture, Mln::RectI coords, Mln::Color color, Mln::Vector4 margins)
 {
     Mln::Rect top_left     = (Mln::Rect){rect.x, rect.y, margins.X, margins.Y};
@@ -302,63 +570,129 @@ void DrawRectTexturedNinePatch(Mln::Matrix transform, Mln::Rect rect, Mln::Textu
 
 }
 
-Mln::Font LoadFont(const char* path)
+Mln::StaticBatch CreateStaticBatch()
+{
+    int geometry = CreateStaticGeometry();
+    return Mln::StaticBatch{geometry < 0 ? Mln::InvalidID : (Mln::id_t)geometry};
+}
+
+void UnloadStaticBatch(Mln::StaticBatch batch)
 {
-    ASSERT(state.font_count + 1 < MAX_FONTS, "Maximum font limit reached");
-    if (state.font_count + 1 >= MAX_FONTS)
+    DestroyStaticGeometry(batch.id);
+}
+
+void BeginStaticBatch(Mln::StaticBatch batch)
+{
+    BeginStaticGeometry(batch.id);
+}
+
+void EndStaticBatch()
+{
+    EndStaticGeometry();
+}
+
+void MarkStaticBatchDirty(Mln::StaticBatch batch)
+{
+    MarkStaticGeometryDirty(batch.id);
+}
+
+bool IsStaticBatchDirty(Mln::StaticBatch batch)
+{
+    return IsStaticGeometryDirty(batch.id);
+}
+
+void DrawStaticBatch(Mln::StaticBatch batch, Mln::Matrix transform, Mln::Color tint)
+{
+    DrawStaticGeometry(batch.id, _GetProjection() * state.view * transform, tint);
+}
+
+Mln::RenderTarget LoadRenderTarget(int width, int height)
+{
+    int slot = AcquireRenderTarget(width, height);
+    if (slot < 0)
     {
-        return nullptr;
+        return Mln::RenderTarget{Mln::InvalidID, Mln::Texture{Mln::InvalidID, 0, 0}, 0, 0};
     }
+    return Mln::RenderTarget{(Mln::id_t)slot, GetRenderTargetTexture(slot), width, height};
+}
 
+void UnloadRenderTarget(Mln::RenderTarget target)
+{
+    ASSERT(!state.in_render_target || state.render_target.id != target.id, "Render target is still bound");
+    // The texture may still be referenced by draws that have not been flushed, and a pooled target can be handed
+    // out again and cleared before they are
+    FlushBatches(FLUSH_CAUSE_EXPLICIT);
+    ReleaseRenderTarget(target.id);
+}
 
-    // TODO: Handle errors
-    // TODO: Make a global scratch buffer for images?
-    
-    // Get the next font slot
-    Mln::id_t font_id = ++state.last_font_id;
-    AtlasFont* font = &state.fonts[state.font_count];
-    ASSERT(state.font_ids[state.font_count] == 0, "The next unused font has a valid id!");
-    state.font_ids[state.font_count] = font_id;
-    state.font_count++;
+void BeginRenderTarget(Mln::RenderTarget target)
+{
+    ASSERT(!state.in_render_target, "Render targets can not be nested");
+    ASSERT(!IsRecordingStaticGeometry(), "Render targets can not be bound while recording a static batch");
 
-    stbtt_pack_context ctx;
+    FlushBatches(FLUSH_CAUSE_EXPLICIT);
+    BindRenderTarget(target.id);
+    glViewport(0, 0, target.width, target.height);
 
+    state.in_render_target = true;
+    state.render_target = target;
+    state.window_view = state.view;
+    state.window_projection = state.projection;
+}
 
-    Mln::Image font_atlas_image = Mln::CreateImage(512, 512, 1);
+void EndRenderTarget()
+{
+    ASSERT(state.in_render_target, "EndRenderTarget without BeginRenderTarget");
 
-    stbtt_PackBegin(&ctx, font_atlas_image.data, 512, 512, 0, 2, nullptr);
+    FlushBatches(FLUSH_CAUSE_EXPLICIT);
+    BindRenderTarget(-1);
+    glViewport(0, 0, state.viewport_width, state.viewport_height);
 
-    FILE* file = fopen(path, "rb");
-    
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    state.in_render_target = false;
+    state.view = state.window_view;
+    state.projection = state.window_projection;
+}
 
-    unsigned char* ttf_buffer = (unsigned char*)malloc(size + 1);
+Mln::Font LoadFont(const char* path)
+{
+    return _LoadFont(path, nullptr, false, false);
+}
 
-    fread(ttf_buffer, 1, size, file);
-    fclose(file);
-    
-    stbtt_PackFontRange(&ctx, ttf_buffer, 0, 48, 0, 256, font->packed_chars);
-    stbtt_PackEnd(&ctx);
-    
-    free(ttf_buffer);
+Mln::Font LoadFontSDF(const char* path)
+{
+    return _LoadFont(path, nullptr, true, false);
+}
 
-    font->texture = LoadTextureFromImage(font_atlas_image, true, true);
-    
-#if defined(GENERATE_FONT_ATLAS)
-    Mln::WriteImage(font_atlas_image, "font.png");
-#endif
-    
-    Mln::UnloadImage(font_atlas_image);
+Mln::Font LoadFontBake(const char* path, const char* ttf_path)
+{
+    return _LoadFont(path, ttf_path, false, true);
+}
 
-    return (void*)(uintptr_t)font_id;
+bool SaveFontBake(Mln::Font font, const char* path)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+    ASSERT(atlas_font, "Font not found");
+    return atlas_font && SaveGlyphFontBake(&atlas_font->glyphs, path);
+}
+
+Mln::Font _LoadFont(const char* path, const char* ttf_path, bool sdf, bool bake)
+{
+    // Only the font file is read here, glyphs are rasterized when they are first measured or drawn
+    AtlasFont font = {};
+    bool loaded = bake ? LoadGlyphFontBake(&font.glyphs, path, ttf_path) : LoadGlyphFont(&font.glyphs, path, sdf);
+    if (!loaded)
+    {
+        return nullptr;
+    }
+    font.mode = font.glyphs.sdf ? QUAD_MODE_TEXT_SDF : QUAD_MODE_TEXT;
+
+    // Handles are never 0, so a null Font stays the failure value
+    return (void*)(uintptr_t)AddPoolItem(&state.fonts, &font);
 }
 
 void UnloadFont(Mln::Font font)
 {
-    int font_index = 0;
-    AtlasFont* atlas_font =_FindFont(font, &font_index);
+    AtlasFont* atlas_font = _GetFont(font);
 
     ASSERT(atlas_font != nullptr, "Font could not be found for unloading.");
     if (atlas_font == nullptr)
@@ -366,98 +700,86 @@ void UnloadFont(Mln::Font font)
         return;
     }
 
-    UnloadTexture(atlas_font->texture);
-
+    ForgetGlyphRuns((uintptr_t)font);
+    UnloadGlyphFont(&atlas_font->glyphs);
+    RemovePoolItem(&state.fonts, (Mln::id_t)(uintptr_t)font);
+}
 
-    state.font_ids[font_index] = state.font_ids[state.font_count - 1];
-    state.fonts[font_index] = state.fonts[state.font_count - 1];
-    state.font_ids[state.font_count - 1] = 0;
-    state.font_count--;
+size_t GetFontMemory(Mln::Font font)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+    ASSERT(atlas_font, "Font not found");
+    return atlas_font ? GetGlyphFontMemory(&atlas_font->glyphs) : 0;
 }
 
 float MeasureText(Mln::Font font, const char* str)
 {
-    AtlasFont* atlas_font = _FindFont(font, NULL);
+    AtlasFont* atlas_font = _GetFont(font);
     ASSERT(atlas_font, "Font not found");
-    int length = strlen(str);
-
-    float x = 0;
-    float y = 0;
-    for (size_t i = 0; i < length; i++)
+    if (atlas_font == nullptr)
     {
-        float x_advance = 0, y_advance = 0;
-        char character = str[i];
-        stbtt_aligned_quad quad;
-        stbtt_GetPackedQuad(atlas_font->packed_chars, 512, 512, character, &x_advance, &y_advance, &quad, 0);
-
-        if (i == length - 1)
-        {
-            x += quad.x1;
-        }
-        else
-        {
-            x += x_advance;
-        }
+        return 0.f;
     }
 
-    return x;
+    return GetGlyphRun((uintptr_t)font, &atlas_font->glyphs, str, TEXT_ALIGN_LEFT).width;
 }
 
 void DrawText(Mln::Font font, const char *str, Mln::Vector2 position, float scale, Mln::Color color, TextAlign alignment)
 {
-    AtlasFont* atlas_font = _FindFont(font, NULL);
+    AtlasFont* atlas_font = _GetFont(font);
     ASSERT(atlas_font, "Font not found");
-
-
-    SetTexture(atlas_font->texture);
-    SetShader(state.text_shader);
-    
-    size_t str_length = strlen(str);
-
-    float text_width = MeasureText(font, str);
-    Mln::Matrix alignment_offset = HMM_M4D(1.0f);
-    switch (alignment)
+    if (atlas_font == nullptr)
     {
-    case TEXT_ALIGN_LEFT:
-        alignment_offset = HMM_M4D(1.0f);
-        break;
-    case TEXT_ALIGN_CENTER:
-        alignment_offset = HMM_Translate({-text_width * 0.5f, 0.f, 0.f});
-        break;
-    case TEXT_ALIGN_RIGHT:
-        alignment_offset = HMM_Translate({-text_width, 0.f, 0.f});
-        break;
+        return;
     }
 
-    Mln::Matrix model = HMM_Translate({position.X, position.Y, 0.f}) * HMM_Scale({scale, scale, 1.f}) * alignment_offset;
-    Mln::Matrix mvp = state.projection * state.view * model;
+    SetShader(state.sprite_shader);
+
+    // Laid out once and reused while the string keeps being drawn, the alignment is part of the run
+    GlyphRun run = GetGlyphRun((uintptr_t)font, &atlas_font->glyphs, str, alignment);
+    UploadGlyphPages(&atlas_font->glyphs);
 
+    Mln::Matrix model = HMM_Translate({position.X, position.Y, 0.f}) * HMM_Scale({scale, scale, 1.f});
+    Mln::Matrix mvp = _GetViewProjection() * model;
 
-    float x = 0;
-    float y = 0;
-    for (size_t i = 0; i < str_length; i++)
+    int page = -1;
+    for (int i = 0; i < run.count; i++)
     {
-        char character = str[i];
-        stbtt_aligned_quad font_quad;
-        stbtt_GetPackedQuad(atlas_font->packed_chars, 512, 512, character, &x, &y, &font_quad, 0);
-        
-        Quad quad;
+        Mln::Vector2 positions[4];
+        Mln::Vector2 uvs[4];
+        GetGlyphCorners(&run.quads[i], mvp, positions, uvs);
+        if (CullQuad(positions))
+        {
+            continue;
+        }
 
-        // This positions the text so the baseline is at the target position
-        quad.vertices[0] = (mvp * HMM_Vec4{font_quad.x1, font_quad.y0, 0, 1}).XY;
-        quad.vertices[1] = (mvp * HMM_Vec4{font_quad.x1, font_quad.y1, 0, 1}).XY;
-        quad.vertices[2] = (mvp * HMM_Vec4{font_quad.x0, font_quad.y1, 0, 1}).XY;
-        quad.vertices[3] = (mvp * HMM_Vec4{font_quad.x0, font_quad.y0, 0, 1}).XY;
-        
-        quad.uvs[0] = {font_quad.s1, font_quad.t0};
-        quad.uvs[1] = {font_quad.s1, font_quad.t1};
-        quad.uvs[2] = {font_quad.s0, font_quad.t1};
-        quad.uvs[3] = {font_quad.s0, font_quad.t0};
-        
-        quad.color = color;
+        if (run.quads[i].page != page)
+        {
+            page = run.quads[i].page;
+            SetTexture(atlas_font->glyphs.pages[page].texture);
+        }
+        WriteQuad(ReserveQuads(1), positions, uvs, color, atlas_font->mode);
+    }
+}
+
+Mln::Matrix _GetViewProjection()
+{
+    // Static batches are recorded in world space, the camera is applied when they are drawn
+    if (IsRecordingStaticGeometry())
+    {
+        return HMM_M4D(1.0f);
+    }
+    return _GetProjection() * state.view;
+}
 
-        PushQuad(quad);
+Mln::Matrix _GetProjection()
+{
+    // Flipped inside render targets so their first row is the top of the image, like every other texture
+    if (state.in_render_target)
+    {
+        return HMM_Scale({1.f, -1.f, 1.f}) * state.projection;
     }
+    return state.projection;
 }
 
 Mln::Shader _LoadShader(const char *vertexText, const char *fragmentText)
@@ -513,26 +835,11 @@ Mln::Shader _LoadShader(const char *vertexText, const char *fragmentText)
         return Mln::Shader{Mln::InvalidID};
     }
 
-    return Mln::Shader{shaderProgram};
+    return Mln::Shader{AddShaderHandle(shaderProgram)};
 }
 
 
-AtlasFont* _FindFont(Mln::Font font, int* font_index)
+AtlasFont* _GetFont(Mln::Font font)
 {
-    uintptr_t font_id = (uintptr_t)font;
-    AtlasFont* atlas_font = nullptr;
-    for (int i = 0; i < MAX_FONTS; i++)
-    {
-        if (state.font_ids[i] == font_id)
-        {
-            atlas_font = &state.fonts[i];
-            if (font_index)
-            {
-                *font_index = i;
-            }
-            break;
-        }
-    }
-
-    return atlas_font;
+    return (AtlasFont*)GetPoolItem(&state.fonts, (Mln::id_t)(uintptr_t)font);
 }
\ No newline at end of file
@@ -1,8 +1,14 @@
-
 #include "quad_renderer.hpp"
+#include "core.hpp"
 #include <GLES/gl.h>
 #include <glad/glad.h>
+#include "gl_state.hpp"
+#include "gl_handles.hpp"
 #include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
 
 
 using namespace Mln;
@@ -10,147 +16,1406 @@ constexpr size_t MaxQuads = 2 * 1024;
 
 constexpr unsigned int MaxVertices = 4 * MaxQuads;
 constexpr unsigned int MaxIndices = 6 * MaxQuads;
+constexpr unsigned int MaxInstances = MaxQuads;
+constexpr int InitialCommands = 1024;
+constexpr int MaxBatches = 1024; // Per segment
+
+// Must match the size of the uTextures sampler array in the shaders
+constexpr int MaxTextureSlots = 8;
+static const GLint TextureUnits[MaxTextureSlots] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+// Frames the GPU may still be reading from. Each frame streams into its own region of the ring guarded by one fence,
+// so the flushes within a frame never wait on each other
+constexpr int StreamFrames = 3;
+// Full segments one region holds, smaller flushes share the room. The game over screen flushes three times a frame,
+// a frame streaming more than this starts its region over once the GPU has drawn what the frame put there
+constexpr int StreamFrameSegments = 4;
+constexpr unsigned int FrameVertices = StreamFrameSegments * MaxVertices;
+constexpr unsigned int FrameInstances = StreamFrameSegments * MaxInstances;
+
+#define GET_UNIFORM_LOCATION(program, var) (program)->var = glGetUniformLocation(GetProgramName((program)->shader.id), #var)
+
+// Not part of the 3.3 core loader, fetched at runtime when the context exposes buffer storage
+#ifndef GL_MAP_PERSISTENT_BIT
+    #define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+    #define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void (APIENTRYP PFN_BufferStorage)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+
+#ifndef GL_HALF_FLOAT
+    #define GL_HALF_FLOAT 0x140B
+#endif
+
+// Describes one vertex attribute so attribute setup can be driven by data
+struct VertexAttribute{
+    const char* name;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    size_t offset;
+};
+
+struct VertexLayout{
+    const VertexAttribute* attributes;
+    int attribute_count;
+    GLsizei stride;
+};
+
+constexpr int MaxLayoutAttributes = 8;
+
+typedef QuadVertex Vertex;
+
+#if defined(QUAD_RENDERER_COMPACT_VERTICES)
+    #if defined(QUAD_RENDERER_HALF_POSITIONS)
+    constexpr GLenum PositionType = GL_HALF_FLOAT;
+    #else
+    constexpr GLenum PositionType = GL_FLOAT;
+    #endif
 
-#define GET_ATTRIBUTE_LOCATION(var) state.var = glGetAttribLocation(state.active_shader.id, #var)
-#define GET_UNIFORM_LOCATION(var) state.var = glGetUniformLocation(state.active_shader.id, #var)
+static const VertexAttribute QuadAttributes[] = {
+    {"aPos",      2, PositionType,      GL_FALSE, offsetof(Vertex, position)},
+    {"aColor",    4, GL_UNSIGNED_BYTE,  GL_TRUE,  offsetof(Vertex, color)},
+    {"aTexCoord", 2, GL_UNSIGNED_SHORT, GL_TRUE,  offsetof(Vertex, uv)},
+    {"aTexSlot",  1, GL_UNSIGNED_BYTE,  GL_FALSE, offsetof(Vertex, texture_slot)},
+    {"aMode",     1, GL_UNSIGNED_BYTE,  GL_FALSE, offsetof(Vertex, mode)},
+    {"aAdditive", 1, GL_UNSIGNED_BYTE,  GL_TRUE,  offsetof(Vertex, additive)},
+};
+#else
+static const VertexAttribute QuadAttributes[] = {
+    {"aPos",      2, GL_FLOAT, GL_FALSE, offsetof(Vertex, position)},
+    {"aColor",    4, GL_FLOAT, GL_FALSE, offsetof(Vertex, color)},
+    {"aTexCoord", 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, uv)},
+    {"aTexSlot",  1, GL_FLOAT, GL_FALSE, offsetof(Vertex, texture_slot)},
+    {"aMode",     1, GL_FLOAT, GL_FALSE, offsetof(Vertex, mode)},
+    {"aAdditive", 1, GL_FLOAT, GL_FALSE, offsetof(Vertex, additive)},
+};
+#endif
+
+static const VertexAttribute InstanceAttributes[] = {
+    {"iPosition", 2, GL_FLOAT,          GL_FALSE, offsetof(QuadInstance, position)},
+    {"iSize",     2, GL_FLOAT,          GL_FALSE, offsetof(QuadInstance, size)},
+    {"iRotation", 1, GL_FLOAT,          GL_FALSE, offsetof(QuadInstance, rotation)},
+    {"iUvRect",   4, GL_UNSIGNED_SHORT, GL_TRUE,  offsetof(QuadInstance, uv_rect)},
+    {"iPivot",    2, GL_UNSIGNED_SHORT, GL_TRUE,  offsetof(QuadInstance, pivot)},
+    {"iColor",    4, GL_UNSIGNED_BYTE,  GL_TRUE,  offsetof(QuadInstance, color)},
+    {"iTexSlot",  1, GL_UNSIGNED_BYTE,  GL_FALSE, offsetof(QuadInstance, texture_slot)},
+    {"iAdditive", 1, GL_UNSIGNED_BYTE,  GL_TRUE,  offsetof(QuadInstance, additive)},
+};
+
+static const VertexAttribute CornerAttributes[] = {
+    {"aCorner", 2, GL_FLOAT, GL_FALSE, 0},
+};
+
+static const VertexLayout QuadLayout = {QuadAttributes, sizeof(QuadAttributes) / sizeof(*QuadAttributes), sizeof(Vertex)};
+static const VertexLayout InstanceLayout = {InstanceAttributes, sizeof(InstanceAttributes) / sizeof(*InstanceAttributes), sizeof(QuadInstance)};
+static const VertexLayout CornerLayout = {CornerAttributes, sizeof(CornerAttributes) / sizeof(*CornerAttributes), sizeof(Vector2)};
 
+enum StreamMode
+{
+    STREAM_MODE_ORPHAN,     // Reallocate the buffer store before each upload, works everywhere including WebGL
+    STREAM_MODE_RING,       // Unsynchronized map of the next ring segment guarded by fences
+    STREAM_MODE_PERSISTENT, // Buffer stays mapped for its whole lifetime, uploads are a memcpy
+};
+
+enum BatchKind
+{
+    BATCH_QUADS,
+    BATCH_INSTANCES,
+    BATCH_STATIC,   // Replays retained geometry, never merged with its neighbours
+};
+
+// A run of quads or instances recorded with the same state between two flushes.
+// Sort key from most to least significant: layer (8 bits), shader (12 bits), submission order (32 bits).
+// Textures are left out of the key since switching between them only costs a slot in the batch
+struct DrawCommand{
+    uint64_t key;
+    BatchKind kind;
+    Mln::Shader shader;
+    Mln::Texture texture;
+    Mln::Matrix view_projection; // Full transform for static geometry
+    Mln::Color tint;
+    unsigned int first; // First vertex or instance in the recording arrays, geometry index for static geometry
+    unsigned int count;
+};
 
-#pragma pack(push, 1)
-struct Vertex{
-    Vector2 position;
-    Color color;
-    Vector2 uv;
+// Draw call built by coalescing sorted commands, every texture it samples is bound to its own unit
+struct Batch{
+    BatchKind kind;
+    Mln::Shader shader;
+    Mln::Texture textures[MaxTextureSlots];
+    int texture_count;
+    Mln::Matrix view_projection;
+    Mln::Color tint;
+    unsigned int first; // First vertex or instance in the uploaded segment, geometry index for static geometry
+    unsigned int count;
+};
+
+// Attribute and uniform locations of a program, queried once when the shader is registered,
+// together with vertex arrays that have the quad and instance layouts baked for those locations
+struct ProgramLocations{
+    Mln::Shader shader;
+    GLuint quad_vao;
+    GLuint instance_vao;
+    GLint quad_locations[MaxLayoutAttributes];
+    GLint instance_locations[MaxLayoutAttributes];
+    GLint corner_locations[MaxLayoutAttributes];
+
+    GLint uTextures;
+    GLint uViewProjection;
+    GLint uTint;
+
+    // Last values uploaded to the program
+    Mln::Matrix view_projection;
+    Mln::Color tint;
+};
+
+constexpr int MaxPrograms = 16;
+
+// Vertices of a static geometry that sample the same textures with the same shader
+struct StaticRange{
+    Mln::Shader shader;
+    Mln::Texture textures[MaxTextureSlots];
+    int texture_count;
+    unsigned int first;
+    unsigned int count;
+};
+
+constexpr int MaxStaticGeometries = 32;
+constexpr int MaxStaticRanges = 32;
+
+struct StaticGeometry{
+    bool used;
+    bool dirty;
+    GLuint buffer;
+    GLuint vaos[MaxPrograms]; // Baked the first time a program draws the geometry
+    StaticRange ranges[MaxStaticRanges];
+    int range_count;
+    unsigned int vertex_count;
+    Mln::Vector2 bounds_min; // Recorded positions, used to cull the whole geometry
+    Mln::Vector2 bounds_max;
+};
+
+struct StreamBuffer{
+    GLuint buffer;
+    size_t segment_size;
+    unsigned char* mapped;
 };
-#pragma pack(pop)
 
 struct {
-    Vertex vertices[MaxVertices];
-    unsigned int indices[MaxIndices];
+    // Everything recorded since the last flush. The arrays grow past what one segment uploads, FlushBatches sorts
+    // all of it and draws it a segment at a time
+    Vertex* vertices;
     size_t vertex_count;
+    size_t vertex_capacity;
+
+    QuadInstance* instances;
+    size_t instance_count;
+    size_t instance_capacity;
 
-    GLuint vao;
-    GLuint vbo;
+    DrawCommand* commands;
+    int command_count;
+    size_t command_capacity;
+
+    unsigned int indices[MaxIndices];
+
+    Batch batches[MaxBatches];
+    int batch_count;
+
+    // Only used when the streams are orphaned, mapped streams are written in place
+    Vertex upload_vertices[MaxVertices];
+    QuadInstance upload_instances[MaxInstances];
+
+    StaticGeometry static_geometries[MaxStaticGeometries];
+    StaticGeometry* recording;
+    Vertex record_vertices[MaxVertices];
+
+    StreamMode stream_mode;
+    int stream_frame;                    // Region of the ring the current frame streams into
+    bool stream_frame_started;           // The region is free to write, its fence has been waited on
+    unsigned int frame_vertex_cursor;    // Vertices and instances this frame streamed into its region so far
+    unsigned int frame_instance_cursor;
+    unsigned int segment_first_vertex;   // Where the flush being drawn starts in the stream buffers
+    unsigned int segment_first_instance;
+    GLsync frame_fences[StreamFrames];
+
+    bool instancing;
+    bool vertex_arrays;
+    int texture_slots;
+
+    GLuint setup_vao; // Holds the index buffer binding while buffers are created
+    StreamBuffer vertex_stream;
+    StreamBuffer instance_stream;
+    GLuint corner_vbo;
     GLuint ebo;
 
     Mln::Shader active_shader;
     Mln::Texture active_texture;
+    Mln::Matrix active_view_projection;
+    int active_layer;
+    float active_additive;
+
+    ProgramLocations programs[MaxPrograms];
+    int program_count;
 
-    GLuint aPos;
-    GLuint aColor;
-    GLuint aTexCoord;
+    ProgramLocations* bound_program;
 
-    GLuint uTexture;
+    RenderStats stats;
 } state = {0};
 
 
 void _CreateBuffers();
-void _GetLocations();
+void _CreateStreamBuffer(StreamBuffer* stream);
+void _DeleteStreamBuffer(StreamBuffer* stream);
+unsigned char* _MapStream(StreamBuffer* stream, void* staging, size_t offset, size_t size);
+void _UnmapStream(StreamBuffer* stream, void* staging, size_t size);
+ProgramLocations* _GetProgram(Mln::Shader shader);
+void _GetLayoutLocations(const ProgramLocations* program, const VertexLayout& layout, GLint* locations);
+void _BakeVertexArrays(ProgramLocations* program);
+void _SetAttributes(const VertexLayout& layout, const GLint* locations, size_t base, GLuint divisor);
+void _SetAttributePointers(const VertexLayout& layout, const GLint* locations, size_t base);
+void _SetQuadAttributes();
+void _SetInstanceAttributes(unsigned int first_instance);
+StreamMode _ChooseStreamMode();
+bool _HasExtension(const char* name);
+void _WaitForFence(GLsync* fence);
+void _ReserveSegment(unsigned int vertex_count, unsigned int instance_count);
+void _FlushSegment(int* next_command, unsigned int* next_offset);
+void _PlanSegment(int command, unsigned int offset, int* end_command, unsigned int* end_offset, unsigned int* vertex_total, unsigned int* instance_total);
+void* _GrowArray(void* items, size_t* capacity, size_t needed, size_t item_size);
+DrawCommand* _GetCommand(BatchKind kind);
+int _CompareCommands(const void* a, const void* b);
+int _GetTextureSlot(Batch* batch, const DrawCommand* command);
+FlushCause _GetBatchBreakCause(const Batch* batch, const DrawCommand* command);
+bool _IsOutsideClipSpace(Mln::Vector2 min, Mln::Vector2 max);
+int _FindOrAddSlot(Mln::Texture* textures, int* texture_count, Mln::Texture texture);
+QuadVertex* _ReserveStaticQuads(int count);
+bool _IsGeometryPending(int geometry_index);
+void _DrawStaticGeometry(const Batch* batch);
+void _SetProgramUniforms(ProgramLocations* program, const Mln::Matrix& view_projection, Mln::Color tint);
 
 void InitQuadRenderer()
 {
+    state.stream_mode = _ChooseStreamMode();
+#if defined(PLATFORM_WEB)
+    state.instancing = false;
+#else
+    state.instancing = glDrawElementsInstanced && glVertexAttribDivisor && glGenVertexArrays;
+#endif
+    state.vertex_arrays = glGenVertexArrays && glBindVertexArray && glDeleteVertexArrays;
+    state.active_view_projection = HMM_M4D(1.0f);
+
+    GLint texture_units = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &texture_units);
+    state.texture_slots = HMM_MIN(texture_units, MaxTextureSlots);
+    ASSERT(state.texture_slots > 0, "No texture units available");
+
+    state.vertices = (Vertex*)_GrowArray(nullptr, &state.vertex_capacity, MaxVertices, sizeof(Vertex));
+    state.instances = (QuadInstance*)_GrowArray(nullptr, &state.instance_capacity, MaxInstances, sizeof(QuadInstance));
+    state.commands = (DrawCommand*)_GrowArray(nullptr, &state.command_capacity, InitialCommands, sizeof(DrawCommand));
+
     _CreateBuffers();
 }
 
 void ShutdownQuadRenderer()
 {
-    if (glDeleteVertexArrays)
+    for (int i = 0; i < StreamFrames; i++)
+    {
+        if (state.frame_fences[i])
+        {
+            glDeleteSync(state.frame_fences[i]);
+            state.frame_fences[i] = 0;
+        }
+    }
+
+    for (int i = 0; i < MaxStaticGeometries; i++)
     {
-        glDeleteVertexArrays(1, &state.vao);
+        if (state.static_geometries[i].used)
+        {
+            DestroyStaticGeometry(i);
+        }
     }
-    glDeleteBuffers(1, &state.vbo);
+
+    _DeleteStreamBuffer(&state.vertex_stream);
+    _DeleteStreamBuffer(&state.instance_stream);
+
+    if (state.vertex_arrays)
+    {
+        for (int i = 0; i < state.program_count; i++)
+        {
+            ProgramLocations* program = &state.programs[i];
+            ForgetVertexArray(program->quad_vao);
+            ForgetVertexArray(program->instance_vao);
+            glDeleteVertexArrays(1, &program->quad_vao);
+            glDeleteVertexArrays(1, &program->instance_vao);
+        }
+        ForgetVertexArray(state.setup_vao);
+        glDeleteVertexArrays(1, &state.setup_vao);
+    }
+    state.program_count = 0;
+
+    ForgetBuffer(state.corner_vbo);
+    ForgetBuffer(state.ebo);
+    glDeleteBuffers(1, &state.corner_vbo);
     glDeleteBuffers(1, &state.ebo);
+
+    free(state.vertices);
+    free(state.instances);
+    free(state.commands);
+    state.vertices = nullptr;
+    state.instances = nullptr;
+    state.commands = nullptr;
+    state.vertex_capacity = 0;
+    state.instance_capacity = 0;
+    state.command_capacity = 0;
 }
 
-void SetShader(Mln::Shader shader)
+void RegisterShader(Mln::Shader shader)
 {
-    if (state.active_shader.id == shader.id)
+    if (_GetProgram(shader))
     {
         return;
     }
 
-    DrawBatch();
+    ASSERT(state.program_count < MaxPrograms, "Too many shaders registered with the quad renderer");
+    ProgramLocations* program = &state.programs[state.program_count++];
+    program->shader = shader;
+
+    _GetLayoutLocations(program, QuadLayout, program->quad_locations);
+    _GetLayoutLocations(program, InstanceLayout, program->instance_locations);
+    _GetLayoutLocations(program, CornerLayout, program->corner_locations);
+
+    GET_UNIFORM_LOCATION(program, uTextures);
+    GET_UNIFORM_LOCATION(program, uViewProjection);
+    GET_UNIFORM_LOCATION(program, uTint);
+
+    // Samplers are program state, every program reads slot i from texture unit i
+    BindProgram(GetProgramName(shader.id));
+    glUniform1iv(program->uTextures, MaxTextureSlots, TextureUnits);
+
+    // Uniforms start out as zero, upload the values streamed quads expect
+    Mln::Matrix identity = HMM_M4D(1.0f);
+    program->view_projection = identity;
+    program->tint = Mln::Color{1.f, 1.f, 1.f, 1.f};
+    glUniformMatrix4fv(program->uViewProjection, 1, GL_FALSE, &identity.Elements[0][0]);
+    glUniform4f(program->uTint, 1.f, 1.f, 1.f, 1.f);
+
+    _BakeVertexArrays(program);
+}
+
+void SetShader(Mln::Shader shader)
+{
     state.active_shader = shader;
-    _GetLocations();
 }
 
 void SetTexture(Mln::Texture texture)
 {
-    if (state.active_texture.id == texture.id)
+    state.active_texture = texture;
+}
+
+void SetViewProjection(Mln::Matrix view_projection)
+{
+    state.active_view_projection = view_projection;
+}
+
+void SetLayer(int layer)
+{
+    ASSERT(layer >= 0 && layer < 256, "Draw layers must fit in 8 bits");
+    state.active_layer = layer;
+}
+
+void SetAdditive(float additive)
+{
+    state.active_additive = HMM_Clamp(0.f, additive, 1.f);
+}
+
+bool SupportsInstancing()
+{
+    return state.instancing;
+}
+
+QuadVertex* ReserveQuads(int count)
+{
+    ASSERT(count > 0 && (size_t)count <= MaxQuads, "Quad reservation does not fit in a batch");
+
+    if (state.recording)
+    {
+        return _ReserveStaticQuads(count);
+    }
+
+    if (state.vertex_count + 4 * count > state.vertex_capacity)
+    {
+        state.vertices = (Vertex*)_GrowArray(state.vertices, &state.vertex_capacity, state.vertex_count + 4 * count, sizeof(Vertex));
+    }
+
+    DrawCommand* command = _GetCommand(BATCH_QUADS);
+
+    Vertex* vertices = state.vertices + state.vertex_count;
+    state.vertex_count += 4 * count;
+    command->count += 4 * count;
+    state.stats.quads += count;
+    return vertices;
+}
+
+void WriteQuad(QuadVertex* vertices, const Mln::Vector2 positions[4], const Mln::Vector2 uvs[4], Mln::Color color, QuadMode mode)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        #if defined(QUAD_RENDERER_COMPACT_VERTICES) && defined(QUAD_RENDERER_HALF_POSITIONS)
+        vertices[i].position[0] = PackHalf(positions[i].X);
+        vertices[i].position[1] = PackHalf(positions[i].Y);
+        #else
+        vertices[i].position = positions[i];
+        #endif
+    }
+    WriteQuadAttributes(vertices, uvs, color, mode);
+}
+
+void WriteQuadAttributes(QuadVertex* vertices, const Mln::Vector2 uvs[4], Mln::Color color, QuadMode mode)
+{
+#if defined(QUAD_RENDERER_COMPACT_VERTICES)
+    uint32_t packed_color = PackColor(color);
+    uint8_t packed_additive = (uint8_t)(state.active_additive * 255.f + 0.5f);
+    for (int i = 0; i < 4; i++)
+    {
+        vertices[i].uv[0] = PackUnorm16(uvs[i].X);
+        vertices[i].uv[1] = PackUnorm16(uvs[i].Y);
+        vertices[i].color = packed_color;
+        vertices[i].mode = mode;
+        vertices[i].additive = packed_additive;
+    }
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        vertices[i].uv = uvs[i];
+        vertices[i].color = color;
+        vertices[i].mode = mode;
+        vertices[i].additive = state.active_additive;
+    }
+#endif
+}
+
+void PushQuad(const Quad& quad)
+{
+    if (CullQuad(quad.vertices))
     {
         return;
     }
+    WriteQuad(ReserveQuads(1), quad.vertices, quad.uvs, quad.color, quad.mode);
+}
 
-    DrawBatch();
-    state.active_texture = texture;
+bool CullQuad(const Mln::Vector2 positions[4])
+{
+    Mln::Vector2 min = positions[0];
+    Mln::Vector2 max = positions[0];
+    for (int i = 1; i < 4; i++)
+    {
+        min.X = fminf(min.X, positions[i].X);
+        min.Y = fminf(min.Y, positions[i].Y);
+        max.X = fmaxf(max.X, positions[i].X);
+        max.Y = fmaxf(max.Y, positions[i].Y);
+    }
+
+    // Recorded positions are in world space, they only grow the bounds the whole geometry is culled with
+    if (state.recording)
+    {
+        state.recording->bounds_min.X = fminf(state.recording->bounds_min.X, min.X);
+        state.recording->bounds_min.Y = fminf(state.recording->bounds_min.Y, min.Y);
+        state.recording->bounds_max.X = fmaxf(state.recording->bounds_max.X, max.X);
+        state.recording->bounds_max.Y = fmaxf(state.recording->bounds_max.Y, max.Y);
+        return false;
+    }
+
+    if (_IsOutsideClipSpace(min, max))
+    {
+        state.stats.quads_culled++;
+        return true;
+    }
+    return false;
 }
 
-void PushQuad(Quad quad)
+void ReleaseQuads(int count)
 {
-    if (state.vertex_count + 4 >= MaxQuads)
+    if (count == 0)
     {
-        DrawBatch();
+        return;
     }
 
-    Vertex* vertices = state.vertices + state.vertex_count;
-    vertices[0].position = quad.vertices[0];
-    vertices[1].position = quad.vertices[1];
-    vertices[2].position = quad.vertices[2];
-    vertices[3].position = quad.vertices[3];
+    ASSERT(!state.recording, "Recorded quads can not be released");
+    ASSERT(state.command_count > 0 && state.commands[state.command_count - 1].kind == BATCH_QUADS, "ReleaseQuads without ReserveQuads");
+    DrawCommand* command = &state.commands[state.command_count - 1];
+    ASSERT((unsigned int)(4 * count) <= command->count, "Released more quads than were reserved");
 
-    vertices[0].uv = quad.uvs[0];
-    vertices[1].uv = quad.uvs[1];
-    vertices[2].uv = quad.uvs[2];
-    vertices[3].uv = quad.uvs[3];
+    state.vertex_count -= 4 * count;
+    command->count -= 4 * count;
+    state.stats.quads -= count;
+    if (command->count == 0)
+    {
+        state.command_count--;
+    }
+}
 
-    vertices[0].color = quad.color;
-    vertices[1].color = quad.color;
-    vertices[2].color = quad.color;
-    vertices[3].color = quad.color;
+int CreateStaticGeometry()
+{
+    for (int i = 0; i < MaxStaticGeometries; i++)
+    {
+        StaticGeometry* geometry = &state.static_geometries[i];
+        if (!geometry->used)
+        {
+            *geometry = StaticGeometry{};
+            geometry->used = true;
+            geometry->dirty = true;
+            glGenBuffers(1, &geometry->buffer);
+            return i;
+        }
+    }
 
-    state.vertex_count += 4;
+    ASSERT(false, "Too many static geometries");
+    return -1;
 }
 
+void DestroyStaticGeometry(int geometry_index)
+{
+    ASSERT(geometry_index >= 0 && geometry_index < MaxStaticGeometries, "Invalid static geometry");
+    StaticGeometry* geometry = &state.static_geometries[geometry_index];
+    ASSERT(state.recording != geometry, "Static geometry destroyed while it is being recorded");
 
-void DrawBatch()
+    if (_IsGeometryPending(geometry_index))
+    {
+        FlushBatches(FLUSH_CAUSE_EXPLICIT);
+    }
+
+    for (int i = 0; i < MaxPrograms; i++)
+    {
+        if (geometry->vaos[i])
+        {
+            ForgetVertexArray(geometry->vaos[i]);
+            glDeleteVertexArrays(1, &geometry->vaos[i]);
+        }
+    }
+    ForgetBuffer(geometry->buffer);
+    glDeleteBuffers(1, &geometry->buffer);
+    *geometry = StaticGeometry{};
+}
+
+void BeginStaticGeometry(int geometry_index)
+{
+    ASSERT(geometry_index >= 0 && geometry_index < MaxStaticGeometries && state.static_geometries[geometry_index].used, "Invalid static geometry");
+    ASSERT(!state.recording, "Static geometry recordings can not be nested");
+
+    state.recording = &state.static_geometries[geometry_index];
+    state.recording->range_count = 0;
+    state.recording->vertex_count = 0;
+    state.recording->bounds_min = Mln::Vector2{FLT_MAX, FLT_MAX};
+    state.recording->bounds_max = Mln::Vector2{-FLT_MAX, -FLT_MAX};
+}
+
+void EndStaticGeometry()
+{
+    ASSERT(state.recording, "EndStaticGeometry without BeginStaticGeometry");
+    StaticGeometry* geometry = state.recording;
+    state.recording = nullptr;
+
+    // Draws recorded earlier in the frame have to see the old contents
+    if (_IsGeometryPending(geometry - state.static_geometries))
+    {
+        FlushBatches(FLUSH_CAUSE_EXPLICIT);
+    }
+
+    BindBuffer(GL_ARRAY_BUFFER, geometry->buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * geometry->vertex_count, state.record_vertices, GL_STATIC_DRAW);
+    geometry->dirty = false;
+
+    state.stats.vertices_uploaded += geometry->vertex_count;
+    state.stats.bytes_uploaded += sizeof(Vertex) * geometry->vertex_count;
+}
+
+bool IsRecordingStaticGeometry()
 {
-    if (state.vertex_count == 0)
+    return state.recording != nullptr;
+}
+
+void MarkStaticGeometryDirty(int geometry_index)
+{
+    ASSERT(geometry_index >= 0 && geometry_index < MaxStaticGeometries, "Invalid static geometry");
+    state.static_geometries[geometry_index].dirty = true;
+}
+
+bool IsStaticGeometryDirty(int geometry_index)
+{
+    ASSERT(geometry_index >= 0 && geometry_index < MaxStaticGeometries, "Invalid static geometry");
+    return state.static_geometries[geometry_index].dirty;
+}
+
+void DrawStaticGeometry(int geometry_index, Mln::Matrix transform, Mln::Color tint)
+{
+    ASSERT(geometry_index >= 0 && geometry_index < MaxStaticGeometries && state.static_geometries[geometry_index].used, "Invalid static geometry");
+    ASSERT(!state.recording, "Static geometry can not be drawn into a recording");
+    StaticGeometry* geometry = &state.static_geometries[geometry_index];
+    if (geometry->vertex_count == 0)
+    {
+        return;
+    }
+
+    // The transform includes the view projection, so the recorded bounds land in clip space
+    Mln::Vector2 min = Mln::Vector2{FLT_MAX, FLT_MAX};
+    Mln::Vector2 max = Mln::Vector2{-FLT_MAX, -FLT_MAX};
+    for (int i = 0; i < 4; i++)
     {
+        Mln::Vector2 corner = Mln::Vector2{i & 1 ? geometry->bounds_max.X : geometry->bounds_min.X, i & 2 ? geometry->bounds_max.Y : geometry->bounds_min.Y};
+        Mln::Vector2 position = (transform * HMM_Vec4{corner.X, corner.Y, 0, 1}).XY;
+        min = Mln::Vector2{fminf(min.X, position.X), fminf(min.Y, position.Y)};
+        max = Mln::Vector2{fmaxf(max.X, position.X), fmaxf(max.Y, position.Y)};
+    }
+    if (_IsOutsideClipSpace(min, max))
+    {
+        state.stats.quads_culled += geometry->vertex_count / 4;
         return;
     }
 
-    glUseProgram(state.active_shader.id);
-    glUniform1i(state.uTexture, 0);
+    if ((size_t)state.command_count == state.command_capacity)
+    {
+        state.commands = (DrawCommand*)_GrowArray(state.commands, &state.command_capacity, state.command_count + 1, sizeof(DrawCommand));
+    }
+
+    DrawCommand* command = &state.commands[state.command_count];
+    uint64_t order = (uint64_t)state.command_count;
+    state.command_count++;
+
+    command->kind = BATCH_STATIC;
+    command->shader = geometry->ranges[0].shader;
+    command->key = ((uint64_t)state.active_layer << 56) | ((uint64_t)(command->shader.id & 0xFFF) << 44) | order;
+    command->texture = Mln::Texture{Mln::InvalidID, 0, 0};
+    command->view_projection = transform;
+    command->tint = tint;
+    command->first = geometry_index;
+    command->count = 0;
+    state.stats.quads += geometry->vertex_count / 4;
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, state.active_texture.id);
+void PushInstance(const QuadInstance& instance)
+{
+    ASSERT(state.instancing, "Instanced quads are not supported by this context");
 
+    // The quad never reaches further from its position than its diagonal, whatever the pivot and rotation
+    const float (*m)[4] = state.active_view_projection.Elements;
+    float radius = sqrtf(instance.size.X * instance.size.X + instance.size.Y * instance.size.Y);
+    float center_x = m[0][0] * instance.position.X + m[1][0] * instance.position.Y + m[3][0];
+    float center_y = m[0][1] * instance.position.X + m[1][1] * instance.position.Y + m[3][1];
+    float extent_x = radius * sqrtf(m[0][0] * m[0][0] + m[1][0] * m[1][0]);
+    float extent_y = radius * sqrtf(m[0][1] * m[0][1] + m[1][1] * m[1][1]);
+    if (_IsOutsideClipSpace(Mln::Vector2{center_x - extent_x, center_y - extent_y}, Mln::Vector2{center_x + extent_x, center_y + extent_y}))
+    {
+        state.stats.quads_culled++;
+        return;
+    }
 
-    if (glBindVertexArray)
+    if (state.instance_count + 1 > state.instance_capacity)
     {
-        glBindVertexArray(state.vao);
+        state.instances = (QuadInstance*)_GrowArray(state.instances, &state.instance_capacity, state.instance_count + 1, sizeof(QuadInstance));
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * state.vertex_count, state.vertices);
+    DrawCommand* command = _GetCommand(BATCH_INSTANCES);
+
+    state.instances[state.instance_count] = instance;
+    state.instances[state.instance_count].additive = (uint8_t)(state.active_additive * 255.f + 0.5f);
+
+    state.instance_count += 1;
+    command->count += 1;
+    state.stats.quads += 1;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
 
-    glVertexAttribPointer(state.aPos, sizeof(Vertex::position) / sizeof(float), GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-    glEnableVertexAttribArray(state.aPos);
+void FlushBatches(FlushCause cause)
+{
+    if (state.command_count == 0)
+    {
+        return;
+    }
 
-    glVertexAttribPointer(state.aColor, sizeof(Vertex::color) / sizeof(float), GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
-    glEnableVertexAttribArray(state.aColor);
+    state.stats.vertices_uploaded += state.vertex_count + 4 * state.instance_count;
+    state.stats.bytes_uploaded += sizeof(Vertex) * state.vertex_count + sizeof(QuadInstance) * state.instance_count;
 
-    glVertexAttribPointer(state.aTexCoord, sizeof(Vertex::uv) / sizeof(float), GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
-    glEnableVertexAttribArray(state.aTexCoord);
+    // The submission order is part of the key so no two keys are equal and the sort is stable
+    qsort(state.commands, state.command_count, sizeof(DrawCommand), _CompareCommands);
 
-    glDrawElements(GL_TRIANGLES, 6 * (state.vertex_count / 4), GL_UNSIGNED_INT, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Everything recorded is sorted once and then drawn a stream segment at a time. A full segment only ends the
+    // draw calls so far, the next one carries on in sorted order so lower layers are still drawn first
+    int command = 0;
+    unsigned int offset = 0;
+    while (command < state.command_count)
+    {
+        _FlushSegment(&command, &offset);
+        if (command < state.command_count)
+        {
+            state.stats.flushes[FLUSH_CAUSE_CAPACITY]++;
+        }
+    }
+    // The last batch is the one the flush itself cut off
+    state.stats.flushes[cause]++;
 
     state.vertex_count = 0;
+    state.instance_count = 0;
+    state.command_count = 0;
+    state.batch_count = 0;
+}
+
+// Uploads and draws the sorted commands from next_command on, skipping the next_offset vertices or instances of it
+// that an earlier segment drew, and moves both past what fit into this segment
+void _FlushSegment(int* next_command, unsigned int* next_offset)
+{
+    int end_command = 0;
+    unsigned int end_offset = 0;
+    unsigned int vertex_total = 0;
+    unsigned int instance_total = 0;
+    _PlanSegment(*next_command, *next_offset, &end_command, &end_offset, &vertex_total, &instance_total);
+
+    if (state.stream_mode != STREAM_MODE_ORPHAN)
+    {
+        _ReserveSegment(vertex_total, instance_total);
+    }
+
+    Vertex* vertex_dst = nullptr;
+    QuadInstance* instance_dst = nullptr;
+    if (vertex_total > 0)
+    {
+        BindBuffer(GL_ARRAY_BUFFER, state.vertex_stream.buffer);
+        vertex_dst = (Vertex*)_MapStream(&state.vertex_stream, state.upload_vertices, sizeof(Vertex) * state.segment_first_vertex, sizeof(Vertex) * vertex_total);
+    }
+    if (instance_total > 0)
+    {
+        BindBuffer(GL_ARRAY_BUFFER, state.instance_stream.buffer);
+        instance_dst = (QuadInstance*)_MapStream(&state.instance_stream, state.upload_instances, sizeof(QuadInstance) * state.segment_first_instance, sizeof(QuadInstance) * instance_total);
+    }
+
+    // Write the recorded data out in sorted order and coalesce neighbouring commands into one batch
+    // until they need a different shader or the batch runs out of texture slots
+    unsigned int vertex_cursor = 0;
+    unsigned int instance_cursor = 0;
+    state.batch_count = 0;
+    int last_command = end_offset > 0 ? end_command : end_command - 1;
+    for (int i = *next_command; i <= last_command; i++)
+    {
+        DrawCommand* command = &state.commands[i];
+        unsigned int first = i == *next_command ? *next_offset : 0;
+        unsigned int count = (i == end_command ? end_offset : command->count) - first;
+
+        if (command->kind == BATCH_STATIC)
+        {
+            if (state.batch_count > 0)
+            {
+                state.stats.flushes[FLUSH_CAUSE_STATE]++;
+            }
+            Batch* batch = &state.batches[state.batch_count++];
+            batch->kind = BATCH_STATIC;
+            batch->shader = command->shader;
+            batch->texture_count = 0;
+            batch->view_projection = command->view_projection;
+            batch->tint = command->tint;
+            batch->first = command->first;
+            batch->count = 0;
+            continue;
+        }
+
+        Batch* batch = state.batch_count > 0 ? &state.batches[state.batch_count - 1] : nullptr;
+        int slot = batch ? _GetTextureSlot(batch, command) : -1;
+        if (slot < 0)
+        {
+            if (batch)
+            {
+                state.stats.flushes[_GetBatchBreakCause(batch, command)]++;
+            }
+            batch = &state.batches[state.batch_count++];
+            batch->kind = command->kind;
+            batch->shader = command->shader;
+            batch->texture_count = 0;
+            batch->view_projection = command->view_projection;
+            batch->tint = Mln::Color{1.f, 1.f, 1.f, 1.f};
+            batch->first = command->kind == BATCH_QUADS ? vertex_cursor : instance_cursor;
+            batch->count = 0;
+            slot = _GetTextureSlot(batch, command);
+        }
+
+        if (command->kind == BATCH_QUADS)
+        {
+            if (vertex_dst)
+            {
+                Vertex* dst = vertex_dst + vertex_cursor;
+                memcpy(dst, state.vertices + command->first + first, sizeof(Vertex) * count);
+                for (unsigned int v = 0; v < count; v++)
+                {
+                    dst[v].texture_slot = slot;
+                }
+            }
+            vertex_cursor += count;
+        }
+        else
+        {
+            if (instance_dst)
+            {
+                QuadInstance* dst = instance_dst + instance_cursor;
+                memcpy(dst, state.instances + command->first + first, sizeof(QuadInstance) * count);
+                for (unsigned int v = 0; v < count; v++)
+                {
+                    dst[v].texture_slot = slot;
+                }
+            }
+            instance_cursor += count;
+        }
+
+        batch->count += count;
+    }
+
+    if (vertex_total > 0)
+    {
+        BindBuffer(GL_ARRAY_BUFFER, state.vertex_stream.buffer);
+        _UnmapStream(&state.vertex_stream, state.upload_vertices, sizeof(Vertex) * vertex_total);
+    }
+    if (instance_total > 0)
+    {
+        BindBuffer(GL_ARRAY_BUFFER, state.instance_stream.buffer);
+        _UnmapStream(&state.instance_stream, state.upload_instances, sizeof(QuadInstance) * instance_total);
+    }
+
+    // Every batch here lives in the same segment, the segment offset is applied as a base vertex
+    // and the batch offset through the index buffer so the attribute pointers never have to move
+    GLint base_vertex = (GLint)state.segment_first_vertex;
+
+    Mln::Matrix identity = HMM_M4D(1.0f);
+    state.bound_program = nullptr;
+    BatchKind bound_kind = BATCH_QUADS;
+    for (int i = 0; i < state.batch_count; i++)
+    {
+        Batch* batch = &state.batches[i];
+
+        if (batch->kind == BATCH_STATIC)
+        {
+            _DrawStaticGeometry(batch);
+            // Static geometry binds its own programs and vertex arrays
+            state.bound_program = nullptr;
+            bound_kind = BATCH_STATIC;
+            continue;
+        }
+
+        if (!state.bound_program || batch->shader.id != state.bound_program->shader.id || batch->kind != bound_kind)
+        {
+            state.bound_program = _GetProgram(batch->shader);
+            if (!state.bound_program)
+            {
+                RegisterShader(batch->shader);
+                state.bound_program = _GetProgram(batch->shader);
+            }
+            bound_kind = batch->kind;
+
+            BindProgram(GetProgramName(batch->shader.id));
+            if (batch->kind == BATCH_QUADS)
+            {
+                _SetQuadAttributes();
+            }
+            else
+            {
+                BindVertexArray(state.bound_program->instance_vao);
+            }
+        }
+
+        for (int slot = 0; slot < batch->texture_count; slot++)
+        {
+            BindTexture2D(slot, GetTextureName(batch->textures[slot].id));
+        }
+
+        if (batch->kind == BATCH_QUADS)
+        {
+            _SetProgramUniforms(state.bound_program, identity, batch->tint);
+
+            GLsizei index_count = 6 * (batch->count / 4);
+            void* index_offset = (void*)(sizeof(*state.indices) * 6 * (batch->first / 4));
+            if (state.stream_mode == STREAM_MODE_ORPHAN)
+            {
+                glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, index_offset);
+            }
+            else
+            {
+                glDrawElementsBaseVertex(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, index_offset, base_vertex);
+            }
+            state.stats.draw_calls++;
+        }
+        else
+        {
+            // There is no base instance before GL 4.2 so the per instance pointers are moved instead
+            _SetInstanceAttributes(batch->first);
+            _SetProgramUniforms(state.bound_program, batch->view_projection, batch->tint);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, batch->count);
+            state.stats.draw_calls++;
+        }
+    }
+
+    *next_command = end_command;
+    *next_offset = end_offset;
+}
+
+// Finds how much of the sorted commands fits into one segment from command and offset on. The segment ends before
+// the end_offset vertex or instance of end_command, an end_offset of 0 ends it before the whole command
+void _PlanSegment(int command, unsigned int offset, int* end_command, unsigned int* end_offset, unsigned int* vertex_total, unsigned int* instance_total)
+{
+    // Each command adds a batch at most
+    int last = HMM_MIN(state.command_count, command + MaxBatches);
+    for (; command < last; command++, offset = 0)
+    {
+        const DrawCommand* recorded = &state.commands[command];
+        bool instances = recorded->kind == BATCH_INSTANCES;
+        unsigned int* total = instances ? instance_total : vertex_total;
+        unsigned int space = (instances ? MaxInstances : MaxVertices) - *total;
+        unsigned int remaining = recorded->count - offset;
+        if (remaining > space)
+        {
+            // Quad commands always have room for whole quads, the segment and every command are multiples of 4
+            *total += space;
+            *end_command = command;
+            *end_offset = offset + space;
+            return;
+        }
+        *total += remaining;
+    }
+    *end_command = command;
+    *end_offset = 0;
+}
+
+RenderStats EndQuadRendererFrame()
+{
+    // One fence covers everything the frame streamed, the region is written again StreamFrames frames later
+    if (state.stream_frame_started)
+    {
+        state.frame_fences[state.stream_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        state.stream_frame = (state.stream_frame + 1) % StreamFrames;
+        state.stream_frame_started = false;
+        state.frame_vertex_cursor = 0;
+        state.frame_instance_cursor = 0;
+    }
+
+    RenderStats stats = state.stats;
+    state.stats = RenderStats{};
+    return stats;
+}
+
+
+DrawCommand* _GetCommand(BatchKind kind)
+{
+    DrawCommand* command = state.command_count > 0 ? &state.commands[state.command_count - 1] : nullptr;
+    if (command && command->kind == kind && command->shader.id == state.active_shader.id && command->texture.id == state.active_texture.id
+        && (command->key >> 56) == (uint64_t)state.active_layer
+        && (kind != BATCH_INSTANCES || memcmp(&command->view_projection, &state.active_view_projection, sizeof(Mln::Matrix)) == 0))
+    {
+        return command;
+    }
+
+    if ((size_t)state.command_count == state.command_capacity)
+    {
+        state.commands = (DrawCommand*)_GrowArray(state.commands, &state.command_capacity, state.command_count + 1, sizeof(DrawCommand));
+    }
+
+    uint64_t order = (uint64_t)state.command_count;
+
+    command = &state.commands[state.command_count++];
+    command->key = ((uint64_t)state.active_layer << 56) | ((uint64_t)(state.active_shader.id & 0xFFF) << 44) | order;
+    command->kind = kind;
+    command->shader = state.active_shader;
+    command->texture = state.active_texture;
+    command->view_projection = state.active_view_projection;
+    command->first = kind == BATCH_QUADS ? state.vertex_count : state.instance_count;
+    command->count = 0;
+    return command;
+}
+
+// Doubles the capacity until needed items fit, pointers into the old array are invalid afterwards
+void* _GrowArray(void* items, size_t* capacity, size_t needed, size_t item_size)
+{
+    size_t grown = *capacity > 0 ? *capacity : 1;
+    while (grown < needed)
+    {
+        grown *= 2;
+    }
+    items = realloc(items, grown * item_size);
+    ASSERT(items, "Out of memory for recorded draws");
+    *capacity = grown;
+    return items;
+}
+
+int _CompareCommands(const void* a, const void* b)
+{
+    uint64_t key_a = ((const DrawCommand*)a)->key;
+    uint64_t key_b = ((const DrawCommand*)b)->key;
+    return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+// Clip space covers exactly the viewport or render target that is drawn to
+bool _IsOutsideClipSpace(Mln::Vector2 min, Mln::Vector2 max)
+{
+    return max.X < -1.f || min.X > 1.f || max.Y < -1.f || min.Y > 1.f;
+}
+
+FlushCause _GetBatchBreakCause(const Batch* batch, const DrawCommand* command)
+{
+    if (batch->kind != command->kind)
+    {
+        return FLUSH_CAUSE_STATE;
+    }
+    if (batch->shader.id != command->shader.id)
+    {
+        return FLUSH_CAUSE_SHADER;
+    }
+    if (batch->kind == BATCH_INSTANCES && memcmp(&batch->view_projection, &command->view_projection, sizeof(Mln::Matrix)) != 0)
+    {
+        return FLUSH_CAUSE_STATE;
+    }
+    return FLUSH_CAUSE_TEXTURE;
+}
+
+int _GetTextureSlot(Batch* batch, const DrawCommand* command)
+{
+    // Ids are truncated in the key so the full state is compared here
+    if (batch->kind != command->kind || batch->shader.id != command->shader.id
+        || (batch->kind == BATCH_INSTANCES && memcmp(&batch->view_projection, &command->view_projection, sizeof(Mln::Matrix)) != 0))
+    {
+        return -1;
+    }
+
+    return _FindOrAddSlot(batch->textures, &batch->texture_count, command->texture);
+}
+
+int _FindOrAddSlot(Mln::Texture* textures, int* texture_count, Mln::Texture texture)
+{
+    for (int slot = 0; slot < *texture_count; slot++)
+    {
+        if (textures[slot].id == texture.id)
+        {
+            return slot;
+        }
+    }
+
+    if (*texture_count == state.texture_slots)
+    {
+        return -1;
+    }
+
+    textures[*texture_count] = texture;
+    return (*texture_count)++;
+}
+
+QuadVertex* _ReserveStaticQuads(int count)
+{
+    StaticGeometry* geometry = state.recording;
+    ASSERT(geometry->vertex_count + 4 * count <= MaxVertices, "Static geometry is full");
+
+    StaticRange* range = geometry->range_count > 0 ? &geometry->ranges[geometry->range_count - 1] : nullptr;
+    int slot = -1;
+    if (range && range->shader.id == state.active_shader.id)
+    {
+        slot = _FindOrAddSlot(range->textures, &range->texture_count, state.active_texture);
+    }
+    if (slot < 0)
+    {
+        ASSERT(geometry->range_count < MaxStaticRanges, "Static geometry has too many ranges");
+        range = &geometry->ranges[geometry->range_count++];
+        range->shader = state.active_shader;
+        range->texture_count = 0;
+        range->first = geometry->vertex_count;
+        range->count = 0;
+        slot = _FindOrAddSlot(range->textures, &range->texture_count, state.active_texture);
+    }
+
+    // Slots are final once recorded, WriteQuad leaves them alone
+    Vertex* vertices = state.record_vertices + geometry->vertex_count;
+    for (int i = 0; i < 4 * count; i++)
+    {
+        vertices[i].texture_slot = slot;
+    }
+
+    geometry->vertex_count += 4 * count;
+    range->count += 4 * count;
+    return vertices;
+}
+
+bool _IsGeometryPending(int geometry_index)
+{
+    for (int i = 0; i < state.command_count; i++)
+    {
+        if (state.commands[i].kind == BATCH_STATIC && state.commands[i].first == (unsigned int)geometry_index)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void _DrawStaticGeometry(const Batch* batch)
+{
+    StaticGeometry* geometry = &state.static_geometries[batch->first];
+
+    for (int i = 0; i < geometry->range_count; i++)
+    {
+        StaticRange* range = &geometry->ranges[i];
+
+        ProgramLocations* program = _GetProgram(range->shader);
+        if (!program)
+        {
+            RegisterShader(range->shader);
+            program = _GetProgram(range->shader);
+        }
+        BindProgram(GetProgramName(range->shader.id));
+        _SetProgramUniforms(program, batch->view_projection, batch->tint);
+
+        if (state.vertex_arrays)
+        {
+            GLuint* vao = &geometry->vaos[program - state.programs];
+            if (*vao == 0)
+            {
+                glGenVertexArrays(1, vao);
+                BindVertexArray(*vao);
+                BindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
+                BindBuffer(GL_ARRAY_BUFFER, geometry->buffer);
+                _SetAttributes(QuadLayout, program->quad_locations, 0, 0);
+            }
+            BindVertexArray(*vao);
+        }
+        else
+        {
+            BindBuffer(GL_ARRAY_BUFFER, geometry->buffer);
+            BindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
+            _SetAttributes(QuadLayout, program->quad_locations, 0, 0);
+        }
+
+        for (int slot = 0; slot < range->texture_count; slot++)
+        {
+            BindTexture2D(slot, GetTextureName(range->textures[slot].id));
+        }
+
+        GLsizei index_count = 6 * (range->count / 4);
+        void* index_offset = (void*)(sizeof(*state.indices) * 6 * (range->first / 4));
+        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, index_offset);
+        state.stats.draw_calls++;
+    }
+}
+
+void _SetProgramUniforms(ProgramLocations* program, const Mln::Matrix& view_projection, Mln::Color tint)
+{
+    if (memcmp(&program->view_projection, &view_projection, sizeof(Mln::Matrix)) != 0)
+    {
+        program->view_projection = view_projection;
+        glUniformMatrix4fv(program->uViewProjection, 1, GL_FALSE, &view_projection.Elements[0][0]);
+    }
+    if (memcmp(&program->tint, &tint, sizeof(Mln::Color)) != 0)
+    {
+        program->tint = tint;
+        glUniform4f(program->uTint, tint.R, tint.G, tint.B, tint.A);
+    }
+}
+
+void _BakeVertexArrays(ProgramLocations* program)
+{
+    if (!state.vertex_arrays)
+    {
+        return;
+    }
+    ASSERT(state.vertex_stream.buffer, "InitQuadRenderer has to run before shaders are registered");
+
+    // Quads are addressed through the base vertex and the index offset so their pointers never move
+    glGenVertexArrays(1, &program->quad_vao);
+    BindVertexArray(program->quad_vao);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
+    BindBuffer(GL_ARRAY_BUFFER, state.vertex_stream.buffer);
+    _SetAttributes(QuadLayout, program->quad_locations, 0, 0);
+
+    if (state.instancing)
+    {
+        glGenVertexArrays(1, &program->instance_vao);
+        BindVertexArray(program->instance_vao);
+        BindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
+        BindBuffer(GL_ARRAY_BUFFER, state.corner_vbo);
+        _SetAttributes(CornerLayout, program->corner_locations, 0, 0);
+        BindBuffer(GL_ARRAY_BUFFER, state.instance_stream.buffer);
+        _SetAttributes(InstanceLayout, program->instance_locations, 0, 1);
+    }
+}
+
+void _SetQuadAttributes()
+{
+    if (state.vertex_arrays)
+    {
+        BindVertexArray(state.bound_program->quad_vao);
+        return;
+    }
+
+    // Without vertex arrays the attribute setup is global and has to be redone for every program
+    BindBuffer(GL_ARRAY_BUFFER, state.vertex_stream.buffer);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
+    _SetAttributes(QuadLayout, state.bound_program->quad_locations, 0, 0);
+}
+
+void _SetInstanceAttributes(unsigned int first_instance)
+{
+    size_t base = sizeof(QuadInstance) * (state.segment_first_instance + first_instance);
+
+    // Enables and divisors are baked into the vertex array, only the pointers follow the batch
+    BindBuffer(GL_ARRAY_BUFFER, state.instance_stream.buffer);
+    _SetAttributePointers(InstanceLayout, state.bound_program->instance_locations, base);
+}
+
+void _SetAttributes(const VertexLayout& layout, const GLint* locations, size_t base, GLuint divisor)
+{
+    _SetAttributePointers(layout, locations, base);
+    for (int i = 0; i < layout.attribute_count; i++)
+    {
+        if (locations[i] < 0)
+        {
+            continue;
+        }
+
+        glEnableVertexAttribArray(locations[i]);
+        if (divisor)
+        {
+            glVertexAttribDivisor(locations[i], divisor);
+        }
+    }
+}
+
+void _SetAttributePointers(const VertexLayout& layout, const GLint* locations, size_t base)
+{
+    for (int i = 0; i < layout.attribute_count; i++)
+    {
+        const VertexAttribute& attribute = layout.attributes[i];
+        if (locations[i] < 0)
+        {
+            continue;
+        }
+
+        glVertexAttribPointer(locations[i], attribute.components, attribute.type, attribute.normalized, layout.stride, (void*)(base + attribute.offset));
+    }
+}
+
+
+StreamMode _ChooseStreamMode()
+{
+#if defined(PLATFORM_WEB)
+    // WebGL has no buffer mapping, fences on the client side or base vertex draws
+    return STREAM_MODE_ORPHAN;
+#else
+    #if defined(OPENGL_ES)
+    bool has_ring = GLAD_GL_ES_VERSION_3_2 && glMapBufferRange && glFenceSync;
+    #else
+    bool has_ring = GLAD_GL_VERSION_3_2 && glMapBufferRange && glFenceSync;
+    #endif
+    if (!has_ring || !glDrawElementsBaseVertex)
+    {
+        return STREAM_MODE_ORPHAN;
+    }
+
+    #if defined(OPENGL_ES)
+    if (_HasExtension("GL_EXT_buffer_storage"))
+    #else
+    if (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4) || _HasExtension("GL_ARB_buffer_storage"))
+    #endif
+    {
+        return STREAM_MODE_PERSISTENT;
+    }
+
+    return STREAM_MODE_RING;
+#endif
+}
+
+bool _HasExtension(const char* name)
+{
+    GLint extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+    for (GLint i = 0; i < extension_count; i++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void _WaitForFence(GLsync* fence)
+{
+    if (!*fence)
+    {
+        return;
+    }
+
+    GLenum result = glClientWaitSync(*fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+    {
+        result = glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+    }
+
+    glDeleteSync(*fence);
+    *fence = 0;
+}
+
+// Places the next flush after the earlier ones of this frame in its region of the ring. The first flush of a frame
+// waits for the frame that used the region before, both streams share the fence since they are submitted together
+void _ReserveSegment(unsigned int vertex_count, unsigned int instance_count)
+{
+    if (!state.stream_frame_started)
+    {
+        _WaitForFence(&state.frame_fences[state.stream_frame]);
+        state.stream_frame_started = true;
+    }
+
+    if (state.frame_vertex_cursor + vertex_count > FrameVertices || state.frame_instance_cursor + instance_count > FrameInstances)
+    {
+        // Only a frame streaming more than StreamFrameSegments full segments gets here and stalls once per region
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        _WaitForFence(&fence);
+        state.frame_vertex_cursor = 0;
+        state.frame_instance_cursor = 0;
+    }
+
+    state.segment_first_vertex = state.stream_frame * FrameVertices + state.frame_vertex_cursor;
+    state.segment_first_instance = state.stream_frame * FrameInstances + state.frame_instance_cursor;
+    state.frame_vertex_cursor += vertex_count;
+    state.frame_instance_cursor += instance_count;
+}
+
+unsigned char* _MapStream(StreamBuffer* stream, void* staging, size_t offset, size_t size)
+{
+    // A stream keeps its persistent mapping even if a later buffer had to fall back to ring uploads
+    if (stream->mapped)
+    {
+        return stream->mapped + offset;
+    }
+
+    if (state.stream_mode == STREAM_MODE_ORPHAN)
+    {
+        return (unsigned char*)staging;
+    }
+
+    void* dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    ASSERT(dst, "Failed to map stream ring segment");
+    return (unsigned char*)dst;
 }
 
+void _UnmapStream(StreamBuffer* stream, void* staging, size_t size)
+{
+    if (stream->mapped)
+    {
+        return;
+    }
+
+    if (state.stream_mode == STREAM_MODE_ORPHAN)
+    {
+        glBufferData(GL_ARRAY_BUFFER, stream->segment_size, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, staging);
+    }
+    else
+    {
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+}
 
 
 void _CreateBuffers()
@@ -165,35 +1430,145 @@ void _CreateBuffers()
         state.indices[i * 6 + 5] = i * 4 + 3;
     }
 
-    if (glGenVertexArrays)
+    if (state.vertex_arrays)
     {
-        glGenVertexArrays(1, &state.vao);
+        glGenVertexArrays(1, &state.setup_vao);
+        BindVertexArray(state.setup_vao);
     }
-    glGenBuffers(1, &state.vbo);
+
     glGenBuffers(1, &state.ebo);
-    // bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-    if (glBindVertexArray)
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(*state.indices) * MaxIndices, state.indices, GL_STATIC_DRAW);
+
+    state.vertex_stream.segment_size = sizeof(Vertex) * MaxVertices;
+    _CreateStreamBuffer(&state.vertex_stream);
+
+    if (state.instancing)
     {
-        glBindVertexArray(state.vao);
+        // Corners in the same order as the quad vertices, the first six indices of the quad index buffer are reused
+        Vector2 corners[4] = {{1.f, 0.f}, {1.f, 1.f}, {0.f, 1.f}, {0.f, 0.f}};
+
+        glGenBuffers(1, &state.corner_vbo);
+        BindBuffer(GL_ARRAY_BUFFER, state.corner_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+        state.instance_stream.segment_size = sizeof(QuadInstance) * MaxInstances;
+        _CreateStreamBuffer(&state.instance_stream);
     }
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * MaxVertices, state.vertices, GL_DYNAMIC_DRAW);
+void _CreateStreamBuffer(StreamBuffer* stream)
+{
+    glGenBuffers(1, &stream->buffer);
+    BindBuffer(GL_ARRAY_BUFFER, stream->buffer);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(*state.indices) * MaxIndices, state.indices, GL_STATIC_DRAW);
+    GLsizeiptr buffer_size = stream->segment_size * (state.stream_mode == STREAM_MODE_ORPHAN ? 1 : StreamFrames * StreamFrameSegments);
+    if (state.stream_mode == STREAM_MODE_PERSISTENT)
+    {
+        #if defined(OPENGL_ES)
+        PFN_BufferStorage BufferStorage = (PFN_BufferStorage)((GLADloadproc)Mln::GetProcAddressPtr())("glBufferStorageEXT");
+        #else
+        PFN_BufferStorage BufferStorage = (PFN_BufferStorage)((GLADloadproc)Mln::GetProcAddressPtr())("glBufferStorage");
+        #endif
 
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        if (BufferStorage)
+        {
+            BufferStorage(GL_ARRAY_BUFFER, buffer_size, nullptr, flags);
+            stream->mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, buffer_size, flags);
+        }
 
+        if (!stream->mapped)
+        {
+            // Immutable storage could not be mapped, rebuild the buffer and fall back to ring uploads
+            PrintLog(LOG_WARNING, "Persistent buffer mapping unavailable, falling back to ring streaming\n");
+            ForgetBuffer(stream->buffer);
+            glDeleteBuffers(1, &stream->buffer);
+            glGenBuffers(1, &stream->buffer);
+            BindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+            state.stream_mode = STREAM_MODE_RING;
+        }
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    if (!stream->mapped)
+    {
+        glBufferData(GL_ARRAY_BUFFER, buffer_size, nullptr, GL_DYNAMIC_DRAW);
+    }
 }
 
-void _GetLocations()
+void _DeleteStreamBuffer(StreamBuffer* stream)
 {
-    GET_ATTRIBUTE_LOCATION(aPos);
-    GET_ATTRIBUTE_LOCATION(aColor);
-    GET_ATTRIBUTE_LOCATION(aTexCoord);
+    if (stream->mapped)
+    {
+        BindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        stream->mapped = nullptr;
+    }
+    ForgetBuffer(stream->buffer);
+    glDeleteBuffers(1, &stream->buffer);
+}
 
-    GET_UNIFORM_LOCATION(uTexture);
-}
\ No newline at end of file
+ProgramLocations* _GetProgram(Mln::Shader shader)
+{
+    for (int i = 0; i < state.program_count; i++)
+    {
+        if (state.programs[i].shader.id == shader.id)
+        {
+            return &state.programs[i];
+        }
+    }
+    return nullptr;
+}
+
+void _GetLayoutLocations(const ProgramLocations* program, const VertexLayout& layout, GLint* locations)
+{
+    ASSERT(layout.attribute_count <= MaxLayoutAttributes, "Vertex layout has too many attributes");
+    for (int i = 0; i < layout.attribute_count; i++)
+    {
+        locations[i] = glGetAttribLocation(GetProgramName(program->shader.id), layout.attributes[i].name);
+    }
+}
+
+uint32_t PackColor(Mln::Color color)
+{
+    uint32_t r = (uint32_t)(HMM_Clamp(0.f, color.R, 1.f) * 255.f + 0.5f);
+    uint32_t g = (uint32_t)(HMM_Clamp(0.f, color.G, 1.f) * 255.f + 0.5f);
+    uint32_t b = (uint32_t)(HMM_Clamp(0.f, color.B, 1.f) * 255.f + 0.5f);
+    uint32_t a = (uint32_t)(HMM_Clamp(0.f, color.A, 1.f) * 255.f + 0.5f);
+
+    // Byte order in memory is R, G, B, A
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+uint16_t PackUnorm16(float value)
+{
+    return (uint16_t)(HMM_Clamp(0.f, value, 1.f) * 65535.f + 0.5f);
+}
+
+uint16_t PackHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent <= 0)
+    {
+        // Too small for a normal half, flush to a signed zero
+        return (uint16_t)sign;
+    }
+    if (exponent >= 31)
+    {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    // Round to nearest, a carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+    {
+        half += 1;
+    }
+    return (uint16_t)half;
+}
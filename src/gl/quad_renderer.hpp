@@ -1,22 +1,127 @@
 
-
 #include "melon_types.hpp"
+#include "graphics_api.hpp"
+#include "config.hpp"
+#include <cstdint>
+
+// How the fragment shader combines the sampled texel with the quad color
+enum QuadMode
+{
+    QUAD_MODE_SPRITE,   // Texel tinted by the color
+    QUAD_MODE_TEXT,     // Red channel used as coverage for the color
+    QUAD_MODE_TEXT_SDF, // Red channel is a distance field, the edge at 0.5 is smoothed over about a pixel
+};
 
 struct Quad{
     Mln::Vector2 vertices[4];
     Mln::Vector2 uvs[4];
     Mln::Color color;
+    QuadMode mode;
+};
+
+// Vertex as it is streamed to the GPU, see QUAD_RENDERER_COMPACT_VERTICES in config.hpp
+#pragma pack(push, 1)
+#if defined(QUAD_RENDERER_COMPACT_VERTICES)
+struct QuadVertex{
+    #if defined(QUAD_RENDERER_HALF_POSITIONS)
+    uint16_t position[2];
+    #else
+    Mln::Vector2 position;
+    #endif
+    uint32_t color;
+    uint16_t uv[2];
+    uint8_t texture_slot; // Assigned by the renderer when the batch is built
+    uint8_t mode;
+    uint8_t additive;     // unorm8, see SetAdditive
+    uint8_t padding;
+};
+#if defined(QUAD_RENDERER_HALF_POSITIONS)
+static_assert(sizeof(QuadVertex) == 16, "QuadVertex no longer matches the half position vertex attributes");
+#else
+static_assert(sizeof(QuadVertex) == 20, "QuadVertex no longer matches the compact vertex attributes");
+#endif
+#else
+struct QuadVertex{
+    Mln::Vector2 position;
+    Mln::Color color;
+    Mln::Vector2 uv;
+    float texture_slot; // Assigned by the renderer when the batch is built
+    float mode;
+    float additive;
 };
+static_assert(sizeof(QuadVertex) == 44, "QuadVertex no longer matches the float vertex attributes");
+#endif
+#pragma pack(pop)
+
+// One record per sprite, the instanced vertex shader expands it into a quad on the GPU
+#pragma pack(push, 1)
+struct QuadInstance{
+    Mln::Vector2 position;
+    Mln::Vector2 size;      // World space extent of the quad before rotation
+    float rotation;
+    uint16_t uv_rect[4];    // unorm16 x, y, width, height in texture space
+    uint16_t pivot[2];      // unorm16 point inside the quad that position refers to
+    uint32_t color;         // RGBA8
+    uint8_t texture_slot;   // Assigned by the renderer when the batch is built
+    uint8_t additive;       // Assigned by the renderer from SetAdditive
+    uint8_t padding[2];
+};
+#pragma pack(pop)
 
 void InitQuadRenderer();
 void ShutdownQuadRenderer();
 
+// Caches the attribute and uniform locations of a program so shader switches never query them
+void RegisterShader(Mln::Shader shader);
 void SetShader(Mln::Shader shader);
 void SetTexture(Mln::Texture texture);
+void SetViewProjection(Mln::Matrix view_projection); // Only used by instanced batches
+// 0-255, lower layers are drawn first. Holds for everything recorded between two flushes however much that is,
+// only the explicit flushes (clears, render target and static geometry changes) sort the layers in two runs
+void SetLayer(int layer);
+// Blending is premultiplied, so dropping the output alpha turns a quad additive without leaving the batch.
+// 0 blends normally, 1 adds the color, applies to the quads and instances written after it
+void SetAdditive(float additive);
+
+bool SupportsInstancing();
+
+uint32_t PackColor(Mln::Color color);
+uint16_t PackUnorm16(float value);
+uint16_t PackHalf(float value);
+
+// Returns storage for 4 * count vertices inside the current batch, growing the recording when they do not fit.
+// The pointer is only valid until the next reservation or flush
+QuadVertex* ReserveQuads(int count);
+// Fills the 4 vertices of one quad in place, packing them to the vertex format
+void WriteQuad(QuadVertex* vertices, const Mln::Vector2 positions[4], const Mln::Vector2 uvs[4], Mln::Color color, QuadMode mode);
+// Everything but the positions, for callers that write those in bulk
+void WriteQuadAttributes(QuadVertex* vertices, const Mln::Vector2 uvs[4], Mln::Color color, QuadMode mode);
+void PushQuad(const Quad& quad); // Culled like CullQuad
+void PushInstance(const QuadInstance& instance); // Culled against the bound of its diagonal
+
+// Call with the final positions before reserving a quad: returns true and counts it when it is outside the viewport.
+// Never culls while recording static geometry, the recorded bounds cull the geometry as a whole when it is drawn
+bool CullQuad(const Mln::Vector2 positions[4]);
+// Hands the last count quads of the latest ReserveQuads back, for bulk writers that cull after reserving
+void ReleaseQuads(int count);
 
-void PushQuad(Quad quad);
+// Retained geometry: quads reserved between BeginStaticGeometry and EndStaticGeometry go into a GPU buffer
+// instead of the frame, and DrawStaticGeometry replays all of them with a transform and tint
+int CreateStaticGeometry();
+void DestroyStaticGeometry(int geometry);
+void BeginStaticGeometry(int geometry);
+void EndStaticGeometry();
+bool IsRecordingStaticGeometry();
+void MarkStaticGeometryDirty(int geometry);
+bool IsStaticGeometryDirty(int geometry); // Fresh geometries start out dirty, recording clears it
+void DrawStaticGeometry(int geometry, Mln::Matrix transform, Mln::Color tint);
 
-void DrawBatch();
+// Sorts the commands recorded since the last flush by layer and shader, uploads them and draws neighbouring
+// commands with the same state as a single batch. A recording larger than one stream segment is uploaded and
+// drawn a segment at a time in sorted order, each extra segment counts as a capacity flush
+void FlushBatches(FlushCause cause);
 
+// Returns the counters gathered since the last call and starts over, the GL state counters are not included
+RenderStats EndQuadRendererFrame();
 
 
@@ -0,0 +1,183 @@
+#include "render_targets.hpp"
+#include "core.hpp"
+#include <glad/glad.h>
+#include "gl_state.hpp"
+#include "gl_handles.hpp"
+
+struct RenderTargetSlot{
+    bool allocated; // Owns a framebuffer and texture
+    bool in_use;    // Handed out by AcquireRenderTarget
+    GLuint framebuffer;
+    GLuint texture;
+    Mln::id_t texture_handle;
+    int bucket_width;
+    int bucket_height;
+    uint64_t last_released; // Acquire count at release, the oldest idle slot is recycled first
+};
+
+struct {
+    RenderTargetSlot slots[MAX_RENDER_TARGETS];
+    uint64_t acquire_count;
+} state = {0};
+
+int _GetBucketSize(int size);
+bool _CreateSlot(RenderTargetSlot* slot, int bucket_width, int bucket_height);
+void _DestroySlot(RenderTargetSlot* slot);
+
+void InitRenderTargets()
+{
+    state = {};
+}
+
+void ShutdownRenderTargets()
+{
+    for (int i = 0; i < MAX_RENDER_TARGETS; i++)
+    {
+        _DestroySlot(&state.slots[i]);
+    }
+}
+
+int AcquireRenderTarget(int width, int height)
+{
+    ASSERT(width > 0 && height > 0, "Render target size must be positive");
+    int bucket_width = _GetBucketSize(width);
+    int bucket_height = _GetBucketSize(height);
+    state.acquire_count++;
+
+    // An idle target of the same bucket is reused as is
+    int empty = -1;
+    int oldest_idle = -1;
+    for (int i = 0; i < MAX_RENDER_TARGETS; i++)
+    {
+        RenderTargetSlot* slot = &state.slots[i];
+        if (!slot->allocated)
+        {
+            empty = empty < 0 ? i : empty;
+            continue;
+        }
+        if (slot->in_use)
+        {
+            continue;
+        }
+        if (slot->bucket_width == bucket_width && slot->bucket_height == bucket_height)
+        {
+            slot->in_use = true;
+            return i;
+        }
+        if (oldest_idle < 0 || slot->last_released < state.slots[oldest_idle].last_released)
+        {
+            oldest_idle = i;
+        }
+    }
+
+    // Otherwise a free slot is filled, and when the pool is full the idle target released the longest ago makes room
+    int index = empty;
+    if (index < 0)
+    {
+        index = oldest_idle;
+        if (index < 0)
+        {
+            ASSERT(false, "Too many render targets in use");
+            return -1;
+        }
+        _DestroySlot(&state.slots[index]);
+    }
+
+    if (!_CreateSlot(&state.slots[index], bucket_width, bucket_height))
+    {
+        return -1;
+    }
+    state.slots[index].in_use = true;
+    return index;
+}
+
+void ReleaseRenderTarget(int slot)
+{
+    ASSERT(slot >= 0 && slot < MAX_RENDER_TARGETS && state.slots[slot].in_use, "Invalid render target");
+    state.slots[slot].in_use = false;
+    state.slots[slot].last_released = state.acquire_count;
+}
+
+Mln::Texture GetRenderTargetTexture(int slot)
+{
+    ASSERT(slot >= 0 && slot < MAX_RENDER_TARGETS && state.slots[slot].allocated, "Invalid render target");
+    const RenderTargetSlot* target = &state.slots[slot];
+    return Mln::Texture{target->texture_handle, target->bucket_width, target->bucket_height};
+}
+
+void BindRenderTarget(int slot)
+{
+    if (slot < 0)
+    {
+        BindFramebuffer(0);
+        return;
+    }
+
+    ASSERT(slot < MAX_RENDER_TARGETS && state.slots[slot].in_use, "Invalid render target");
+    BindFramebuffer(state.slots[slot].framebuffer);
+}
+
+
+int _GetBucketSize(int size)
+{
+    int bucket = RenderTargetMinBucket;
+    while (bucket < size)
+    {
+        bucket *= 2;
+    }
+    return bucket;
+}
+
+bool _CreateSlot(RenderTargetSlot* slot, int bucket_width, int bucket_height)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    BindTexture2D(0, texture);
+    // Targets are drawn back like sprites, clamping keeps the unused part of the bucket from bleeding in at the edges
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bucket_width, bucket_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    BindFramebuffer(framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    BindFramebuffer(0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        Mln::PrintLog(LOG_ERROR, "Render target %dx%d is incomplete (0x%x)\n", bucket_width, bucket_height, status);
+        ForgetFramebuffer(framebuffer);
+        glDeleteFramebuffers(1, &framebuffer);
+        ForgetTexture(texture);
+        glDeleteTextures(1, &texture);
+        return false;
+    }
+
+    slot->allocated = true;
+    slot->in_use = false;
+    slot->framebuffer = framebuffer;
+    slot->texture = texture;
+    slot->texture_handle = AddTextureHandle(texture);
+    slot->bucket_width = bucket_width;
+    slot->bucket_height = bucket_height;
+    return true;
+}
+
+void _DestroySlot(RenderTargetSlot* slot)
+{
+    if (!slot->allocated)
+    {
+        return;
+    }
+
+    ForgetFramebuffer(slot->framebuffer);
+    glDeleteFramebuffers(1, &slot->framebuffer);
+    RemoveTextureHandle(slot->texture_handle);
+    ForgetTexture(slot->texture);
+    glDeleteTextures(1, &slot->texture);
+    *slot = RenderTargetSlot{};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "melon_types.hpp"
+
+// Framebuffer objects with a single RGBA color texture. Released targets stay in a pool bucketed by power of two
+// sizes so panels that open and close, or get recreated after a resize, reuse the GL objects instead of reallocating
+
+#ifndef MAX_RENDER_TARGETS
+    #define MAX_RENDER_TARGETS 16
+#endif
+
+constexpr int RenderTargetMinBucket = 64;
+
+void InitRenderTargets();
+void ShutdownRenderTargets();
+
+// Returns a slot whose texture is at least width x height, or -1. The contents are undefined until cleared
+int AcquireRenderTarget(int width, int height);
+void ReleaseRenderTarget(int slot);
+
+// Sized to the bucket, not to the size that was asked for
+Mln::Texture GetRenderTargetTexture(int slot);
+void BindRenderTarget(int slot); // -1 binds the window
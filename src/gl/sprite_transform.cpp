@@ -0,0 +1,176 @@
+#include "sprite_transform.hpp"
+
+#include <cstring>
+
+// SPRITE_TRANSFORM_NO_SIMD leaves only the scalar path, tools/sprite_bench compares both
+#if defined(SPRITE_TRANSFORM_NO_SIMD)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SPRITE_TRANSFORM_SSE2
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define SPRITE_TRANSFORM_NEON
+#elif defined(__wasm_simd128__)
+    #include <wasm_simd128.h>
+    #define SPRITE_TRANSFORM_WASM
+#endif
+
+#if defined(SPRITE_TRANSFORM_SSE2) || defined(SPRITE_TRANSFORM_NEON) || defined(SPRITE_TRANSFORM_WASM)
+    #define SPRITE_TRANSFORM_SIMD
+#endif
+
+// The rect of one sprite reduced to its clip space center and the two half extents along its rotated axes,
+// a corner is center +- axis_u +- axis_v
+struct SpriteFrame{
+    float center_x, center_y;
+    float u_x, u_y;
+    float v_x, v_y;
+};
+
+void _GetSpriteFrame(const TexturedRect* rect, const Mln::Matrix& view_projection, SpriteFrame* frame);
+void _WriteCorners(const SpriteFrame* frame, float* out, size_t stride);
+
+
+#if defined(SPRITE_TRANSFORM_SSE2)
+typedef __m128 f32x4;
+static inline f32x4 _Set4(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static inline f32x4 _Splat4(float value) { return _mm_set1_ps(value); }
+static inline f32x4 _Add4(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+static inline f32x4 _Sub4(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+static inline f32x4 _Mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+static inline void _Store4(float* dst, f32x4 v) { _mm_storeu_ps(dst, v); }
+static inline void _StoreLow2(float* dst, f32x4 v) { _mm_storel_pi((__m64*)dst, v); }
+static inline void _StoreHigh2(float* dst, f32x4 v) { _mm_storeh_pi((__m64*)dst, v); }
+#elif defined(SPRITE_TRANSFORM_NEON)
+typedef float32x4_t f32x4;
+static inline f32x4 _Set4(float a, float b, float c, float d) { const float values[4] = {a, b, c, d}; return vld1q_f32(values); }
+static inline f32x4 _Splat4(float value) { return vdupq_n_f32(value); }
+static inline f32x4 _Add4(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+static inline f32x4 _Sub4(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+static inline f32x4 _Mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+static inline void _Store4(float* dst, f32x4 v) { vst1q_f32(dst, v); }
+static inline void _StoreLow2(float* dst, f32x4 v) { vst1_f32(dst, vget_low_f32(v)); }
+static inline void _StoreHigh2(float* dst, f32x4 v) { vst1_f32(dst, vget_high_f32(v)); }
+#elif defined(SPRITE_TRANSFORM_WASM)
+typedef v128_t f32x4;
+static inline f32x4 _Set4(float a, float b, float c, float d) { return wasm_f32x4_make(a, b, c, d); }
+static inline f32x4 _Splat4(float value) { return wasm_f32x4_splat(value); }
+static inline f32x4 _Add4(f32x4 a, f32x4 b) { return wasm_f32x4_add(a, b); }
+static inline f32x4 _Sub4(f32x4 a, f32x4 b) { return wasm_f32x4_sub(a, b); }
+static inline f32x4 _Mul4(f32x4 a, f32x4 b) { return wasm_f32x4_mul(a, b); }
+static inline void _Store4(float* dst, f32x4 v) { wasm_v128_store(dst, v); }
+static inline void _StoreLow2(float* dst, f32x4 v) { double pair = wasm_f64x2_extract_lane(v, 0); memcpy(dst, &pair, sizeof(pair)); }
+static inline void _StoreHigh2(float* dst, f32x4 v) { double pair = wasm_f64x2_extract_lane(v, 1); memcpy(dst, &pair, sizeof(pair)); }
+#endif
+
+#if defined(SPRITE_TRANSFORM_SIMD)
+// The x and y rows of the view projection, twice so one register holds the x, y pairs of two corners
+struct SpriteColumns{
+    f32x4 x_axis;
+    f32x4 y_axis;
+    f32x4 translation;
+};
+
+// Same math as _GetSpriteFrame, but the center and both axes stay in registers as x, y, x, y
+// and the corners come out as two pairs per register
+static inline void _TransformSpriteSimd(const TexturedRect* rect, const SpriteColumns* columns, float* out, size_t stride)
+{
+    const Mln::Transform2D& transform = rect->transform;
+    float s = 0.f;
+    float c = 1.f;
+    if (transform.rotation != 0.f)
+    {
+        s = HMM_SinF(transform.rotation);
+        c = HMM_CosF(transform.rotation);
+    }
+    f32x4 sine = _Splat4(s);
+    f32x4 cosine = _Splat4(c);
+    f32x4 half_w = _Splat4(0.5f * rect->texture_source.width * transform.scale.X);
+    f32x4 half_h = _Splat4(0.5f * rect->texture_source.height * transform.scale.Y);
+
+    f32x4 center = _Add4(_Add4(_Mul4(columns->x_axis, _Splat4(transform.position.X)), _Mul4(columns->y_axis, _Splat4(transform.position.Y))), columns->translation);
+    f32x4 u = _Mul4(half_w, _Sub4(_Mul4(columns->x_axis, cosine), _Mul4(columns->y_axis, sine)));
+    f32x4 v = _Mul4(half_h, _Add4(_Mul4(columns->x_axis, sine), _Mul4(columns->y_axis, cosine)));
+
+    // v with the signs of corners 0, 1 in one half and of corners 3, 2 in the other
+    f32x4 v_signed = _Mul4(v, _Set4(-1.f, -1.f, 1.f, 1.f));
+    f32x4 right = _Add4(_Add4(center, u), v_signed); // Top right, bottom right
+    f32x4 left = _Sub4(_Sub4(center, u), v_signed);  // Bottom left, top left
+
+    if (stride == 2 * sizeof(float))
+    {
+        _Store4(out, right);
+        _Store4(out + 4, left);
+        return;
+    }
+    _StoreLow2(out, right);
+    _StoreHigh2((float*)((char*)out + stride), right);
+    _StoreLow2((float*)((char*)out + 2 * stride), left);
+    _StoreHigh2((float*)((char*)out + 3 * stride), left);
+}
+#endif
+
+
+void TransformSpriteCorners(const TexturedRect* rects, int count, const Mln::Matrix& view_projection, float* out, size_t stride)
+{
+#if defined(SPRITE_TRANSFORM_SIMD)
+    const float (*m)[4] = view_projection.Elements;
+    SpriteColumns columns;
+    columns.x_axis = _Set4(m[0][0], m[0][1], m[0][0], m[0][1]);
+    columns.y_axis = _Set4(m[1][0], m[1][1], m[1][0], m[1][1]);
+    columns.translation = _Set4(m[3][0], m[3][1], m[3][0], m[3][1]);
+    for (int i = 0; i < count; i++)
+    {
+        _TransformSpriteSimd(&rects[i], &columns, (float*)((char*)out + 4 * i * stride), stride);
+    }
+#else
+    TransformSpriteCornersScalar(rects, count, view_projection, out, stride);
+#endif
+}
+
+void TransformSpriteCornersScalar(const TexturedRect* rects, int count, const Mln::Matrix& view_projection, float* out, size_t stride)
+{
+    for (int i = 0; i < count; i++)
+    {
+        SpriteFrame frame;
+        _GetSpriteFrame(&rects[i], view_projection, &frame);
+        _WriteCorners(&frame, (float*)((char*)out + 4 * i * stride), stride);
+    }
+}
+
+
+// Translate * Rotate_LH * Scale followed by the view projection, multiplied out for the z = 0 plane.
+// Matrix elements are [column][row]
+void _GetSpriteFrame(const TexturedRect* rect, const Mln::Matrix& view_projection, SpriteFrame* frame)
+{
+    const Mln::Transform2D& transform = rect->transform;
+    float half_w = 0.5f * rect->texture_source.width * transform.scale.X;
+    float half_h = 0.5f * rect->texture_source.height * transform.scale.Y;
+
+    float s = 0.f;
+    float c = 1.f;
+    if (transform.rotation != 0.f)
+    {
+        s = HMM_SinF(transform.rotation);
+        c = HMM_CosF(transform.rotation);
+    }
+
+    const float (*m)[4] = view_projection.Elements;
+    frame->center_x = m[0][0] * transform.position.X + m[1][0] * transform.position.Y + m[3][0];
+    frame->center_y = m[0][1] * transform.position.X + m[1][1] * transform.position.Y + m[3][1];
+    frame->u_x = half_w * (m[0][0] * c - m[1][0] * s);
+    frame->u_y = half_w * (m[0][1] * c - m[1][1] * s);
+    frame->v_x = half_h * (m[0][0] * s + m[1][0] * c);
+    frame->v_y = half_h * (m[0][1] * s + m[1][1] * c);
+}
+
+void _WriteCorners(const SpriteFrame* frame, float* out, size_t stride)
+{
+    const float signs[4][2] = {{1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}, {-1.f, -1.f}};
+    for (int corner = 0; corner < 4; corner++)
+    {
+        float* dst = (float*)((char*)out + corner * stride);
+        dst[0] = frame->center_x + signs[corner][0] * frame->u_x + signs[corner][1] * frame->v_x;
+        dst[1] = frame->center_y + signs[corner][0] * frame->u_y + signs[corner][1] * frame->v_y;
+    }
+}
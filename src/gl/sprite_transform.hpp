@@ -0,0 +1,12 @@
+#pragma once
+
+#include "melon_types.hpp"
+#include "graphics_api.hpp"
+#include <cstddef>
+
+// Writes the 4 clip space corners of every rect in WriteQuad order (top right, bottom right, bottom left, top left)
+// as float pairs stride bytes apart. The rect is centered on the transform like DrawRectTextured does it.
+// With SSE2, NEON or wasm simd128 each sprite's corners are built two per register and stored as pairs
+void TransformSpriteCorners(const TexturedRect* rects, int count, const Mln::Matrix& view_projection, float* out, size_t stride);
+// The portable path TransformSpriteCorners falls back to without SIMD, callable directly for comparisons
+void TransformSpriteCornersScalar(const TexturedRect* rects, int count, const Mln::Matrix& view_projection, float* out, size_t stride);
@@ -14,6 +14,41 @@ enum TextAlign
     TEXT_ALIGN_RIGHT
 };
 
+// Why a batch was submitted instead of being extended with the next draw
+enum FlushCause
+{
+    FLUSH_CAUSE_TEXTURE,      // The batch ran out of texture slots
+    FLUSH_CAUSE_SHADER,       // The next draw used a different shader
+    FLUSH_CAUSE_STATE,        // The next draw switched between quads, instances and static batches or changed the transform
+    FLUSH_CAUSE_CAPACITY,     // The sorted draws did not fit one stream segment and went on in the next
+    FLUSH_CAUSE_END_OF_FRAME, // EndDrawing
+    FLUSH_CAUSE_EXPLICIT,     // Clears and static batch updates that need the pending draws on screen first
+    FLUSH_CAUSE__COUNT
+};
+
+// One sprite for DrawRectsTextured, centered on the transform like DrawRectTextured
+struct TexturedRect{
+    Mln::Transform2D transform;
+    Mln::RectI texture_source;
+    Mln::Color color;
+};
+
+struct RenderStats{
+    int quads;             // Quads and instances drawn, including static batch replays
+    int quads_culled;      // Dropped before reaching the vertex stream because they were off screen
+    int vertices_uploaded; // Streamed and static vertices, instances count as 4
+    int bytes_uploaded;
+    int draw_calls;
+    int texture_binds;
+    int shader_binds;
+    int flushes[FLUSH_CAUSE__COUNT]; // Batches submitted per cause, their sum is the number of batches
+    int gl_calls_issued;
+    int gl_calls_filtered; // State changes dropped by the GL state cache
+    int glyph_run_hits;    // DrawText and MeasureText calls that reused a laid out string
+    int glyph_run_misses;
+    int glyph_run_bytes;   // Held by the glyph run cache at the end of the frame
+};
+
 void InitGraphics(int width, int height);
 void ShutdownGraphics();
 
@@ -25,16 +60,66 @@ void ClearBackground(Mln::Color color);
 
 void BeginDrawing();
 void EndDrawing();
+// Draws are sorted by layer at EndDrawing, within a layer the submission order is kept for overlapping sprites
+void SetDrawLayer(int layer);
+// 0 blends normally and 1 adds the color to what is behind, additive and normal draws share batches
+void SetDrawAdditive(float additive);
+
+// Counters of the last finished frame
+RenderStats GetRenderStats();
+// Copies up to max_count of the most recent frames, oldest first, and returns how many were copied
+int GetRenderStatsHistory(RenderStats* stats, int max_count);
+
+// Copy of what has been drawn so far as RGBA with the top row first, release it with Mln::UnloadImage
+Mln::Image CaptureFramebuffer();
 
 Mln::Texture LoadTexture(const char* path, bool filter, bool mipmaps);
+// LoadTexture premultiplies RGBA images, images passed in directly have to be premultiplied already
 Mln::Texture LoadTextureFromImage(Mln::Image image, bool filter, bool mipmaps);
+// Uploads a mip chain made offline instead of generating one. levels[0] is the base, each level halves the one before
+// down to 1x1 and all of them are premultiplied RGBA
+Mln::Texture LoadTextureFromMipChain(const Mln::Image* levels, int level_count, bool filter);
 void UnloadTexture(Mln::Texture texture);
+// Copies rect of image to the same rect of a texture loaded from an image of the same size and format without mipmaps
+void UpdateTextureRect(Mln::Texture texture, Mln::Image image, Mln::RectI rect);
 
 void DrawRectTextured(Mln::Matrix transform, Mln::Texture texture, Mln::RectI texture_source, Mln::Color color);
+// Sprite expanded from a single instance record on the GPU, pivot is normalized inside texture_source
+void DrawRectTexturedInstanced(Mln::Transform2D transform, Mln::Texture texture, Mln::RectI texture_source, Mln::Color color, Mln::Vector2 pivot = {0.5f, 0.5f});
+// Draws count rects from one texture with the transforms done in bulk on the CPU
+void DrawRectsTextured(Mln::Texture texture, const TexturedRect* rects, int count);
 void DrawRectTexturedNinePatch(Mln::Matrix transform, Mln::Rect rect, Mln::Texture texture, Mln::RectI coords, Mln::Color color, Mln::Vector4 margins);
 
+// Retained batches keep their draws in a GPU buffer and replay them with a transform and tint.
+// Draws between BeginStaticBatch and EndStaticBatch are recorded in world space instead of drawn
+Mln::StaticBatch CreateStaticBatch();
+void UnloadStaticBatch(Mln::StaticBatch batch);
+void BeginStaticBatch(Mln::StaticBatch batch);
+void EndStaticBatch();
+void MarkStaticBatchDirty(Mln::StaticBatch batch);
+bool IsStaticBatchDirty(Mln::StaticBatch batch);
+void DrawStaticBatch(Mln::StaticBatch batch, Mln::Matrix transform, Mln::Color tint);
+
+// Offscreen targets for layers that are expensive to draw but rarely change. Draws between BeginRenderTarget and
+// EndRenderTarget land in the target, which is then drawn like a texture with texture_source {0, 0, width, height}.
+// The contents are premultiplied and undefined until cleared with ClearBackground. The view and projection set inside
+// are restored by EndRenderTarget
+Mln::RenderTarget LoadRenderTarget(int width, int height);
+void UnloadRenderTarget(Mln::RenderTarget target);
+void BeginRenderTarget(Mln::RenderTarget target);
+void EndRenderTarget();
+
 Mln::Font LoadFont(const char* path);
+// Same metrics as LoadFont, but the atlas holds distance fields so the text stays sharp at any DrawText scale
+Mln::Font LoadFontSDF(const char* path);
+// Bakes hold the font file with every glyph rasterized so far, loading one is a single read and rasterizes nothing.
+// Glyphs the bake lacks are rasterized when first drawn like with LoadFont. The bake fails to load when the size or
+// modification time of the TTF at ttf_path changed since it was saved, null skips that check
+Mln::Font LoadFontBake(const char* path, const char* ttf_path);
+bool SaveFontBake(Mln::Font font, const char* path);
 void UnloadFont(Mln::Font font);
+// Bytes the font holds right now, it grows as glyphs are rasterized
+size_t GetFontMemory(Mln::Font font);
 
 float MeasureText(Mln::Font font, const char* str);
 void DrawText(Mln::Font font, const char *str, Mln::Vector2 position, float scale, Mln::Color color, TextAlign alignment = TEXT_ALIGN_LEFT);
@@ -23,7 +23,10 @@ void MainLoop()
 
     Game::Update(Mln::GetFrameTime());
 
-    Game::Draw();
+    if (Mln::ShouldDrawFrame())
+    {
+        Game::Draw();
+    }
 
     Mln::EndFrame();
 }
@@ -0,0 +1,693 @@
+#include "HandmadeMath.h"
+#include "graphics_api.hpp"
+#include "core.hpp"
+#include "melon_types.hpp"
+#include "soft_raster.hpp"
+#include "../gl/sprite_transform.hpp"
+#include "../gl/glyph_runs.hpp"
+#include "../gl/glyph_cache.hpp"
+#include "handle_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+
+// Software implementation of graphics_api.hpp for machines without a GPU, selected with GRAPHICS_SOFTWARE in CMake.
+// Draws are queued and sorted the way the GL backend sorts them, then handed to soft_raster in one go
+
+constexpr int InitialFontCapacity = 8;
+
+#ifndef RENDER_STATS_HISTORY
+    #define RENDER_STATS_HISTORY 120
+#endif
+
+constexpr int InitialSoftQuads = 1 << 16;
+constexpr int MaxStaticBatches = 32;
+constexpr int SpriteChunk = 256;
+// Same rounding as the GL render target pool so target textures have the same size on both backends
+constexpr int RenderTargetMinBucket = 64;
+
+// Stands in for the shader part of the GL sort key, the instanced program is registered after the quad program
+enum SoftProgram
+{
+    SOFT_PROGRAM_QUADS,
+    SOFT_PROGRAM_INSTANCED,
+};
+
+struct AtlasFont{
+    GlyphFont glyphs;
+    SoftShade shade; // SOFT_SHADE_TEXT_SDF for LoadFontSDF fonts
+};
+
+struct SoftStaticBatch{
+    bool used;
+    bool dirty;
+    SoftQuad* quads; // World space
+    int quad_count;
+    int quad_capacity;
+};
+
+struct {
+    Mln::Matrix view;
+    Mln::Matrix projection;
+
+    // Sort keys are layer (8 bits), program (8 bits) and the index into quads.
+    // Everything since the last flush, the arrays grow so a busy frame is still sorted as a whole
+    uint64_t* keys;
+    SoftQuad* quads;
+    SoftQuad* sorted_quads;
+    int quad_count;
+    int quad_capacity;
+
+    int layer;
+    float additive;
+
+    SoftStaticBatch static_batches[MaxStaticBatches];
+    SoftStaticBatch* recording;
+
+    // Set between BeginRenderTarget and EndRenderTarget
+    bool in_render_target;
+    Mln::Matrix window_view;
+    Mln::Matrix window_projection;
+
+    HandlePool fonts; // AtlasFont, Mln::Font is the handle
+
+    RenderStats stats;
+    RenderStats stats_history[RENDER_STATS_HISTORY];
+    uint64_t stats_frame;
+} state = {0};
+
+Mln::Font _LoadFont(const char* path, const char* ttf_path, bool sdf, bool bake);
+AtlasFont* _GetFont(Mln::Font font);
+Mln::Matrix _GetViewProjection();
+void _DrawRectTextured(Mln::Matrix transform, Mln::Rect rect, Mln::Texture texture, Mln::RectI coords, Mln::Color color);
+void _PushQuad(const Mln::Vector2 positions[4], const Mln::Vector2 uvs[4], Mln::Texture texture, Mln::Color color, SoftShade shade, SoftProgram program);
+SoftQuad* _AddQuad(SoftProgram program);
+void _Flush(FlushCause cause);
+int _CompareKeys(const void* a, const void* b);
+bool _IsOffScreen(const Mln::Vector2 positions[4]);
+int _GetBucketSize(int size);
+
+void InitGraphics(int width, int height)
+{
+    InitSoftRaster(width, height, 0);
+    InitGlyphRuns();
+    InitHandlePool(&state.fonts, sizeof(AtlasFont), InitialFontCapacity);
+
+    state.quad_capacity = InitialSoftQuads;
+    state.keys = (uint64_t*)malloc(sizeof(uint64_t) * state.quad_capacity);
+    state.quads = (SoftQuad*)malloc(sizeof(SoftQuad) * state.quad_capacity);
+    state.sorted_quads = (SoftQuad*)malloc(sizeof(SoftQuad) * state.quad_capacity);
+
+    state.view = HMM_M4D(1.0);
+    state.projection = HMM_M4D(1.0);
+}
+
+void ShutdownGraphics()
+{
+    for (int i = 0; i < MaxStaticBatches; i++)
+    {
+        free(state.static_batches[i].quads);
+        state.static_batches[i] = SoftStaticBatch{};
+    }
+    free(state.keys);
+    free(state.quads);
+    free(state.sorted_quads);
+    state.keys = nullptr;
+    state.quads = nullptr;
+    state.sorted_quads = nullptr;
+    state.quad_count = 0;
+    state.quad_capacity = 0;
+    FreeHandlePool(&state.fonts);
+    ShutdownGlyphRuns();
+    ShutdownSoftRaster();
+}
+
+void ResizeViewport(int width, int height)
+{
+    _Flush(FLUSH_CAUSE_EXPLICIT);
+    ResizeSoftRaster(width, height);
+}
+
+void SetView(Mln::Matrix view)
+{
+    state.view = view;
+}
+
+void SetProjection(Mln::Matrix proj)
+{
+    state.projection = proj;
+}
+
+void ClearBackground(Mln::Color color)
+{
+    _Flush(FLUSH_CAUSE_EXPLICIT);
+    ClearSoftFramebuffer(color);
+}
+
+void BeginDrawing()
+{
+    state.layer = 0;
+    state.additive = 0.f;
+}
+
+void SetDrawLayer(int layer)
+{
+    ASSERT(layer >= 0 && layer < 256, "Draw layers must fit in 8 bits");
+    state.layer = layer;
+}
+
+void SetDrawAdditive(float additive)
+{
+    state.additive = HMM_Clamp(0.f, additive, 1.f);
+}
+
+void EndDrawing()
+{
+    _Flush(FLUSH_CAUSE_END_OF_FRAME);
+
+    GlyphRunStats glyph_stats = EndGlyphRunFrame();
+    state.stats.glyph_run_hits = glyph_stats.hits;
+    state.stats.glyph_run_misses = glyph_stats.misses;
+    state.stats.glyph_run_bytes = glyph_stats.bytes;
+    state.stats_history[state.stats_frame % RENDER_STATS_HISTORY] = state.stats;
+    state.stats_frame++;
+    state.stats = RenderStats{};
+}
+
+RenderStats GetRenderStats()
+{
+    if (state.stats_frame == 0)
+    {
+        return RenderStats{};
+    }
+    return state.stats_history[(state.stats_frame - 1) % RENDER_STATS_HISTORY];
+}
+
+int GetRenderStatsHistory(RenderStats* stats, int max_count)
+{
+    int count = state.stats_frame < RENDER_STATS_HISTORY ? (int)state.stats_frame : RENDER_STATS_HISTORY;
+    if (count > max_count)
+    {
+        count = max_count;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        stats[i] = state.stats_history[(state.stats_frame - count + i) % RENDER_STATS_HISTORY];
+    }
+    return count;
+}
+
+Mln::Image CaptureFramebuffer()
+{
+    _Flush(FLUSH_CAUSE_EXPLICIT);
+    return CaptureSoftFramebuffer();
+}
+
+Mln::Texture LoadTexture(const char* path, bool filter, bool mipmaps)
+{
+    Mln::Image image = Mln::LoadImage(path);
+    if (image.data && image.components == 4)
+    {
+        Mln::ImagePremultiplyAlpha(image);
+    }
+    Mln::Texture texture = LoadTextureFromImage(image, filter, mipmaps);
+    Mln::UnloadImage(image);
+    return texture;
+}
+
+Mln::Texture LoadTextureFromImage(Mln::Image image, bool filter, bool mipmaps)
+{
+    if (!image.data)
+    {
+        return Mln::Texture{Mln::InvalidID, 0, 0};
+    }
+    return Mln::Texture{CreateSoftTexture(image, filter, mipmaps), image.width, image.height};
+}
+
+Mln::Texture LoadTextureFromMipChain(const Mln::Image* levels, int level_count, bool filter)
+{
+    ASSERT(level_count > 0 && levels[0].data, "A mip chain needs a base level");
+    return Mln::Texture{CreateSoftTextureLevels(levels, level_count, filter), levels[0].width, levels[0].height};
+}
+
+void UpdateTextureRect(Mln::Texture texture, Mln::Image image, Mln::RectI rect)
+{
+    // Quads queued before the update see the new texels, like they do on GL where the batch is drawn later too
+    UpdateSoftTexture(texture.id, image, rect);
+}
+
+void UnloadTexture(Mln::Texture texture)
+{
+    // Queued quads may still sample it
+    _Flush(FLUSH_CAUSE_EXPLICIT);
+    DeleteSoftTexture(texture.id);
+}
+
+void DrawRectTextured(Mln::Matrix transform, Mln::Texture texture, Mln::RectI coords, Mln::Color color)
+{
+    _DrawRectTextured(transform, Mln::Rect{-(float)coords.width / 2.f, -(float)coords.height / 2.f, (float)coords.width, (float)coords.height}, texture, coords, color);
+}
+
+void DrawRectTexturedInstanced(Mln::Transform2D transform, Mln::Texture texture, Mln::RectI coords, Mln::Color color, Mln::Vector2 pivot)
+{
+    Mln::Rect rect = {-pivot.X * coords.width, -pivot.Y * coords.height, (float)coords.width, (float)coords.height};
+    Mln::Matrix mvp = _GetViewProjection() * Mln::GetMatrix(transform);
+
+    Mln::Vector2 positions[4];
+    positions[0] = (mvp * HMM_Vec4{rect.x + rect.width, rect.y              , 0, 1}).XY;
+    positions[1] = (mvp * HMM_Vec4{rect.x + rect.width, rect.y + rect.height, 0, 1}).XY;
+    positions[2] = (mvp * HMM_Vec4{rect.x             , rect.y + rect.height, 0, 1}).XY;
+    positions[3] = (mvp * HMM_Vec4{rect.x             , rect.y              , 0, 1}).XY;
+
+    float u = coords.x / (float)texture.width;
+    float v = coords.y / (float)texture.height;
+    float w = coords.width / (float)texture.width;
+    float h = coords.height / (float)texture.height;
+    Mln::Vector2 uvs[4] = {{u + w, v}, {u + w, v + h}, {u, v + h}, {u, v}};
+
+    // Recordings only hold quads on the GL side as well
+    _PushQuad(positions, uvs, texture, color, SOFT_SHADE_SPRITE, state.recording ? SOFT_PROGRAM_QUADS : SOFT_PROGRAM_INSTANCED);
+}
+
+void DrawRectsTextured(Mln::Texture texture, const TexturedRect* rects, int count)
+{
+    Mln::Matrix view_projection = _GetViewProjection();
+
+    float texture_w = texture.width;
+    float texture_h = texture.height;
+
+    while (count > 0)
+    {
+        int chunk = count < SpriteChunk ? count : SpriteChunk;
+
+        Mln::Vector2 corners[SpriteChunk * 4];
+        TransformSpriteCorners(rects, chunk, view_projection, &corners[0].X, sizeof(Mln::Vector2));
+
+        for (int i = 0; i < chunk; i++)
+        {
+            const Mln::RectI& coords = rects[i].texture_source;
+            float u = coords.x / texture_w;
+            float v = coords.y / texture_h;
+            float w = coords.width / texture_w;
+            float h = coords.height / texture_h;
+            Mln::Vector2 uvs[4] = {{u + w, v}, {u + w, v + h}, {u, v + h}, {u, v}};
+
+            _PushQuad(corners + 4 * i, uvs, texture, rects[i].color, SOFT_SHADE_SPRITE, SOFT_PROGRAM_QUADS);
+        }
+
+        rects += chunk;
+        count -= chunk;
+    }
+}
+
+void DrawRectTexturedNinePatch(Mln::Matrix transform, Mln::Rect rect, Mln::Texture texture, Mln::RectI coords, Mln::Color color, Mln::Vector4 margins)
+{
+    float inner_w = rect.width - (margins.X + margins.Z);
+    float inner_h = rect.height - (margins.Y + margins.W);
+    int inner_coords_w = coords.width - (int)margins.X - (int)margins.Z;
+    int inner_coords_h = coords.height - (int)margins.Y - (int)margins.W;
+
+    // Same nine pieces and order as the GL backend
+    Mln::Rect rects[9] = {
+        {rect.x, rect.y, margins.X, margins.Y},
+        {rect.x + rect.width - margins.Z, rect.y, margins.Z, margins.Y},
+        {rect.x, rect.y + rect.height - margins.W, margins.X, margins.W},
+        {rect.x + rect.width - margins.Z, rect.y + rect.height - margins.W, margins.Z, margins.W},
+        {rect.x, rect.y + margins.Y, margins.X, inner_h},
+        {rect.x + rect.width - margins.Z, rect.y + margins.Y, margins.Z, inner_h},
+        {rect.x + margins.X, rect.y, inner_w, margins.Y},
+        {rect.x + margins.X, rect.y + rect.height - margins.W, inner_w, margins.W},
+        {rect.x + margins.X, rect.y + margins.Y, inner_w, inner_h},
+    };
+    Mln::RectI uvs[9] = {
+        {coords.x, coords.y, (int)margins.X, (int)margins.Y},
+        {coords.x + coords.width - (int)margins.Z, coords.y, (int)margins.Z, (int)margins.Y},
+        {coords.x, coords.y + coords.height - (int)margins.W, (int)margins.X, (int)margins.W},
+        {coords.x + coords.width - (int)margins.Z, coords.y + coords.height - (int)margins.W, (int)margins.Z, (int)margins.W},
+        {coords.x, coords.y + (int)margins.Y, (int)margins.X, inner_coords_h},
+        {coords.x + coords.width - (int)margins.Z, coords.y + (int)margins.Y, (int)margins.Z, inner_coords_h},
+        {coords.x + (int)margins.X, coords.y, inner_coords_w, (int)margins.Y},
+        {coords.x + (int)margins.X, coords.y + coords.height - (int)margins.W, inner_coords_w, (int)margins.W},
+        {coords.x + (int)margins.X, coords.y + (int)margins.Y, inner_coords_w, inner_coords_h},
+    };
+
+    for (int i = 0; i < 9; i++)
+    {
+        _DrawRectTextured(transform, rects[i], texture, uvs[i], color);
+    }
+}
+
+Mln::StaticBatch CreateStaticBatch()
+{
+    for (int i = 0; i < MaxStaticBatches; i++)
+    {
+        if (!state.static_batches[i].used)
+        {
+            state.static_batches[i].used = true;
+            state.static_batches[i].dirty = true;
+            return Mln::StaticBatch{(Mln::id_t)i};
+        }
+    }
+
+    ASSERT(false, "Too many static batches");
+    return Mln::StaticBatch{Mln::InvalidID};
+}
+
+void UnloadStaticBatch(Mln::StaticBatch batch)
+{
+    ASSERT(batch.id < MaxStaticBatches, "Invalid static batch");
+    free(state.static_batches[batch.id].quads);
+    state.static_batches[batch.id] = SoftStaticBatch{};
+}
+
+void BeginStaticBatch(Mln::StaticBatch batch)
+{
+    ASSERT(batch.id < MaxStaticBatches && state.static_batches[batch.id].used, "Invalid static batch");
+    ASSERT(!state.recording, "Static batch recordings can not be nested");
+    state.recording = &state.static_batches[batch.id];
+    state.recording->quad_count = 0;
+}
+
+void EndStaticBatch()
+{
+    ASSERT(state.recording, "EndStaticBatch without BeginStaticBatch");
+    state.recording->dirty = false;
+    state.recording = nullptr;
+}
+
+void MarkStaticBatchDirty(Mln::StaticBatch batch)
+{
+    ASSERT(batch.id < MaxStaticBatches, "Invalid static batch");
+    state.static_batches[batch.id].dirty = true;
+}
+
+bool IsStaticBatchDirty(Mln::StaticBatch batch)
+{
+    ASSERT(batch.id < MaxStaticBatches, "Invalid static batch");
+    return state.static_batches[batch.id].dirty;
+}
+
+void DrawStaticBatch(Mln::StaticBatch batch, Mln::Matrix transform, Mln::Color tint)
+{
+    ASSERT(batch.id < MaxStaticBatches && state.static_batches[batch.id].used, "Invalid static batch");
+    SoftStaticBatch* static_batch = &state.static_batches[batch.id];
+    Mln::Matrix mvp = state.projection * state.view * transform;
+
+    for (int i = 0; i < static_batch->quad_count; i++)
+    {
+        const SoftQuad* recorded = &static_batch->quads[i];
+        Mln::Vector2 positions[4];
+        for (int corner = 0; corner < 4; corner++)
+        {
+            positions[corner] = (mvp * HMM_Vec4{recorded->positions[corner].X, recorded->positions[corner].Y, 0, 1}).XY;
+        }
+        if (_IsOffScreen(positions))
+        {
+            state.stats.quads_culled++;
+            continue;
+        }
+
+        SoftQuad* quad = _AddQuad(SOFT_PROGRAM_QUADS);
+        *quad = *recorded;
+        for (int corner = 0; corner < 4; corner++)
+        {
+            quad->positions[corner] = positions[corner];
+        }
+        quad->tint = tint;
+    }
+}
+
+Mln::RenderTarget LoadRenderTarget(int width, int height)
+{
+    ASSERT(width > 0 && height > 0, "Render target size must be positive");
+    Mln::Image image = Mln::CreateImage(_GetBucketSize(width), _GetBucketSize(height), 4);
+    Mln::Texture texture = LoadTextureFromImage(image, true, false);
+    Mln::UnloadImage(image);
+    return Mln::RenderTarget{texture.id, texture, width, height};
+}
+
+void UnloadRenderTarget(Mln::RenderTarget target)
+{
+    UnloadTexture(target.texture);
+}
+
+void BeginRenderTarget(Mln::RenderTarget target)
+{
+    ASSERT(!state.in_render_target, "Render targets can not be nested");
+    ASSERT(!state.recording, "Render targets can not be bound while recording a static batch");
+
+    _Flush(FLUSH_CAUSE_EXPLICIT);
+    SetSoftRenderTarget(target.texture.id, target.width, target.height);
+
+    state.in_render_target = true;
+    state.window_view = state.view;
+    state.window_projection = state.projection;
+}
+
+void EndRenderTarget()
+{
+    ASSERT(state.in_render_target, "EndRenderTarget without BeginRenderTarget");
+
+    _Flush(FLUSH_CAUSE_EXPLICIT);
+    SetSoftRenderTarget(Mln::InvalidID, 0, 0);
+
+    state.in_render_target = false;
+    state.view = state.window_view;
+    state.projection = state.window_projection;
+}
+
+Mln::Font LoadFont(const char* path)
+{
+    return _LoadFont(path, nullptr, false, false);
+}
+
+Mln::Font LoadFontSDF(const char* path)
+{
+    return _LoadFont(path, nullptr, true, false);
+}
+
+Mln::Font LoadFontBake(const char* path, const char* ttf_path)
+{
+    return _LoadFont(path, ttf_path, false, true);
+}
+
+bool SaveFontBake(Mln::Font font, const char* path)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+    ASSERT(atlas_font, "Font not found");
+    return atlas_font && SaveGlyphFontBake(&atlas_font->glyphs, path);
+}
+
+Mln::Font _LoadFont(const char* path, const char* ttf_path, bool sdf, bool bake)
+{
+    // Only the font file is read here, glyphs are rasterized when they are first measured or drawn
+    AtlasFont font = {};
+    bool loaded = bake ? LoadGlyphFontBake(&font.glyphs, path, ttf_path) : LoadGlyphFont(&font.glyphs, path, sdf);
+    if (!loaded)
+    {
+        return nullptr;
+    }
+    font.shade = font.glyphs.sdf ? SOFT_SHADE_TEXT_SDF : SOFT_SHADE_TEXT;
+
+    // Handles are never 0, so a null Font stays the failure value
+    return (void*)(uintptr_t)AddPoolItem(&state.fonts, &font);
+}
+
+void UnloadFont(Mln::Font font)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+
+    ASSERT(atlas_font != nullptr, "Font could not be found for unloading.");
+    if (atlas_font == nullptr)
+    {
+        return;
+    }
+
+    ForgetGlyphRuns((uintptr_t)font);
+    UnloadGlyphFont(&atlas_font->glyphs);
+    RemovePoolItem(&state.fonts, (Mln::id_t)(uintptr_t)font);
+}
+
+size_t GetFontMemory(Mln::Font font)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+    ASSERT(atlas_font, "Font not found");
+    return atlas_font ? GetGlyphFontMemory(&atlas_font->glyphs) : 0;
+}
+
+float MeasureText(Mln::Font font, const char* str)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+    ASSERT(atlas_font, "Font not found");
+    if (atlas_font == nullptr)
+    {
+        return 0.f;
+    }
+
+    return GetGlyphRun((uintptr_t)font, &atlas_font->glyphs, str, TEXT_ALIGN_LEFT).width;
+}
+
+void DrawText(Mln::Font font, const char *str, Mln::Vector2 position, float scale, Mln::Color color, TextAlign alignment)
+{
+    AtlasFont* atlas_font = _GetFont(font);
+    ASSERT(atlas_font, "Font not found");
+    if (atlas_font == nullptr)
+    {
+        return;
+    }
+
+    GlyphRun run = GetGlyphRun((uintptr_t)font, &atlas_font->glyphs, str, alignment);
+    UploadGlyphPages(&atlas_font->glyphs);
+
+    Mln::Matrix model = HMM_Translate({position.X, position.Y, 0.f}) * HMM_Scale({scale, scale, 1.f});
+    Mln::Matrix mvp = _GetViewProjection() * model;
+
+    for (int i = 0; i < run.count; i++)
+    {
+        Mln::Vector2 positions[4];
+        Mln::Vector2 uvs[4];
+        GetGlyphCorners(&run.quads[i], mvp, positions, uvs);
+        _PushQuad(positions, uvs, atlas_font->glyphs.pages[run.quads[i].page].texture, color, atlas_font->shade, SOFT_PROGRAM_QUADS);
+    }
+}
+
+
+void _DrawRectTextured(Mln::Matrix transform, Mln::Rect rect, Mln::Texture texture, Mln::RectI coords, Mln::Color color)
+{
+    Mln::Matrix mvp = _GetViewProjection() * transform;
+
+    Mln::Vector2 positions[4];
+    positions[0] = (mvp * HMM_Vec4{rect.x + rect.width, rect.y              , 0, 1}).XY;
+    positions[1] = (mvp * HMM_Vec4{rect.x + rect.width, rect.y + rect.height, 0, 1}).XY;
+    positions[2] = (mvp * HMM_Vec4{rect.x             , rect.y + rect.height, 0, 1}).XY;
+    positions[3] = (mvp * HMM_Vec4{rect.x             , rect.y              , 0, 1}).XY;
+
+    float u = coords.x / (float)texture.width;
+    float v = coords.y / (float)texture.height;
+    float w = coords.width / (float)texture.width;
+    float h = coords.height / (float)texture.height;
+    Mln::Vector2 uvs[4] = {{u + w, v}, {u + w, v + h}, {u, v + h}, {u, v}};
+
+    _PushQuad(positions, uvs, texture, color, SOFT_SHADE_SPRITE, SOFT_PROGRAM_QUADS);
+}
+
+void _PushQuad(const Mln::Vector2 positions[4], const Mln::Vector2 uvs[4], Mln::Texture texture, Mln::Color color, SoftShade shade, SoftProgram program)
+{
+    SoftQuad* quad;
+    if (state.recording)
+    {
+        SoftStaticBatch* batch = state.recording;
+        if (batch->quad_count == batch->quad_capacity)
+        {
+            batch->quad_capacity = batch->quad_capacity ? 2 * batch->quad_capacity : 64;
+            batch->quads = (SoftQuad*)realloc(batch->quads, sizeof(SoftQuad) * batch->quad_capacity);
+        }
+        quad = &batch->quads[batch->quad_count++];
+    }
+    else
+    {
+        if (_IsOffScreen(positions))
+        {
+            state.stats.quads_culled++;
+            return;
+        }
+        quad = _AddQuad(program);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        quad->positions[i] = positions[i];
+        quad->uvs[i] = uvs[i];
+    }
+    quad->color = color;
+    quad->tint = Mln::Color{1.f, 1.f, 1.f, 1.f};
+    quad->additive = state.additive;
+    quad->shade = shade;
+    quad->texture = texture.id;
+}
+
+SoftQuad* _AddQuad(SoftProgram program)
+{
+    if (state.quad_count == state.quad_capacity)
+    {
+        state.quad_capacity *= 2;
+        state.keys = (uint64_t*)realloc(state.keys, sizeof(uint64_t) * state.quad_capacity);
+        state.quads = (SoftQuad*)realloc(state.quads, sizeof(SoftQuad) * state.quad_capacity);
+        state.sorted_quads = (SoftQuad*)realloc(state.sorted_quads, sizeof(SoftQuad) * state.quad_capacity);
+    }
+    state.keys[state.quad_count] = ((uint64_t)state.layer << 56) | ((uint64_t)program << 48) | (uint64_t)state.quad_count;
+    state.stats.quads++;
+    return &state.quads[state.quad_count++];
+}
+
+void _Flush(FlushCause cause)
+{
+    if (state.quad_count == 0)
+    {
+        return;
+    }
+
+    qsort(state.keys, state.quad_count, sizeof(uint64_t), _CompareKeys);
+    for (int i = 0; i < state.quad_count; i++)
+    {
+        state.sorted_quads[i] = state.quads[state.keys[i] & 0xFFFFFFFF];
+    }
+
+    DrawSoftQuads(state.sorted_quads, state.quad_count);
+
+    state.stats.vertices_uploaded += 4 * state.quad_count;
+    state.stats.bytes_uploaded += sizeof(SoftQuad) * state.quad_count;
+    state.stats.draw_calls++;
+    state.stats.flushes[cause]++;
+    state.quad_count = 0;
+}
+
+int _CompareKeys(const void* a, const void* b)
+{
+    uint64_t key_a = *(const uint64_t*)a;
+    uint64_t key_b = *(const uint64_t*)b;
+    return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+bool _IsOffScreen(const Mln::Vector2 positions[4])
+{
+    float min_x = positions[0].X, max_x = positions[0].X;
+    float min_y = positions[0].Y, max_y = positions[0].Y;
+    for (int i = 1; i < 4; i++)
+    {
+        min_x = HMM_MIN(min_x, positions[i].X);
+        max_x = HMM_MAX(max_x, positions[i].X);
+        min_y = HMM_MIN(min_y, positions[i].Y);
+        max_y = HMM_MAX(max_y, positions[i].Y);
+    }
+    return max_x < -1.f || min_x > 1.f || max_y < -1.f || min_y > 1.f;
+}
+
+int _GetBucketSize(int size)
+{
+    int bucket = RenderTargetMinBucket;
+    while (bucket < size)
+    {
+        bucket *= 2;
+    }
+    return bucket;
+}
+
+Mln::Matrix _GetViewProjection()
+{
+    // Static batches are recorded in world space, the camera is applied when they are drawn
+    if (state.recording)
+    {
+        return HMM_M4D(1.0f);
+    }
+    return state.projection * state.view;
+}
+
+AtlasFont* _GetFont(Mln::Font font)
+{
+    return (AtlasFont*)GetPoolItem(&state.fonts, (Mln::id_t)(uintptr_t)font);
+}
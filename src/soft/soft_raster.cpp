@@ -0,0 +1,812 @@
+#include "soft_raster.hpp"
+#include "core.hpp"
+#include "../gl/font_sdf.hpp"
+#include "handle_pool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SOFT_RASTER_SSE2
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define SOFT_RASTER_NEON
+#endif
+
+constexpr int InitialSoftTextures = 64;
+constexpr int MaxTextureLevels = 16;
+constexpr int MaxSoftThreads = 16;
+
+// Vertices are snapped to 1/16 pixel like GL rasterizers do, the edge functions are then exact
+// and the fill rule can decide pixels on shared edges
+constexpr int SubpixelBits = 4;
+constexpr int SubpixelScale = 1 << SubpixelBits;
+// Triangles reaching further than this are dropped instead of overflowing the edge functions
+constexpr float MaxRasterCoordinate = (float)(1 << 20);
+
+struct TextureLevel{
+    uint32_t* texels; // RGBA8, premultiplied like the GL textures
+    int width;
+    int height;
+};
+
+struct SoftTexture{
+    bool filter;
+    TextureLevel levels[MaxTextureLevels];
+    int level_count;
+};
+
+// A quad half in pixel space, set up once and then shaded by every tile it touches
+struct RasterTriangle{
+    int64_t x[3], y[3]; // Fixed point, y down
+    int64_t area;
+    bool top_left[3];   // Edge i runs between the two vertices other than i
+    int min_x, min_y, max_x, max_y;
+
+    float u[3], v[3];
+    const SoftTexture* texture;
+    float lod;
+    float sdf_smoothing; // What fwidth gives the shader, the distance change per pixel
+
+    float color[4];
+    float factor[4]; // Premultiplied tint with the additive factor folded into alpha
+    SoftShade shade;
+};
+
+struct {
+    uint32_t* window_pixels;
+    int window_width;
+    int window_height;
+    Mln::id_t target_texture; // InvalidID while drawing to the window
+
+    // The window or the base level of the bound target
+    uint32_t* pixels;
+    int width;
+    int height;
+    int stride;
+    int tiles_x;
+    int tiles_y;
+
+    HandlePool textures; // SoftTexture
+
+    RasterTriangle* triangles;
+    int triangle_count;
+    int triangle_capacity;
+
+    int* tile_offsets; // Prefix sums into tile_triangles, tile_count + 1 entries
+    int* tile_triangles;
+    int tile_triangle_capacity;
+
+    std::thread workers[MaxSoftThreads];
+    int worker_count;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation;
+    int workers_busy;
+    bool quitting;
+    std::atomic<int> next_tile;
+} state = {0};
+
+void _WorkerMain();
+void _ShadeTiles();
+void _SetPixels(uint32_t* pixels, int width, int height, int stride);
+void _ShadeTile(int tile);
+bool _SetupTriangle(const SoftQuad* quad, const int corners[3], RasterTriangle* triangle);
+void _BinTriangles();
+uint32_t _PackRGBA8(Mln::Color color);
+
+
+// Four floats holding one RGBA color, the shading and blending of a pixel happen on all channels at once
+#if defined(SOFT_RASTER_SSE2)
+typedef __m128 Color4;
+static inline Color4 _Load(const float* src) { return _mm_loadu_ps(src); }
+static inline Color4 _Splat(float value) { return _mm_set1_ps(value); }
+static inline Color4 _Add(Color4 a, Color4 b) { return _mm_add_ps(a, b); }
+static inline Color4 _Sub(Color4 a, Color4 b) { return _mm_sub_ps(a, b); }
+static inline Color4 _Mul(Color4 a, Color4 b) { return _mm_mul_ps(a, b); }
+static inline Color4 _SplatAlpha(Color4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)); }
+static inline float _GetRed(Color4 a) { return _mm_cvtss_f32(a); }
+static inline Color4 _Unpack(uint32_t rgba)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_cvtsi32_si128((int)rgba);
+    __m128i ints = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+    return _mm_mul_ps(_mm_cvtepi32_ps(ints), _mm_set1_ps(1.f / 255.f));
+}
+static inline uint32_t _Pack(Color4 a)
+{
+    __m128 clamped = _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    __m128i ints = _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.f)));
+    __m128i shorts = _mm_packs_epi32(ints, ints);
+    return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(shorts, shorts));
+}
+#elif defined(SOFT_RASTER_NEON)
+typedef float32x4_t Color4;
+static inline Color4 _Load(const float* src) { return vld1q_f32(src); }
+static inline Color4 _Splat(float value) { return vdupq_n_f32(value); }
+static inline Color4 _Add(Color4 a, Color4 b) { return vaddq_f32(a, b); }
+static inline Color4 _Sub(Color4 a, Color4 b) { return vsubq_f32(a, b); }
+static inline Color4 _Mul(Color4 a, Color4 b) { return vmulq_f32(a, b); }
+static inline Color4 _SplatAlpha(Color4 a) { return vdupq_n_f32(vgetq_lane_f32(a, 3)); }
+static inline float _GetRed(Color4 a) { return vgetq_lane_f32(a, 0); }
+static inline Color4 _Unpack(uint32_t rgba)
+{
+    uint16x8_t shorts = vmovl_u8(vcreate_u8((uint64_t)rgba));
+    uint32x4_t ints = vmovl_u16(vget_low_u16(shorts));
+    return vmulq_n_f32(vcvtq_f32_u32(ints), 1.f / 255.f);
+}
+static inline uint32_t _Pack(Color4 a)
+{
+    float32x4_t clamped = vminq_f32(vmaxq_f32(a, vdupq_n_f32(0.f)), vdupq_n_f32(1.f));
+    uint32x4_t ints = vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(clamped, 255.f), vdupq_n_f32(0.5f)));
+    uint16x4_t shorts = vmovn_u32(ints);
+    uint8x8_t bytes = vmovn_u16(vcombine_u16(shorts, shorts));
+    return vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+}
+#else
+struct Color4{
+    float c[4];
+};
+static inline Color4 _Load(const float* src) { return Color4{{src[0], src[1], src[2], src[3]}}; }
+static inline Color4 _Splat(float value) { return Color4{{value, value, value, value}}; }
+static inline Color4 _Add(Color4 a, Color4 b) { return Color4{{a.c[0] + b.c[0], a.c[1] + b.c[1], a.c[2] + b.c[2], a.c[3] + b.c[3]}}; }
+static inline Color4 _Sub(Color4 a, Color4 b) { return Color4{{a.c[0] - b.c[0], a.c[1] - b.c[1], a.c[2] - b.c[2], a.c[3] - b.c[3]}}; }
+static inline Color4 _Mul(Color4 a, Color4 b) { return Color4{{a.c[0] * b.c[0], a.c[1] * b.c[1], a.c[2] * b.c[2], a.c[3] * b.c[3]}}; }
+static inline Color4 _SplatAlpha(Color4 a) { return _Splat(a.c[3]); }
+static inline float _GetRed(Color4 a) { return a.c[0]; }
+static inline Color4 _Unpack(uint32_t rgba)
+{
+    Color4 result;
+    for (int i = 0; i < 4; i++)
+    {
+        result.c[i] = ((rgba >> (8 * i)) & 0xFF) / 255.f;
+    }
+    return result;
+}
+static inline uint32_t _Pack(Color4 a)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        float value = a.c[i] < 0.f ? 0.f : (a.c[i] > 1.f ? 1.f : a.c[i]);
+        result |= (uint32_t)(value * 255.f + 0.5f) << (8 * i);
+    }
+    return result;
+}
+#endif
+
+static inline Color4 _Lerp(Color4 a, Color4 b, float t)
+{
+    return _Add(a, _Mul(_Sub(b, a), _Splat(t)));
+}
+
+// Expanded like GL does it for GL_RED, GL_RG and GL_RGB: missing color channels read 0 and alpha 1
+static inline uint32_t _ExpandTexel(const unsigned char* src, int components)
+{
+    uint32_t texel = 0xFF000000u;
+    for (int c = 0; c < components; c++)
+    {
+        texel = (texel & ~(0xFFu << (8 * c))) | ((uint32_t)src[c] << (8 * c));
+    }
+    return texel;
+}
+
+static inline float _SmoothStep(float edge0, float edge1, float x)
+{
+    float t = HMM_Clamp(0.f, (x - edge0) / (edge1 - edge0), 1.f);
+    return t * t * (3.f - 2.f * t);
+}
+
+
+void InitSoftRaster(int width, int height, int thread_count)
+{
+    state.target_texture = Mln::InvalidID;
+    InitHandlePool(&state.textures, sizeof(SoftTexture), InitialSoftTextures);
+    ResizeSoftRaster(width, height);
+
+    if (thread_count <= 0)
+    {
+        thread_count = (int)std::thread::hardware_concurrency();
+    }
+    // The calling thread shades tiles as well
+    state.worker_count = HMM_MIN(HMM_MAX(thread_count - 1, 0), MaxSoftThreads);
+    state.quitting = false;
+    for (int i = 0; i < state.worker_count; i++)
+    {
+        state.workers[i] = std::thread(_WorkerMain);
+    }
+}
+
+void ShutdownSoftRaster()
+{
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.quitting = true;
+    }
+    state.wake.notify_all();
+    for (int i = 0; i < state.worker_count; i++)
+    {
+        state.workers[i].join();
+    }
+    state.worker_count = 0;
+
+    state.target_texture = Mln::InvalidID;
+    for (int i = 0; i < state.textures.capacity; i++)
+    {
+        SoftTexture* texture = (SoftTexture*)GetPoolItemAt(&state.textures, i);
+        for (int level = 0; texture && level < texture->level_count; level++)
+        {
+            free(texture->levels[level].texels);
+        }
+    }
+    FreeHandlePool(&state.textures);
+
+    free(state.window_pixels);
+    free(state.triangles);
+    free(state.tile_offsets);
+    free(state.tile_triangles);
+    state.window_pixels = nullptr;
+    state.pixels = nullptr;
+    state.triangles = nullptr;
+    state.tile_offsets = nullptr;
+    state.tile_triangles = nullptr;
+    state.triangle_capacity = 0;
+    state.tile_triangle_capacity = 0;
+}
+
+void ResizeSoftRaster(int width, int height)
+{
+    ASSERT(width > 0 && height > 0, "Framebuffer size must be positive");
+    free(state.window_pixels);
+
+    state.window_width = width;
+    state.window_height = height;
+    state.window_pixels = (uint32_t*)calloc((size_t)width * height, sizeof(uint32_t));
+    if (state.target_texture == Mln::InvalidID)
+    {
+        _SetPixels(state.window_pixels, width, height, width);
+    }
+}
+
+void SetSoftRenderTarget(Mln::id_t texture_id, int width, int height)
+{
+    if (texture_id == Mln::InvalidID)
+    {
+        state.target_texture = Mln::InvalidID;
+        _SetPixels(state.window_pixels, state.window_width, state.window_height, state.window_width);
+        return;
+    }
+
+    SoftTexture* texture = (SoftTexture*)GetPoolItem(&state.textures, texture_id);
+    ASSERT(texture, "Invalid software texture");
+    if (texture == nullptr)
+    {
+        return;
+    }
+    TextureLevel* base = &texture->levels[0];
+    ASSERT(width <= base->width && height <= base->height, "Render target is larger than its texture");
+    state.target_texture = texture_id;
+    _SetPixels(base->texels, width, height, base->width);
+}
+
+Mln::id_t CreateSoftTexture(Mln::Image image, bool filter, bool mipmaps)
+{
+    ASSERT(image.data && image.components >= 1 && image.components <= 4, "Invalid image");
+
+    SoftTexture created = {};
+    SoftTexture* texture = &created;
+    texture->filter = filter;
+    texture->level_count = 1;
+
+    TextureLevel* base = &texture->levels[0];
+    base->width = image.width;
+    base->height = image.height;
+    base->texels = (uint32_t*)malloc((size_t)image.width * image.height * sizeof(uint32_t));
+    for (int p = 0; p < image.width * image.height; p++)
+    {
+        base->texels[p] = _ExpandTexel(image.data + p * image.components, image.components);
+    }
+
+    // Box filtered chain like glGenerateMipmap, on premultiplied texels so the average stays correct
+    while (mipmaps && texture->level_count < MaxTextureLevels)
+    {
+        TextureLevel* src = &texture->levels[texture->level_count - 1];
+        if (src->width == 1 && src->height == 1)
+        {
+            break;
+        }
+
+        TextureLevel* dst = &texture->levels[texture->level_count++];
+        dst->width = src->width > 1 ? src->width / 2 : 1;
+        dst->height = src->height > 1 ? src->height / 2 : 1;
+        dst->texels = (uint32_t*)malloc((size_t)dst->width * dst->height * sizeof(uint32_t));
+        for (int y = 0; y < dst->height; y++)
+        {
+            for (int x = 0; x < dst->width; x++)
+            {
+                int x0 = HMM_MIN(2 * x, src->width - 1), x1 = HMM_MIN(2 * x + 1, src->width - 1);
+                int y0 = HMM_MIN(2 * y, src->height - 1), y1 = HMM_MIN(2 * y + 1, src->height - 1);
+                Color4 sum = _Add(_Add(_Unpack(src->texels[y0 * src->width + x0]), _Unpack(src->texels[y0 * src->width + x1])),
+                                  _Add(_Unpack(src->texels[y1 * src->width + x0]), _Unpack(src->texels[y1 * src->width + x1])));
+                dst->texels[y * dst->width + x] = _Pack(_Mul(sum, _Splat(0.25f)));
+            }
+        }
+    }
+
+
+    return AddPoolItem(&state.textures, &created);
+}
+
+Mln::id_t CreateSoftTextureLevels(const Mln::Image* levels, int level_count, bool filter)
+{
+    SoftTexture texture = {};
+    texture.filter = filter;
+    texture.level_count = HMM_MIN(level_count, MaxTextureLevels);
+    for (int i = 0; i < texture.level_count; i++)
+    {
+        const Mln::Image* image = &levels[i];
+        ASSERT(image->data && image->components >= 1 && image->components <= 4, "Invalid image");
+        TextureLevel* level = &texture.levels[i];
+        level->width = image->width;
+        level->height = image->height;
+        level->texels = (uint32_t*)malloc((size_t)image->width * image->height * sizeof(uint32_t));
+        for (int p = 0; p < image->width * image->height; p++)
+        {
+            level->texels[p] = _ExpandTexel(image->data + p * image->components, image->components);
+        }
+    }
+
+    return AddPoolItem(&state.textures, &texture);
+}
+
+void DeleteSoftTexture(Mln::id_t texture_id)
+{
+    ASSERT(texture_id != state.target_texture, "Texture is bound as the render target");
+    SoftTexture* texture = (SoftTexture*)GetPoolItem(&state.textures, texture_id);
+    ASSERT(texture, "Invalid software texture");
+    if (texture == nullptr)
+    {
+        return;
+    }
+    for (int i = 0; i < texture->level_count; i++)
+    {
+        free(texture->levels[i].texels);
+    }
+    RemovePoolItem(&state.textures, texture_id);
+}
+
+void UpdateSoftTexture(Mln::id_t texture_id, Mln::Image image, Mln::RectI rect)
+{
+    SoftTexture* texture = (SoftTexture*)GetPoolItem(&state.textures, texture_id);
+    ASSERT(texture, "Invalid software texture");
+    if (texture == nullptr)
+    {
+        return;
+    }
+    TextureLevel* base = &texture->levels[0];
+    ASSERT(texture->level_count == 1, "Textures with mipmaps can't be updated");
+    ASSERT(image.width == base->width && image.height == base->height, "Image and texture sizes differ");
+
+    for (int y = rect.y; y < rect.y + rect.height; y++)
+    {
+        for (int x = rect.x; x < rect.x + rect.width; x++)
+        {
+            int p = y * base->width + x;
+            base->texels[p] = _ExpandTexel(image.data + p * image.components, image.components);
+        }
+    }
+}
+
+void ClearSoftFramebuffer(Mln::Color color)
+{
+    uint32_t packed = _PackRGBA8(color);
+    for (int y = 0; y < state.height; y++)
+    {
+        uint32_t* row = state.pixels + (size_t)y * state.stride;
+        for (int x = 0; x < state.width; x++)
+        {
+            row[x] = packed;
+        }
+    }
+}
+
+void DrawSoftQuads(const SoftQuad* quads, int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (state.triangle_capacity < 2 * count)
+    {
+        state.triangle_capacity = 2 * count;
+        state.triangles = (RasterTriangle*)realloc(state.triangles, sizeof(RasterTriangle) * state.triangle_capacity);
+    }
+
+    // Same split as the GL index buffer: 0 1 3 and 1 2 3
+    static const int Corners[2][3] = {{0, 1, 3}, {1, 2, 3}};
+    state.triangle_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        for (int half = 0; half < 2; half++)
+        {
+            if (_SetupTriangle(&quads[i], Corners[half], &state.triangles[state.triangle_count]))
+            {
+                state.triangle_count++;
+            }
+        }
+    }
+
+    _BinTriangles();
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.next_tile = 0;
+        state.workers_busy = state.worker_count;
+        state.generation++;
+    }
+    state.wake.notify_all();
+
+    _ShadeTiles();
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.done.wait(lock, []() { return state.workers_busy == 0; });
+}
+
+Mln::Image CaptureSoftFramebuffer()
+{
+    Mln::Image image = Mln::CreateImage(state.width, state.height, 4);
+    for (int y = 0; y < state.height; y++)
+    {
+        memcpy(image.data + (size_t)y * state.width * 4, state.pixels + (size_t)y * state.stride, (size_t)state.width * sizeof(uint32_t));
+    }
+    return image;
+}
+
+
+void _SetPixels(uint32_t* pixels, int width, int height, int stride)
+{
+    state.pixels = pixels;
+    state.width = width;
+    state.height = height;
+    state.stride = stride;
+    state.tiles_x = (width + SoftTileSize - 1) / SoftTileSize;
+    state.tiles_y = (height + SoftTileSize - 1) / SoftTileSize;
+    free(state.tile_offsets);
+    state.tile_offsets = (int*)calloc(state.tiles_x * state.tiles_y + 1, sizeof(int));
+}
+
+void _WorkerMain()
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.wake.wait(lock, [&]() { return state.quitting || state.generation != seen; });
+            if (state.quitting)
+            {
+                return;
+            }
+            seen = state.generation;
+        }
+
+        _ShadeTiles();
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (--state.workers_busy == 0)
+        {
+            state.done.notify_one();
+        }
+    }
+}
+
+void _ShadeTiles()
+{
+    int tile_count = state.tiles_x * state.tiles_y;
+    for (int tile = state.next_tile++; tile < tile_count; tile = state.next_tile++)
+    {
+        _ShadeTile(tile);
+    }
+}
+
+// Counting sort of the triangles into the tiles their bounds touch, each tile keeps the submission order
+void _BinTriangles()
+{
+    int tile_count = state.tiles_x * state.tiles_y;
+    memset(state.tile_offsets, 0, sizeof(int) * (tile_count + 1));
+
+    for (int i = 0; i < state.triangle_count; i++)
+    {
+        RasterTriangle* triangle = &state.triangles[i];
+        for (int ty = triangle->min_y / SoftTileSize; ty <= triangle->max_y / SoftTileSize; ty++)
+        {
+            for (int tx = triangle->min_x / SoftTileSize; tx <= triangle->max_x / SoftTileSize; tx++)
+            {
+                state.tile_offsets[ty * state.tiles_x + tx + 1]++;
+            }
+        }
+    }
+
+    for (int tile = 0; tile < tile_count; tile++)
+    {
+        state.tile_offsets[tile + 1] += state.tile_offsets[tile];
+    }
+
+    int total = state.tile_offsets[tile_count];
+    if (state.tile_triangle_capacity < total)
+    {
+        state.tile_triangle_capacity = total;
+        state.tile_triangles = (int*)realloc(state.tile_triangles, sizeof(int) * total);
+    }
+
+    // tile_offsets[tile] is used as the write cursor and ends up at the start of the next tile
+    for (int i = 0; i < state.triangle_count; i++)
+    {
+        RasterTriangle* triangle = &state.triangles[i];
+        for (int ty = triangle->min_y / SoftTileSize; ty <= triangle->max_y / SoftTileSize; ty++)
+        {
+            for (int tx = triangle->min_x / SoftTileSize; tx <= triangle->max_x / SoftTileSize; tx++)
+            {
+                state.tile_triangles[state.tile_offsets[ty * state.tiles_x + tx]++] = i;
+            }
+        }
+    }
+    for (int tile = tile_count; tile > 0; tile--)
+    {
+        state.tile_offsets[tile] = state.tile_offsets[tile - 1];
+    }
+    state.tile_offsets[0] = 0;
+}
+
+bool _SetupTriangle(const SoftQuad* quad, const int corners[3], RasterTriangle* triangle)
+{
+    float px[3], py[3];
+    for (int i = 0; i < 3; i++)
+    {
+        // glViewport mapping with the rows flipped so the framebuffer starts at the top
+        const Mln::Vector2& position = quad->positions[corners[i]];
+        px[i] = (position.X + 1.f) * 0.5f * state.width;
+        py[i] = (1.f - position.Y) * 0.5f * state.height;
+        if (fabsf(px[i]) > MaxRasterCoordinate || fabsf(py[i]) > MaxRasterCoordinate)
+        {
+            return false;
+        }
+        triangle->x[i] = (int64_t)lroundf(px[i] * SubpixelScale);
+        triangle->y[i] = (int64_t)lroundf(py[i] * SubpixelScale);
+        triangle->u[i] = quad->uvs[corners[i]].X;
+        triangle->v[i] = quad->uvs[corners[i]].Y;
+    }
+
+    triangle->area = (triangle->x[1] - triangle->x[0]) * (triangle->y[2] - triangle->y[0]) - (triangle->y[1] - triangle->y[0]) * (triangle->x[2] - triangle->x[0]);
+    if (triangle->area == 0)
+    {
+        return false;
+    }
+    if (triangle->area < 0)
+    {
+        // Both windings are drawn, flip to the one the edge functions expect
+        int64_t x = triangle->x[1], y = triangle->y[1];
+        float u = triangle->u[1], v = triangle->v[1];
+        triangle->x[1] = triangle->x[2]; triangle->y[1] = triangle->y[2]; triangle->u[1] = triangle->u[2]; triangle->v[1] = triangle->v[2];
+        triangle->x[2] = x; triangle->y[2] = y; triangle->u[2] = u; triangle->v[2] = v;
+        triangle->area = -triangle->area;
+    }
+
+    // Pixel centers sit at +0.5, the bounds cover every center the triangle could contain
+    int64_t min_x = HMM_MIN(triangle->x[0], HMM_MIN(triangle->x[1], triangle->x[2]));
+    int64_t max_x = HMM_MAX(triangle->x[0], HMM_MAX(triangle->x[1], triangle->x[2]));
+    int64_t min_y = HMM_MIN(triangle->y[0], HMM_MIN(triangle->y[1], triangle->y[2]));
+    int64_t max_y = HMM_MAX(triangle->y[0], HMM_MAX(triangle->y[1], triangle->y[2]));
+    triangle->min_x = (int)HMM_MAX((int64_t)0, (min_x - SubpixelScale / 2 + SubpixelScale - 1) >> SubpixelBits);
+    triangle->min_y = (int)HMM_MAX((int64_t)0, (min_y - SubpixelScale / 2 + SubpixelScale - 1) >> SubpixelBits);
+    triangle->max_x = (int)HMM_MIN((int64_t)state.width - 1, (max_x - SubpixelScale / 2) >> SubpixelBits);
+    triangle->max_y = (int)HMM_MIN((int64_t)state.height - 1, (max_y - SubpixelScale / 2) >> SubpixelBits);
+    if (triangle->min_x > triangle->max_x || triangle->min_y > triangle->max_y)
+    {
+        return false;
+    }
+
+    // Centers exactly on an edge belong to the triangle on one side only, so shared quad diagonals blend once
+    for (int i = 0; i < 3; i++)
+    {
+        int a = (i + 1) % 3;
+        int b = (i + 2) % 3;
+        int64_t dx = triangle->x[b] - triangle->x[a];
+        int64_t dy = triangle->y[b] - triangle->y[a];
+        triangle->top_left[i] = dy > 0 || (dy == 0 && dx < 0);
+    }
+
+    // Textures are only created between flushes, so the pointer holds until the triangles are shaded
+    triangle->texture = (const SoftTexture*)GetPoolItem(&state.textures, quad->texture);
+    triangle->lod = 0.f;
+    triangle->sdf_smoothing = 0.f;
+    if (triangle->texture)
+    {
+        // The mapping is affine, so the texel footprint of a pixel is the same everywhere in the triangle
+        float area = (px[1] - px[0]) * (py[2] - py[0]) - (py[1] - py[0]) * (px[2] - px[0]);
+        float du_dx = ((triangle->u[1] - triangle->u[0]) * (py[2] - py[0]) - (triangle->u[2] - triangle->u[0]) * (py[1] - py[0])) / area;
+        float dv_dx = ((triangle->v[1] - triangle->v[0]) * (py[2] - py[0]) - (triangle->v[2] - triangle->v[0]) * (py[1] - py[0])) / area;
+        float du_dy = ((triangle->u[2] - triangle->u[0]) * (px[1] - px[0]) - (triangle->u[1] - triangle->u[0]) * (px[2] - px[0])) / area;
+        float dv_dy = ((triangle->v[2] - triangle->v[0]) * (px[1] - px[0]) - (triangle->v[1] - triangle->v[0]) * (px[2] - px[0])) / area;
+        float w = (float)triangle->texture->levels[0].width;
+        float h = (float)triangle->texture->levels[0].height;
+        float rho_x = sqrtf(du_dx * du_dx * w * w + dv_dx * dv_dx * h * h);
+        float rho_y = sqrtf(du_dy * du_dy * w * w + dv_dy * dv_dy * h * h);
+        float rho = HMM_MAX(rho_x, rho_y);
+        triangle->lod = rho > 0.f ? log2f(rho) : 0.f;
+        triangle->sdf_smoothing = HMM_MAX(0.7f * rho * FontSdfDistanceScale / 255.f, 0.001f);
+    }
+
+    triangle->color[0] = quad->color.R;
+    triangle->color[1] = quad->color.G;
+    triangle->color[2] = quad->color.B;
+    triangle->color[3] = quad->color.A;
+    triangle->factor[0] = quad->tint.R * quad->tint.A;
+    triangle->factor[1] = quad->tint.G * quad->tint.A;
+    triangle->factor[2] = quad->tint.B * quad->tint.A;
+    triangle->factor[3] = quad->tint.A * (1.f - quad->additive);
+    triangle->shade = quad->shade;
+    return true;
+}
+
+static inline int _Wrap(int value, int size)
+{
+    value %= size;
+    return value < 0 ? value + size : value;
+}
+
+// GL_REPEAT addressing with GL_NEAREST or GL_LINEAR within one level
+static inline Color4 _SampleLevel(const TextureLevel* level, bool filter, float u, float v)
+{
+    if (!filter)
+    {
+        int x = _Wrap((int)floorf(u * level->width), level->width);
+        int y = _Wrap((int)floorf(v * level->height), level->height);
+        return _Unpack(level->texels[y * level->width + x]);
+    }
+
+    float fx = u * level->width - 0.5f;
+    float fy = v * level->height - 0.5f;
+    float x0f = floorf(fx);
+    float y0f = floorf(fy);
+    float tx = fx - x0f;
+    float ty = fy - y0f;
+    int x0 = _Wrap((int)x0f, level->width), x1 = _Wrap((int)x0f + 1, level->width);
+    int y0 = _Wrap((int)y0f, level->height), y1 = _Wrap((int)y0f + 1, level->height);
+
+    Color4 top = _Lerp(_Unpack(level->texels[y0 * level->width + x0]), _Unpack(level->texels[y0 * level->width + x1]), tx);
+    Color4 bottom = _Lerp(_Unpack(level->texels[y1 * level->width + x0]), _Unpack(level->texels[y1 * level->width + x1]), tx);
+    return _Lerp(top, bottom, ty);
+}
+
+// Magnification uses level 0, minification picks levels like GL_*_MIPMAP_NEAREST for unfiltered
+// and GL_LINEAR_MIPMAP_LINEAR for filtered textures, matching the filters LoadTextureFromImage sets
+static inline Color4 _Sample(const SoftTexture* texture, float lod, float u, float v)
+{
+    if (lod <= 0.f || texture->level_count == 1)
+    {
+        return _SampleLevel(&texture->levels[0], texture->filter, u, v);
+    }
+
+    float max_level = (float)(texture->level_count - 1);
+    if (!texture->filter)
+    {
+        int level = (int)HMM_MIN(floorf(lod + 0.5f), max_level);
+        return _SampleLevel(&texture->levels[level], false, u, v);
+    }
+
+    float clamped = HMM_MIN(lod, max_level);
+    int level = (int)clamped;
+    if (level == (int)max_level)
+    {
+        return _SampleLevel(&texture->levels[level], true, u, v);
+    }
+    return _Lerp(_SampleLevel(&texture->levels[level], true, u, v), _SampleLevel(&texture->levels[level + 1], true, u, v), clamped - level);
+}
+
+void _ShadeTile(int tile)
+{
+    int tile_min_x = (tile % state.tiles_x) * SoftTileSize;
+    int tile_min_y = (tile / state.tiles_x) * SoftTileSize;
+    int tile_max_x = HMM_MIN(tile_min_x + SoftTileSize, state.width) - 1;
+    int tile_max_y = HMM_MIN(tile_min_y + SoftTileSize, state.height) - 1;
+
+    for (int t = state.tile_offsets[tile]; t < state.tile_offsets[tile + 1]; t++)
+    {
+        const RasterTriangle* triangle = &state.triangles[state.tile_triangles[t]];
+        int min_x = HMM_MAX(triangle->min_x, tile_min_x);
+        int min_y = HMM_MAX(triangle->min_y, tile_min_y);
+        int max_x = HMM_MIN(triangle->max_x, tile_max_x);
+        int max_y = HMM_MIN(triangle->max_y, tile_max_y);
+        if (min_x > max_x || min_y > max_y)
+        {
+            continue;
+        }
+
+        // Edge functions at the first pixel center and their steps per pixel and row.
+        // Top left edges keep centers that land exactly on them, the others need a strictly positive value
+        int64_t row[3], step_x[3], step_y[3];
+        int64_t center_x = ((int64_t)min_x << SubpixelBits) + SubpixelScale / 2;
+        int64_t center_y = ((int64_t)min_y << SubpixelBits) + SubpixelScale / 2;
+        for (int i = 0; i < 3; i++)
+        {
+            int a = (i + 1) % 3;
+            int b = (i + 2) % 3;
+            int64_t dx = triangle->x[b] - triangle->x[a];
+            int64_t dy = triangle->y[b] - triangle->y[a];
+            row[i] = dx * (center_y - triangle->y[a]) - dy * (center_x - triangle->x[a]) - (triangle->top_left[i] ? 0 : 1);
+            step_x[i] = -dy * SubpixelScale;
+            step_y[i] = dx * SubpixelScale;
+        }
+
+        float opaque[4] = {triangle->color[0], triangle->color[1], triangle->color[2], 1.f};
+        Color4 color = _Load(triangle->color);
+        Color4 color_opaque = _Load(opaque);
+        Color4 factor = _Load(triangle->factor);
+        float inverse_area = 1.f / (float)triangle->area;
+
+        for (int y = min_y; y <= max_y; y++)
+        {
+            int64_t e0 = row[0], e1 = row[1], e2 = row[2];
+            uint32_t* pixel = state.pixels + (size_t)y * state.stride + min_x;
+            for (int x = min_x; x <= max_x; x++, pixel++, e0 += step_x[0], e1 += step_x[1], e2 += step_x[2])
+            {
+                if ((e0 | e1 | e2) < 0)
+                {
+                    continue;
+                }
+
+                // The bias only decides ties, the weights use the unbiased values
+                float w0 = (float)(e0 + (triangle->top_left[0] ? 0 : 1)) * inverse_area;
+                float w1 = (float)(e1 + (triangle->top_left[1] ? 0 : 1)) * inverse_area;
+                float w2 = 1.f - w0 - w1;
+                float u = w0 * triangle->u[0] + w1 * triangle->u[1] + w2 * triangle->u[2];
+                float v = w0 * triangle->v[0] + w1 * triangle->v[1] + w2 * triangle->v[2];
+
+                Color4 texel = triangle->texture ? _Sample(triangle->texture, triangle->lod, u, v) : _Splat(1.f);
+
+                // shaders/gl/default.fs on premultiplied colors
+                Color4 source;
+                if (triangle->shade == SOFT_SHADE_SPRITE)
+                {
+                    Color4 flash = _Mul(color_opaque, _SplatAlpha(texel));
+                    source = _Add(texel, _Mul(_Sub(flash, texel), _SplatAlpha(color)));
+                }
+                else if (triangle->shade == SOFT_SHADE_TEXT)
+                {
+                    float coverage = _GetRed(texel) * triangle->color[3];
+                    source = _Mul(color_opaque, _Splat(coverage));
+                }
+                else
+                {
+                    float coverage = _SmoothStep(0.5f - triangle->sdf_smoothing, 0.5f + triangle->sdf_smoothing, _GetRed(texel)) * triangle->color[3];
+                    source = _Mul(color_opaque, _Splat(coverage));
+                }
+                source = _Mul(source, factor);
+
+                // ONE, ONE_MINUS_SRC_ALPHA
+                Color4 destination = _Unpack(*pixel);
+                Color4 result = _Add(source, _Mul(destination, _Sub(_Splat(1.f), _SplatAlpha(source))));
+                *pixel = _Pack(result);
+            }
+            row[0] += step_y[0];
+            row[1] += step_y[1];
+            row[2] += step_y[2];
+        }
+    }
+}
+
+uint32_t _PackRGBA8(Mln::Color color)
+{
+    float channels[4] = {color.R, color.G, color.B, color.A};
+    return _Pack(_Load(channels));
+}
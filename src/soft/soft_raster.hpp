@@ -0,0 +1,50 @@
+#pragma once
+
+#include "melon_types.hpp"
+#include <cstdint>
+
+// CPU rasterizer behind graphics_soft.cpp. The framebuffer is RGBA8 with the top row first, quads are binned into
+// SoftTileSize tiles and the tiles are shaded in parallel. Blending is the GL backend's ONE, ONE_MINUS_SRC_ALPHA
+// on premultiplied colors and the shading follows shaders/gl/default.fs.
+// Nothing presents the framebuffer, CaptureFramebuffer is the way out, see tools/soft_golden
+
+constexpr int SoftTileSize = 64;
+
+enum SoftShade
+{
+    SOFT_SHADE_SPRITE,   // QUAD_MODE_SPRITE
+    SOFT_SHADE_TEXT,     // QUAD_MODE_TEXT
+    SOFT_SHADE_TEXT_SDF, // QUAD_MODE_TEXT_SDF
+};
+
+struct SoftQuad{
+    Mln::Vector2 positions[4]; // Clip space, in the same corner order as the GL quads
+    Mln::Vector2 uvs[4];
+    Mln::Color color;
+    Mln::Color tint;
+    float additive;
+    SoftShade shade;
+    Mln::id_t texture;
+};
+
+void InitSoftRaster(int width, int height, int thread_count); // 0 threads picks one per core
+void ShutdownSoftRaster();
+void ResizeSoftRaster(int width, int height);
+
+Mln::id_t CreateSoftTexture(Mln::Image image, bool filter, bool mipmaps);
+// Takes the levels as they are instead of filtering them from the base, extra levels past MaxTextureLevels are dropped
+Mln::id_t CreateSoftTextureLevels(const Mln::Image* levels, int level_count, bool filter);
+void DeleteSoftTexture(Mln::id_t texture);
+// Rewrites rect of a texture without mipmaps from the same rect of an image of the texture's size
+void UpdateSoftTexture(Mln::id_t texture, Mln::Image image, Mln::RectI rect);
+
+// Draws, clears and captures go to the top left width x height texels of the texture until it is set back to
+// InvalidID. The texture must not have mipmaps and must not be sampled while it is bound
+void SetSoftRenderTarget(Mln::id_t texture, int width, int height);
+
+void ClearSoftFramebuffer(Mln::Color color);
+// Draws the quads in order and returns once every tile is done
+void DrawSoftQuads(const SoftQuad* quads, int count);
+
+// Copy of the window or the bound target for Mln::WriteImage, release it with Mln::UnloadImage
+Mln::Image CaptureSoftFramebuffer();
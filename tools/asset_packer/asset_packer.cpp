@@ -0,0 +1,208 @@
+// Packs every file below a directory into one asset pack, see src/engine/asset_pack.hpp for the layout.
+// InitWindow mounts RESOURCES_PATH resources.pack when it exists. CMake builds it for desktop builds, by hand from
+// the repository root:
+//   g++ -O2 -std=c++11 -Isrc/engine tools/asset_packer/asset_packer.cpp -o asset_packer
+//   ./asset_packer resources resources/resources.pack
+// Packed files shadow the loose ones, so the pack has to be built again after changing the resources.
+// Other .pack files and empty files are left out
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+struct Asset{
+    std::string name; // Relative to the packed directory
+    std::string path;
+    uint64_t size;
+};
+
+bool _EndsWith(const std::string& text, const char* suffix)
+{
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+void _CollectAssets(const std::string& directory, const std::string& prefix, std::vector<Asset>* assets)
+{
+#ifdef _WIN32
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &find_data);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "Could not open %s\n", directory.c_str());
+        return;
+    }
+    do
+    {
+        std::string entry = find_data.cFileName;
+        if (entry == "." || entry == "..")
+        {
+            continue;
+        }
+        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            _CollectAssets(directory + "\\" + entry, prefix + entry + "/", assets);
+        }
+        else
+        {
+            uint64_t size = ((uint64_t)find_data.nFileSizeHigh << 32) | find_data.nFileSizeLow;
+            assets->push_back(Asset{prefix + entry, directory + "\\" + entry, size});
+        }
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        perror(directory.c_str());
+        return;
+    }
+    while (struct dirent* entry = readdir(dir))
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+        std::string path = directory + "/" + entry->d_name;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            perror(path.c_str());
+            continue;
+        }
+        if (S_ISDIR(info.st_mode))
+        {
+            _CollectAssets(path, prefix + entry->d_name + "/", assets);
+        }
+        else
+        {
+            assets->push_back(Asset{prefix + entry->d_name, path, (uint64_t)info.st_size});
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+uint64_t _Align(uint64_t offset)
+{
+    return (offset + AssetPackAlignment - 1) & ~(AssetPackAlignment - 1);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <resources directory> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Asset> found;
+    _CollectAssets(argv[1], "", &found);
+
+    // Sorted so the same directory always gives the same pack
+    std::vector<Asset> assets;
+    for (const Asset& asset : found)
+    {
+        if (asset.size > 0 && !_EndsWith(asset.name, ".pack"))
+        {
+            assets.push_back(asset);
+        }
+    }
+    std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.name < b.name; });
+
+    uint32_t slot_count = 1;
+    while (slot_count < 2 * assets.size())
+    {
+        slot_count *= 2;
+    }
+
+    std::vector<AssetPackSlot> slots(slot_count, AssetPackSlot{});
+    std::string names;
+    uint64_t names_offset = sizeof(AssetPackHeader) + (uint64_t)slot_count * sizeof(AssetPackSlot);
+    for (const Asset& asset : assets)
+    {
+        names += asset.name;
+    }
+
+    uint64_t offset = _Align(names_offset + names.size());
+    uint32_t name_offset = (uint32_t)names_offset;
+    for (const Asset& asset : assets)
+    {
+        uint64_t hash = HashAssetName(asset.name.c_str(), asset.name.size());
+        uint32_t index = (uint32_t)hash & (slot_count - 1);
+        while (slots[index].hash != 0)
+        {
+            if (slots[index].hash == hash)
+            {
+                fprintf(stderr, "Warning: %s shares its hash with another asset, lookups compare the names\n", asset.name.c_str());
+            }
+            index = (index + 1) & (slot_count - 1);
+        }
+
+        AssetPackSlot* slot = &slots[index];
+        slot->hash = hash;
+        slot->offset = offset;
+        slot->size = asset.size;
+        slot->name_offset = name_offset;
+        slot->name_length = (uint32_t)asset.name.size();
+        name_offset += slot->name_length;
+        offset = _Align(offset + asset.size);
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (!out)
+    {
+        fprintf(stderr, "Could not open %s for writing\n", argv[2]);
+        return 1;
+    }
+
+    AssetPackHeader header = {AssetPackMagic, AssetPackVersion, slot_count, (uint32_t)assets.size()};
+    bool written = fwrite(&header, sizeof(header), 1, out) == 1 && fwrite(slots.data(), sizeof(AssetPackSlot), slot_count, out) == slot_count
+                && fwrite(names.data(), 1, names.size(), out) == names.size();
+
+    // Assets follow in name order, which is the order their offsets were handed out in
+    uint64_t position = names_offset + names.size();
+    std::vector<unsigned char> buffer;
+    const char zeros[AssetPackAlignment] = {0};
+    for (size_t i = 0; written && i < assets.size(); i++)
+    {
+        uint64_t start = _Align(position);
+        written = fwrite(zeros, 1, (size_t)(start - position), out) == start - position;
+
+        FILE* in = fopen(assets[i].path.c_str(), "rb");
+        buffer.resize((size_t)assets[i].size);
+        written = written && in && fread(buffer.data(), 1, buffer.size(), in) == buffer.size();
+        if (in)
+        {
+            fclose(in);
+        }
+        if (!written)
+        {
+            fprintf(stderr, "Could not read %s\n", assets[i].path.c_str());
+            break;
+        }
+        written = fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+        position = start + assets[i].size;
+    }
+
+    if (fclose(out) != 0 || !written)
+    {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        remove(argv[2]);
+        return 1;
+    }
+
+    printf("%s: %zu assets, %llu bytes\n", argv[2], assets.size(), (unsigned long long)position);
+    return 0;
+}
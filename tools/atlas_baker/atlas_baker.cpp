@@ -0,0 +1,197 @@
+// Packs the sprites in SpriteAtlas::file_list into one atlas and writes it with its full mip chain, see
+// src/game/sprite_atlas_bake.hpp for the layout. LoadSpriteAtlas reads the bake and falls back to packing the PNGs
+// at startup when there is none. CMake runs it for desktop builds, by hand from the repository root:
+//   g++ -O2 -std=c++11 -Isrc/game -Ithirdparty tools/atlas_baker/atlas_baker.cpp -o atlas_baker
+//   ./atlas_baker resources resources/sprites.atlasbake
+// Run it again after changing the sprite list or the PNGs
+#include "sprite_atlas_bake.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "stb_rect_pack.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+constexpr int SpriteCount = SpriteAtlas::Sprite::_LENGTH;
+constexpr int MaxAtlasSize = 2048;
+constexpr int Padding = 2; // Transparent texels around each sprite, the same as the packing at startup
+
+struct SpriteImage{
+    unsigned char* pixels; // RGBA8
+    int width;
+    int height;
+};
+
+struct Level{
+    std::vector<unsigned char> pixels;
+    int width;
+    int height;
+};
+
+// Power of two sizes from the smallest area up, so the GLES 2 build can mipmap the atlas too
+bool _PackSprites(const SpriteImage* sprites, stbrp_rect* rects, int* atlas_width, int* atlas_height)
+{
+    static stbrp_node nodes[MaxAtlasSize];
+    for (int area_shift = 0; area_shift <= 22; area_shift++)
+    {
+        for (int width = 1; width <= MaxAtlasSize; width *= 2)
+        {
+            int height = (1 << area_shift) / width;
+            if (height < 1 || height > MaxAtlasSize || width * height != (1 << area_shift))
+            {
+                continue;
+            }
+
+            for (int i = 0; i < SpriteCount; i++)
+            {
+                rects[i].id = i;
+                rects[i].w = sprites[i].width + Padding * 2;
+                rects[i].h = sprites[i].height + Padding * 2;
+                rects[i].was_packed = 0;
+            }
+
+            stbrp_context context;
+            stbrp_init_target(&context, width, height, nodes, MaxAtlasSize);
+            if (stbrp_pack_rects(&context, rects, SpriteCount))
+            {
+                *atlas_width = width;
+                *atlas_height = height;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Rounded x * a / 255 like Mln::ImagePremultiplyAlpha
+void _Premultiply(unsigned char* pixels, int pixel_count)
+{
+    for (int i = 0; i < pixel_count; i++)
+    {
+        unsigned char* pixel = pixels + i * 4;
+        unsigned int alpha = pixel[3];
+        for (int c = 0; c < 3; c++)
+        {
+            unsigned int value = pixel[c] * alpha + 128;
+            pixel[c] = (unsigned char)((value + (value >> 8)) >> 8);
+        }
+    }
+}
+
+// Box filter on premultiplied texels so transparent texels never add their color
+Level _Downsample(const Level& src)
+{
+    Level dst;
+    dst.width = src.width > 1 ? src.width / 2 : 1;
+    dst.height = src.height > 1 ? src.height / 2 : 1;
+    dst.pixels.resize((size_t)dst.width * dst.height * 4);
+    for (int y = 0; y < dst.height; y++)
+    {
+        for (int x = 0; x < dst.width; x++)
+        {
+            int x0 = 2 * x < src.width ? 2 * x : src.width - 1, x1 = 2 * x + 1 < src.width ? 2 * x + 1 : src.width - 1;
+            int y0 = 2 * y < src.height ? 2 * y : src.height - 1, y1 = 2 * y + 1 < src.height ? 2 * y + 1 : src.height - 1;
+            for (int c = 0; c < 4; c++)
+            {
+                unsigned int sum = src.pixels[((size_t)y0 * src.width + x0) * 4 + c] + src.pixels[((size_t)y0 * src.width + x1) * 4 + c]
+                                 + src.pixels[((size_t)y1 * src.width + x0) * 4 + c] + src.pixels[((size_t)y1 * src.width + x1) * 4 + c];
+                dst.pixels[((size_t)y * dst.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <resources directory> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    SpriteImage sprites[SpriteCount];
+    for (int i = 0; i < SpriteCount; i++)
+    {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", argv[1], SpriteAtlas::file_list[i]);
+        int components = 0;
+        sprites[i].pixels = stbi_load(path, &sprites[i].width, &sprites[i].height, &components, 4);
+        if (!sprites[i].pixels)
+        {
+            fprintf(stderr, "Could not load %s: %s\n", path, stbi_failure_reason());
+            return 1;
+        }
+    }
+
+    stbrp_rect rects[SpriteCount];
+    int width = 0, height = 0;
+    if (!_PackSprites(sprites, rects, &width, &height))
+    {
+        fprintf(stderr, "The sprites don't fit in %dx%d\n", MaxAtlasSize, MaxAtlasSize);
+        return 1;
+    }
+
+    std::vector<Level> levels(1);
+    levels[0].width = width;
+    levels[0].height = height;
+    levels[0].pixels.assign((size_t)width * height * 4, 0);
+
+    int32_t sprite_rects[SpriteCount][4];
+    for (int i = 0; i < SpriteCount; i++)
+    {
+        int x = rects[i].x + Padding;
+        int y = rects[i].y + Padding;
+        for (int row = 0; row < sprites[i].height; row++)
+        {
+            memcpy(&levels[0].pixels[((size_t)(y + row) * width + x) * 4], sprites[i].pixels + (size_t)row * sprites[i].width * 4, (size_t)sprites[i].width * 4);
+        }
+        sprite_rects[i][0] = x;
+        sprite_rects[i][1] = y;
+        sprite_rects[i][2] = sprites[i].width;
+        sprite_rects[i][3] = sprites[i].height;
+        stbi_image_free(sprites[i].pixels);
+    }
+
+    _Premultiply(levels[0].pixels.data(), width * height);
+    while (levels.back().width > 1 || levels.back().height > 1)
+    {
+        levels.push_back(_Downsample(levels.back()));
+    }
+
+    SpriteAtlasBakeHeader header = {};
+    header.magic = SpriteAtlasBakeMagic;
+    header.version = SpriteAtlasBakeVersion;
+    header.file_list_hash = HashSpriteFileList();
+    header.sprite_count = SpriteCount;
+    header.width = width;
+    header.height = height;
+    header.level_count = (int32_t)levels.size();
+
+    FILE* file = fopen(argv[2], "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Could not open %s for writing\n", argv[2]);
+        return 1;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(sprite_rects, sizeof(sprite_rects), 1, file) == 1;
+    size_t bytes = sizeof(header) + sizeof(sprite_rects);
+    for (size_t i = 0; written && i < levels.size(); i++)
+    {
+        written = fwrite(levels[i].pixels.data(), levels[i].pixels.size(), 1, file) == 1;
+        bytes += levels[i].pixels.size();
+    }
+    if (fclose(file) != 0 || !written)
+    {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("%s: %d sprites in %dx%d with %d levels, %zu bytes\n", argv[2], SpriteCount, width, height, header.level_count, bytes);
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Draws a fixed scene with the software backend, without a window, and compares the captured frame to a golden PNG.
+// It covers sampling, layers, blending, static batches, render targets and both kinds of text. CMake builds it with
+// the software backend and registers it as a test, by hand from the repository root:
+//   ./soft_golden resources tools/soft_golden/golden.png
+// Pass --update after an intended change to the rasterizer to write the golden image instead of comparing
+#include "graphics_api.hpp"
+#include "core.hpp"
+#include "HandmadeMath.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+constexpr int Width = 256;
+constexpr int Height = 160;
+// SSE2, NEON and the scalar fallback round the blends a little differently
+constexpr int Tolerance = 2;
+// Sprite colors flash the texel towards their RGB by their alpha, so no alpha draws the texture as it is
+constexpr Mln::Color Plain = {0.f, 0.f, 0.f, 0.f};
+
+Mln::Image _CreateChecker(int size, int cell)
+{
+    Mln::Image image = Mln::CreateImage(size, size, 4);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            unsigned char* texel = image.data + (y * size + x) * 4;
+            bool light = ((x / cell) + (y / cell)) % 2 == 0;
+            texel[0] = light ? 255 : 40;
+            texel[1] = light ? 200 : 40;
+            texel[2] = light ? 60 : 120;
+            texel[3] = 255;
+        }
+    }
+    return image;
+}
+
+void _DrawScene(const char* resources)
+{
+    std::string directory = std::string(resources) + "/";
+
+    Mln::Image checker_image = _CreateChecker(32, 4);
+    Mln::Texture checker = LoadTextureFromImage(checker_image, false, false);
+    Mln::Texture checker_mipped = LoadTextureFromImage(checker_image, true, true);
+    Mln::UnloadImage(checker_image);
+    Mln::Texture gold = LoadTexture((directory + "gold.png").c_str(), true, false);
+    Mln::Texture frame = LoadTexture((directory + "blue_frame_gradient.png").c_str(), true, false);
+    Mln::Font pixel_font = LoadFont((directory + "Kenney Pixel.ttf").c_str());
+    Mln::Font sdf_font = LoadFontSDF((directory + "Kenney Future Narrow.ttf").c_str());
+    Mln::RenderTarget target = LoadRenderTarget(64, 64);
+    Mln::StaticBatch batch = CreateStaticBatch();
+
+    Mln::Matrix projection = HMM_Orthographic_LH_NO(0, (float)Width, (float)Height, 0, -1.f, 1.f);
+    SetProjection(projection);
+
+    BeginRenderTarget(target);
+    SetProjection(HMM_Orthographic_LH_NO(0, 64.f, 64.f, 0, -1.f, 1.f));
+    ClearBackground(Mln::Color{0.f, 0.f, 0.f, 0.f});
+    DrawRectTextured(HMM_Translate({32.f, 32.f, 0.f}) * HMM_Rotate_LH(HMM_AngleDeg(30.f), {0.f, 0.f, 1.f}), checker, Mln::RectI{0, 0, 32, 32}, Plain);
+    EndRenderTarget();
+
+    BeginStaticBatch(batch);
+    for (int i = 0; i < 4; i++)
+    {
+        DrawRectTextured(HMM_Translate({12.f * i, 0.f, 0.f}) * HMM_Scale({0.25f, 0.25f, 1.f}), checker, Mln::RectI{0, 0, 32, 32}, Plain);
+    }
+    EndStaticBatch();
+
+    BeginDrawing();
+    ClearBackground(Mln::Color{0.1f, 0.12f, 0.2f, 1.f});
+
+    // Nearest magnified and rotated, then mipmapped and minified
+    DrawRectTextured(HMM_Translate({40.f, 40.f, 0.f}) * HMM_Rotate_LH(HMM_AngleDeg(15.f), {0.f, 0.f, 1.f}) * HMM_Scale({1.5f, 1.5f, 1.f}), checker, Mln::RectI{0, 0, 32, 32}, Plain);
+    DrawRectTextured(HMM_Translate({100.f, 24.f, 0.f}) * HMM_Scale({0.4f, 0.4f, 1.f}), checker_mipped, Mln::RectI{0, 0, 32, 32}, Plain);
+    DrawRectTexturedNinePatch(HMM_Translate({120.f, 40.f, 0.f}), Mln::Rect{0.f, 0.f, 80.f, 40.f}, frame, Mln::RectI{0, 0, frame.width, frame.height}, Plain, HMM_Vec4{8.f, 8.f, 8.f, 8.f});
+
+    // The higher layer is submitted first and still ends up on top
+    SetDrawLayer(2);
+    DrawRectTextured(HMM_Translate({205.f, 30.f, 0.f}) * HMM_Scale({0.5f, 0.5f, 1.f}), gold, Mln::RectI{0, 0, gold.width, gold.height}, Plain);
+    SetDrawLayer(1);
+    DrawRectTextured(HMM_Translate({225.f, 45.f, 0.f}), checker, Mln::RectI{0, 0, 32, 32}, Plain);
+    SetDrawLayer(0);
+
+    // A flash, an additive coin and the translucent edge of a coin over the checker
+    DrawRectTextured(HMM_Translate({40.f, 110.f, 0.f}) * HMM_Scale({1.5f, 1.5f, 1.f}), checker, Mln::RectI{0, 0, 32, 32}, Plain);
+    SetDrawLayer(1);
+    DrawRectTextured(HMM_Translate({30.f, 100.f, 0.f}), checker_mipped, Mln::RectI{0, 0, 32, 32}, Mln::Color{0.f, 0.3f, 0.6f, 0.6f});
+    SetDrawAdditive(1.f);
+    DrawRectTextured(HMM_Translate({55.f, 120.f, 0.f}) * HMM_Scale({0.5f, 0.5f, 1.f}), gold, Mln::RectI{0, 0, gold.width, gold.height}, Plain);
+    SetDrawAdditive(0.f);
+    SetDrawLayer(0);
+
+    DrawRectTexturedInstanced(Mln::Transform2D{{105.f, 100.f}, {0.4f, 0.4f}, HMM_AngleDeg(-20.f)}, gold, Mln::RectI{0, 0, gold.width, gold.height}, Plain);
+    DrawStaticBatch(batch, HMM_Translate({90.f, 145.f, 0.f}), Mln::Color{1.f, 0.6f, 0.6f, 0.8f});
+    DrawRectTextured(HMM_Translate({170.f, 115.f, 0.f}), target.texture, Mln::RectI{0, 0, 64, 64}, Plain);
+
+    SetDrawLayer(3);
+    DrawText(pixel_font, "Golden 123", Mln::Vector2{124.f, 80.f}, 0.5f, Mln::Color{1.f, 1.f, 1.f, 1.f});
+    DrawText(sdf_font, "SDF", Mln::Vector2{Width - 4.f, 150.f}, 1.5f, Mln::Color{0.9f, 0.9f, 0.3f, 1.f}, TEXT_ALIGN_RIGHT);
+    EndDrawing();
+
+    UnloadStaticBatch(batch);
+    UnloadRenderTarget(target);
+    UnloadFont(sdf_font);
+    UnloadFont(pixel_font);
+    UnloadTexture(frame);
+    UnloadTexture(gold);
+    UnloadTexture(checker_mipped);
+    UnloadTexture(checker);
+}
+
+int main(int argc, char** argv)
+{
+    bool update = argc == 4 && strcmp(argv[3], "--update") == 0;
+    if (argc != 3 && !update)
+    {
+        fprintf(stderr, "Usage: %s <resources directory> <golden png> [--update]\n", argv[0]);
+        return 1;
+    }
+
+    // Only the graphics backend is initialized, so there is no window and no GL context
+    InitGraphics(Width, Height);
+    _DrawScene(argv[1]);
+    Mln::Image frame = CaptureFramebuffer();
+    ShutdownGraphics();
+
+    if (update)
+    {
+        Mln::WriteImage(frame, argv[2]);
+        printf("Wrote %s\n", argv[2]);
+        Mln::UnloadImage(frame);
+        return 0;
+    }
+
+    Mln::Image golden = Mln::LoadImage(argv[2]);
+    if (!golden.data || golden.width != frame.width || golden.height != frame.height || golden.components != 4)
+    {
+        fprintf(stderr, "%s is missing or not a %dx%d RGBA image\n", argv[2], frame.width, frame.height);
+        Mln::UnloadImage(golden);
+        Mln::UnloadImage(frame);
+        return 1;
+    }
+
+    int mismatches = 0;
+    int max_difference = 0;
+    for (int i = 0; i < frame.width * frame.height * 4; i++)
+    {
+        int difference = abs((int)frame.data[i] - (int)golden.data[i]);
+        max_difference = difference > max_difference ? difference : max_difference;
+        mismatches += difference > Tolerance;
+    }
+
+    bool passed = mismatches == 0;
+    if (passed)
+    {
+        printf("Matches %s, largest difference %d\n", argv[2], max_difference);
+    }
+    else
+    {
+        // Left in the working directory to compare by eye
+        Mln::WriteImage(frame, "soft_golden_actual.png");
+        fprintf(stderr, "%d channels differ from %s by more than %d, up to %d. The frame is in soft_golden_actual.png\n", mismatches, argv[2], Tolerance, max_difference);
+    }
+    Mln::UnloadImage(golden);
+    Mln::UnloadImage(frame);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+// Times the SIMD and scalar paths of TransformSpriteCorners against the per sprite matrix path DrawRectTextured uses.
+// CMake builds it for desktop builds, by hand from the repository root:
+//   g++ -O2 -std=c++11 -Isrc -Isrc/engine -Isrc/gl -Ithirdparty tools/sprite_bench/sprite_bench.cpp src/gl/sprite_transform.cpp -o sprite_bench
+// With -DSPRITE_TRANSFORM_NO_SIMD both columns time the scalar path
+#include "sprite_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+constexpr int SpriteCount = 10000;
+constexpr int Iterations = 200;
+
+struct CornerVertex{
+    float position[2];
+    float padding[2]; // Keeps the stride of a compact QuadVertex
+};
+
+TexturedRect rects[SpriteCount];
+CornerVertex reference[SpriteCount * 4];
+CornerVertex result[SpriteCount * 4];
+CornerVertex scalar_result[SpriteCount * 4];
+
+float _Random(float min, float max)
+{
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+// What DrawRectTextured does for one sprite: GetMatrix, the model view projection and 4 matrix vector products
+void _TransformReference(const TexturedRect* rect, const Mln::Matrix& view_projection, CornerVertex* out)
+{
+    const Mln::Transform2D& transform = rect->transform;
+    Mln::Matrix model = HMM_Translate({transform.position.X, transform.position.Y, 0.f}) * HMM_Rotate_LH(transform.rotation, {0.f, 0.f, 1.f}) * HMM_Scale({transform.scale.X, transform.scale.Y, 1.f});
+    Mln::Matrix mvp = view_projection * model;
+
+    float w = (float)rect->texture_source.width;
+    float h = (float)rect->texture_source.height;
+    Mln::Vector2 corners[4] = {{w / 2.f, -h / 2.f}, {w / 2.f, h / 2.f}, {-w / 2.f, h / 2.f}, {-w / 2.f, -h / 2.f}};
+    for (int i = 0; i < 4; i++)
+    {
+        Mln::Vector2 position = (mvp * HMM_Vec4{corners[i].X, corners[i].Y, 0, 1}).XY;
+        out[i].position[0] = position.X;
+        out[i].position[1] = position.Y;
+    }
+}
+
+template<typename F>
+double _TimeMilliseconds(F function)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < Iterations; i++)
+    {
+        function();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / Iterations;
+}
+
+int main()
+{
+    srand(1234);
+    for (int i = 0; i < SpriteCount; i++)
+    {
+        rects[i].transform = Mln::Transform2D{{_Random(-400, 400), _Random(-300, 300)}, {_Random(0.5f, 2.f), _Random(0.5f, 2.f)}, i % 2 ? _Random(-3.f, 3.f) : 0.f};
+        rects[i].texture_source = Mln::RectI{0, 0, 16 + rand() % 64, 16 + rand() % 64};
+        rects[i].color = Mln::Color{1, 1, 1, 1};
+    }
+    Mln::Matrix view_projection = HMM_Orthographic_LH_NO(-400, 400, 300, -300, -1, 1);
+
+    double reference_ms = _TimeMilliseconds([&]() {
+        for (int i = 0; i < SpriteCount; i++)
+        {
+            _TransformReference(&rects[i], view_projection, &reference[4 * i]);
+        }
+    });
+    double scalar_ms = _TimeMilliseconds([&]() {
+        TransformSpriteCornersScalar(rects, SpriteCount, view_projection, scalar_result[0].position, sizeof(CornerVertex));
+    });
+    double simd_ms = _TimeMilliseconds([&]() {
+        TransformSpriteCorners(rects, SpriteCount, view_projection, result[0].position, sizeof(CornerVertex));
+    });
+
+    float max_error = 0.f;
+    float max_scalar_error = 0.f;
+    for (int i = 0; i < SpriteCount * 4; i++)
+    {
+        for (int axis = 0; axis < 2; axis++)
+        {
+            max_error = fmaxf(max_error, fabsf(reference[i].position[axis] - result[i].position[axis]));
+            max_scalar_error = fmaxf(max_scalar_error, fabsf(reference[i].position[axis] - scalar_result[i].position[axis]));
+        }
+    }
+
+    printf("%d sprites, %d iterations\n", SpriteCount, Iterations);
+    printf("                 %10s %10s %10s\n", "matrix", "scalar", "simd");
+    printf("ms per call      %10.3f %10.3f %10.3f\n", reference_ms, scalar_ms, simd_ms);
+    printf("speedup          %10.2f %10.2f %10.2f\n", 1.0, reference_ms / scalar_ms, reference_ms / simd_ms);
+    printf("max clip error   %10g %10g %10g\n", 0.0, max_scalar_error, max_error);
+    return max_error < 1e-4f && max_scalar_error < 1e-4f ? 0 : 1;
+}
@@ -40,7 +40,12 @@ class MlnlibJs {
         this.sounds = new Map();
         this.next_sound_id = 0;
         this.fonts = new Map();
-        this.next_font_id = 0;
+        this.next_font_id = 1; // 0 is the null font
+        this.draws = [];
+        this.layer = 0;
+        this.batches = [];
+        this.recording_batch = undefined;
+        this.screen = undefined; // What BeginRenderTarget swapped out
         this.quit = false;
         this.projection_matrix = {a:1.0, b:0, c:0, d:1.0, e:0, f:0};
         this.view_matrix = {a:1.0, b:0, c:0, d:1.0, e:0, f:0};
@@ -190,17 +195,49 @@ class MlnlibJs {
     }
 
     SetView(matrix_ptr) {
-        const buffer = this.exports.memory.buffer;
-        var transform = new Float32Array(buffer, matrix_ptr, 16);
-
-        this.view_matrix = {
-            a: transform[0],
-            b: transform[1],
-            c: transform[4],
-            d: transform[5],
-            e: transform[12],
-            f: transform[13],
+        this.view_matrix = matrix2d_by_ptr(this.exports.memory.buffer, matrix_ptr);
+    }
+
+    BeginDrawing() {
+        this.layer = 0;
+    }
+
+    EndDrawing() {
+        this.#flushDraws();
+    }
+
+    SetDrawLayer(layer) {
+        this.layer = layer;
+    }
+
+    // Draws wait until EndDrawing, a clear or a render target switch so they can be sorted by layer like on the
+    // other backends. paint draws in the space of model
+    #submit(model, paint) {
+        if (this.recording_batch !== undefined) {
+            this.recording_batch.draws.push({model, paint});
+            return;
+        }
+
+        const view = this.view_matrix;
+        this.#queueDraw((ctx) => {
+            ctx.setTransform(this.projection_matrix);
+            ctx.transform(view.a, view.b, view.c, view.d, view.e, view.f);
+            ctx.transform(model.a, model.b, model.c, model.d, model.e, model.f);
+            paint(ctx);
+        });
+    }
+
+    #queueDraw(draw) {
+        this.draws.push({layer: this.layer, order: this.draws.length, draw});
+    }
+
+    #flushDraws() {
+        // Within a layer the submission order is kept
+        this.draws.sort((a, b) => a.layer - b.layer || a.order - b.order);
+        for (const draw of this.draws) {
+            draw.draw(this.ctx);
         }
+        this.draws = [];
     }
 
     LoadSoundFromFileWave(path_ptr) {
@@ -216,6 +253,24 @@ class MlnlibJs {
         return sound_id;
     }
 
+    // Fonts are drawn by the browser, so the distance field variant is the same font
+    LoadFontSDF(font_path_ptr) {
+        return this.LoadFont(font_path_ptr);
+    }
+
+    // There are no bakes of browser fonts, the null font makes the game load the TTF instead
+    LoadFontBake(path_ptr, ttf_path_ptr) {
+        return 0;
+    }
+
+    SaveFontBake(font_id, path_ptr) {
+        return false;
+    }
+
+    GetFontMemory(font_id) {
+        return 0;
+    }
+
     LoadFont(font_path_ptr) {
         const mem = this.exports.memory.buffer;
         const font_path = cstr_by_ptr(mem, font_path_ptr)
@@ -322,6 +377,48 @@ class MlnlibJs {
     }
 
     LoadTextureFromImage(out_texture_ptr, image_ptr, has_filter, has_mipmaps) {
+        this.#loadTextureFromImagePtr(out_texture_ptr, image_ptr);
+    }
+
+    // Canvas scales on its own, only the base level is used
+    LoadTextureFromMipChain(out_texture_ptr, levels_ptr, level_count, has_filter) {
+        this.#loadTextureFromImagePtr(out_texture_ptr, levels_ptr);
+    }
+
+    LoadTexture(out_texture_ptr, path_ptr, has_filter, has_mipmaps) {
+        const size_ptr = this.exports.malloc(4);
+        const data_ptr = this.PlatformLoadFileBinary(path_ptr, size_ptr);
+        const [size] = new Uint32Array(this.exports.memory.buffer, size_ptr, 1);
+        this.exports.free(size_ptr);
+
+        var result = new Uint32Array(this.exports.memory.buffer, out_texture_ptr, 3);
+        result.fill(0);
+        if (data_ptr == 0) {
+            return;
+        }
+
+        // The image decodes in the background and draws nothing until then, the size comes from the PNG header
+        const bytes = new Uint8Array(this.exports.memory.buffer, data_ptr, size).slice();
+        this.PlatformUnloadFileBinary(data_ptr);
+        const header = new DataView(bytes.buffer);
+        const js_image = new Image();
+        js_image.src = URL.createObjectURL(new Blob([bytes]));
+
+        this.images.push(js_image);
+        result = new Uint32Array(this.exports.memory.buffer, out_texture_ptr, 3);
+        result[0] = this.images.length - 1;
+        if (size >= 24) {
+            result[1] = header.getUint32(16); // width
+            result[2] = header.getUint32(20); // height
+        }
+    }
+
+    UnloadTexture(texture_ptr) {
+        const [id] = new Uint32Array(this.exports.memory.buffer, texture_ptr, 1);
+        this.images[id] = undefined;
+    }
+
+    #loadTextureFromImagePtr(out_texture_ptr, image_ptr) {
         const buffer = this.exports.memory.buffer;
         // Texture: id(32) width(32) height(32)
         // Image: data_ptr(32) width(32) height(32) components(32)
@@ -330,26 +427,111 @@ class MlnlibJs {
         const image_height = image[2];
         const image_components = image[3];
 
-        const imageBytes = new Uint8ClampedArray(buffer, image[0], image_width * image_height * image_components);
+        // Textures are premultiplied, ImageData wants straight alpha
+        const imageBytes = new Uint8ClampedArray(buffer, image[0], image_width * image_height * image_components).slice();
+        for (var i = 0; i < imageBytes.length; i += 4) {
+            const alpha = imageBytes[i + 3];
+            if (alpha > 0 && alpha < 255) {
+                imageBytes[i + 0] = imageBytes[i + 0] * 255 / alpha;
+                imageBytes[i + 1] = imageBytes[i + 1] * 255 / alpha;
+                imageBytes[i + 2] = imageBytes[i + 2] * 255 / alpha;
+            }
+        }
         const imageData = new ImageData(imageBytes, image_width, image_height);
 
+        // Canvases draw like images and are ready right away
         var canvas = document.createElement("canvas");
         canvas.width = image_width;
         canvas.height = image_height;
         var ctx = canvas.getContext("2d");
         ctx.putImageData(imageData, 0, 0);
 
-        const js_image = new Image(image_width, image_height);
-        js_image.src = canvas.toDataURL("image/png");
-
-        this.images.push(js_image);
+        this.images.push(canvas);
 
         var result = new Uint32Array(buffer, out_texture_ptr, 3);
-        result[0] = this.images.indexOf(js_image);
+        result[0] = this.images.length - 1;
         result[1] = image_width; // width
         result[2] = image_height; // height
+    }
+
+    // RenderTarget: id(32) texture(id(32) width(32) height(32)) width(32) height(32)
+    LoadRenderTarget(out_target_ptr, width, height) {
+        var canvas = document.createElement("canvas");
+        canvas.width = width;
+        canvas.height = height;
+        this.images.push(canvas);
 
-        return result;
+        const id = this.images.length - 1;
+        var result = new Uint32Array(this.exports.memory.buffer, out_target_ptr, 6);
+        result.set([id, id, width, height, width, height]);
+    }
+
+    UnloadRenderTarget(target_ptr) {
+        const [id] = new Uint32Array(this.exports.memory.buffer, target_ptr, 1);
+        this.images[id] = undefined;
+    }
+
+    BeginRenderTarget(target_ptr) {
+        const [id] = new Uint32Array(this.exports.memory.buffer, target_ptr, 1);
+        this.#flushDraws();
+        this.screen = {ctx: this.ctx, view_matrix: this.view_matrix};
+        this.ctx = this.images[id].getContext("2d");
+    }
+
+    EndRenderTarget() {
+        this.#flushDraws();
+        this.ctx = this.screen.ctx;
+        this.view_matrix = this.screen.view_matrix;
+        this.screen = undefined;
+    }
+
+    CreateStaticBatch() {
+        this.batches.push({draws: [], dirty: true});
+        return this.batches.length - 1;
+    }
+
+    UnloadStaticBatch(batch_id) {
+        this.batches[batch_id] = undefined;
+    }
+
+    // Recorded draws keep their world transforms and are replayed with the view at DrawStaticBatch
+    BeginStaticBatch(batch_id) {
+        this.recording_batch = this.batches[batch_id];
+        this.recording_batch.draws = [];
+    }
+
+    EndStaticBatch() {
+        this.recording_batch.dirty = false;
+        this.recording_batch = undefined;
+    }
+
+    MarkStaticBatchDirty(batch_id) {
+        this.batches[batch_id].dirty = true;
+    }
+
+    IsStaticBatchDirty(batch_id) {
+        return this.batches[batch_id].dirty;
+    }
+
+    DrawStaticBatch(batch_id, transform_ptr, tint_ptr) {
+        // TODO: tint with color, only its alpha fades the batch for now
+        const buffer = this.exports.memory.buffer;
+        const batch_transform = matrix2d_by_ptr(buffer, transform_ptr);
+        const [, , , alpha] = new Float32Array(buffer, tint_ptr, 4);
+        const draws = this.batches[batch_id].draws;
+        const view = this.view_matrix;
+
+        this.#queueDraw((ctx) => {
+            ctx.globalAlpha = alpha;
+            for (const {model, paint} of draws) {
+                ctx.setTransform(this.projection_matrix);
+                ctx.transform(view.a, view.b, view.c, view.d, view.e, view.f);
+                ctx.transform(batch_transform.a, batch_transform.b, batch_transform.c, batch_transform.d, batch_transform.e, batch_transform.f);
+                ctx.transform(model.a, model.b, model.c, model.d, model.e, model.f);
+                paint(ctx);
+            }
+            ctx.globalAlpha = 1;
+        });
     }
 
     JsIsKeyDown(key_glfw) {
@@ -407,6 +589,10 @@ class MlnlibJs {
         return num % mod;
     }
 
+    ceilf(num) {
+        return Math.ceil(num);
+    }
+
     DrawRectTextured(transform_ptr, texture_ptr, texture_rect_ptr, color_ptr) { 
         // TODO: tint with color
 
@@ -414,24 +600,57 @@ class MlnlibJs {
         // Texture: id(32) width(32) height(32)
         // Rect: x(32) y(32) width(32) height(32)
         const buffer = this.exports.memory.buffer;
-        var transform = new Float32Array(buffer, transform_ptr, 16);
-        var texture = new Uint32Array(buffer, texture_ptr, 3);
-        var rect = new Uint32Array(buffer, texture_rect_ptr, 4);
+        const model = matrix2d_by_ptr(buffer, transform_ptr);
+        const [texture_id] = new Uint32Array(buffer, texture_ptr, 3);
+        const [x, y, width, height] = new Int32Array(buffer, texture_rect_ptr, 4);
 
+        const image = this.images[texture_id];
+        this.#submit(model, (ctx) => {
+            ctx.drawImage(image, x, y, width, height, -width / 2.0, -height / 2.0, width, height);
+        });
+    }
 
+    DrawRectTexturedInstanced(transform_ptr, texture_ptr, texture_rect_ptr, color_ptr, pivot_ptr) {
+        // TODO: tint with color
 
-        this.ctx.setTransform(this.projection_matrix);
-        this.ctx.transform(this.view_matrix.a, this.view_matrix.b, this.view_matrix.c, this.view_matrix.d, this.view_matrix.e, this.view_matrix.f);
-        this.ctx.transform(transform[0], transform[1], transform[4], transform[5], transform[12], transform[13]);
+        // Transform2D: position(2 x float 32) scale(2 x float 32) rotation(float 32)
+        // Vector2: x(float 32) y(float 32)
+        const buffer = this.exports.memory.buffer;
+        const model = matrix2d_by_transform(new Float32Array(buffer, transform_ptr, 5));
+        const [texture_id] = new Uint32Array(buffer, texture_ptr, 3);
+        const [x, y, width, height] = new Int32Array(buffer, texture_rect_ptr, 4);
+        const [pivot_x, pivot_y] = new Float32Array(buffer, pivot_ptr, 2);
+
+        const image = this.images[texture_id];
+        this.#submit(model, (ctx) => {
+            ctx.drawImage(image, x, y, width, height, -pivot_x * width, -pivot_y * height, width, height);
+        });
+    }
 
+    DrawRectsTextured(texture_ptr, rects_ptr, count) {
+        // TODO: tint with color
 
-        const image = this.images[texture[0]];
-        this.ctx.drawImage(image, rect[0], rect[1], rect[2], rect[3], -rect[2] / 2.0, -rect[3] / 2.0, rect[2], rect[3]);
+        // TexturedRect: Transform2D(5 x 32) RectI(4 x 32) Color(4 x float 32)
+        const TexturedRectWords = 13;
+        const buffer = this.exports.memory.buffer;
+        const [texture_id] = new Uint32Array(buffer, texture_ptr, 3);
+        const floats = new Float32Array(buffer, rects_ptr, count * TexturedRectWords);
+        const ints = new Int32Array(buffer, rects_ptr, count * TexturedRectWords);
+
+        const image = this.images[texture_id];
+        for (var i = 0; i < count; i++) {
+            const base = i * TexturedRectWords;
+            const model = matrix2d_by_transform(floats.subarray(base, base + 5));
+            const [x, y, width, height] = ints.subarray(base + 5, base + 9);
+            this.#submit(model, (ctx) => {
+                ctx.drawImage(image, x, y, width, height, -width / 2.0, -height / 2.0, width, height);
+            });
+        }
     }
 
     DrawRectTexturedNinePatch(transform_ptr, rect_ptr, texture_ptr, texture_rect_ptr, color_ptr, margins_ptr) {
         const buffer = this.exports.memory.buffer;
-        const transform = new Float32Array(buffer, transform_ptr, 16);
+        const model = matrix2d_by_ptr(buffer, transform_ptr);
         const rect = new Float32Array(buffer, rect_ptr, 4);
         const texture = new Uint32Array(buffer, texture_ptr, 3);
         const texture_rect = new Uint32Array(buffer, texture_rect_ptr, 4);
@@ -440,33 +659,28 @@ class MlnlibJs {
         const [rect_x, rect_y, rect_width, rect_height] = rect;
         const [uv_x, uv_y, uv_width, uv_height] = texture_rect;
         const [margin_x, margin_y, margin_z, margin_w] = margins;
-
-
-        this.ctx.setTransform(this.projection_matrix);
-        this.ctx.transform(this.view_matrix.a, this.view_matrix.b, this.view_matrix.c, this.view_matrix.d, this.view_matrix.e, this.view_matrix.f);
-        this.ctx.transform(transform[0], transform[1], transform[4], transform[5], transform[12], transform[13]);
-
-
         const image = this.images[texture[0]];
-        // top left
-        this.ctx.drawImage(image, /* Source */ uv_x, uv_y, margin_x, margin_y, /* Destination */ rect_x, rect_y, margin_x, margin_y);
-        // top right
-        this.ctx.drawImage(image, /* Source */ uv_x + uv_width - margin_z, uv_y, margin_z, margin_y, /* Destination */ rect_x + rect_width - margin_z, rect_y, margin_z, margin_y);
-        // bottom left
-        this.ctx.drawImage(image, /* Source */ uv_x, uv_y + uv_height - margin_w, margin_x, margin_w, /* Destination */ rect_x, rect_y + rect_height - margin_w, margin_x, margin_w);
-        // bottom right
-        this.ctx.drawImage(image, /* Source */ uv_x + uv_width - margin_z, uv_y + uv_height - margin_w, margin_z, margin_w, /* Destination */ rect_x + rect_width - margin_z, rect_y + rect_height - margin_w, margin_z, margin_w);
-        // left
-        this.ctx.drawImage(image, /* Source */ uv_x, uv_y + margin_y, margin_x, uv_height - margin_y - margin_w, /* Destination */ rect_x, rect_y + margin_y, margin_x, rect_height - (margin_y + margin_w));
-        // right
-        this.ctx.drawImage(image, /* Source */ uv_x + uv_width - margin_z, uv_y + margin_y, margin_z, uv_height - margin_y - margin_w, /* Destination */ rect_x + rect_width - margin_z, rect_y + margin_y, margin_z, rect_height - (margin_y + margin_w));
-        // top
-        this.ctx.drawImage(image, /* Source */ uv_x + margin_x, uv_y, uv_width - margin_x - margin_z, margin_y, /* Destination */ rect_x + margin_x, rect_y, rect_width - (margin_x + margin_z), margin_y);
-        // bottom
-        this.ctx.drawImage(image, /* Source */ uv_x + margin_x, uv_y + uv_height - margin_w, uv_width - margin_x - margin_z, margin_w, /* Destination */ rect_x + margin_x, rect_y + rect_height - margin_w, rect_width - (margin_x + margin_z), margin_w);
-        // center
-        this.ctx.drawImage(image, /* Source */ uv_x + margin_x, uv_y + margin_y, uv_width - (margin_x + margin_z), uv_height - (margin_y + margin_w), /* Destination */ rect_x + margin_x, rect_y + margin_y, rect_width - (margin_x + margin_z), rect_height - (margin_y + margin_w));
 
+        this.#submit(model, (ctx) => {
+            // top left
+            ctx.drawImage(image, /* Source */ uv_x, uv_y, margin_x, margin_y, /* Destination */ rect_x, rect_y, margin_x, margin_y);
+            // top right
+            ctx.drawImage(image, /* Source */ uv_x + uv_width - margin_z, uv_y, margin_z, margin_y, /* Destination */ rect_x + rect_width - margin_z, rect_y, margin_z, margin_y);
+            // bottom left
+            ctx.drawImage(image, /* Source */ uv_x, uv_y + uv_height - margin_w, margin_x, margin_w, /* Destination */ rect_x, rect_y + rect_height - margin_w, margin_x, margin_w);
+            // bottom right
+            ctx.drawImage(image, /* Source */ uv_x + uv_width - margin_z, uv_y + uv_height - margin_w, margin_z, margin_w, /* Destination */ rect_x + rect_width - margin_z, rect_y + rect_height - margin_w, margin_z, margin_w);
+            // left
+            ctx.drawImage(image, /* Source */ uv_x, uv_y + margin_y, margin_x, uv_height - margin_y - margin_w, /* Destination */ rect_x, rect_y + margin_y, margin_x, rect_height - (margin_y + margin_w));
+            // right
+            ctx.drawImage(image, /* Source */ uv_x + uv_width - margin_z, uv_y + margin_y, margin_z, uv_height - margin_y - margin_w, /* Destination */ rect_x + rect_width - margin_z, rect_y + margin_y, margin_z, rect_height - (margin_y + margin_w));
+            // top
+            ctx.drawImage(image, /* Source */ uv_x + margin_x, uv_y, uv_width - margin_x - margin_z, margin_y, /* Destination */ rect_x + margin_x, rect_y, rect_width - (margin_x + margin_z), margin_y);
+            // bottom
+            ctx.drawImage(image, /* Source */ uv_x + margin_x, uv_y + uv_height - margin_w, uv_width - margin_x - margin_z, margin_w, /* Destination */ rect_x + margin_x, rect_y + rect_height - margin_w, rect_width - (margin_x + margin_z), margin_w);
+            // center
+            ctx.drawImage(image, /* Source */ uv_x + margin_x, uv_y + margin_y, uv_width - (margin_x + margin_z), uv_height - (margin_y + margin_w), /* Destination */ rect_x + margin_x, rect_y + margin_y, rect_width - (margin_x + margin_z), rect_height - (margin_y + margin_w));
+        });
     }
 
     // void DrawText(Mln::Font font, const char *str, Mln::Vector2 position, float scale, Mln::Color color, TextAlign alignment = TEXT_ALIGN_LEFT);
@@ -476,7 +690,6 @@ class MlnlibJs {
         const [posX, posY] = new Float32Array(buffer, position_ptr, 2);
         
         const color = getColorFromMemory(buffer, color_ptr);
-        this.ctx.fillStyle = color;
 
         const font_size = 48 * font_scale;
         this.ctx.font = `${font_size}px Font_${font_id}`;
@@ -494,12 +707,14 @@ class MlnlibJs {
         }
 
 
-        this.ctx.setTransform(this.projection_matrix);
-        this.ctx.transform(this.view_matrix.a, this.view_matrix.b, this.view_matrix.c, this.view_matrix.d, this.view_matrix.e, this.view_matrix.f);
         const lines = text.split('\n');
-        for (var i = 0; i < lines.length; i++) {
-            this.ctx.fillText(lines[i], posX + offsetX, posY + (i * font_size));
-        }
+        this.#submit(identity_matrix2d, (ctx) => {
+            ctx.fillStyle = color;
+            ctx.font = `${font_size}px Font_${font_id}`;
+            for (var i = 0; i < lines.length; i++) {
+                ctx.fillText(lines[i], posX + offsetX, posY + (i * font_size));
+            }
+        });
     }
 
     MeasureText(font_id, text_ptr) {
@@ -521,10 +736,23 @@ class MlnlibJs {
         audio.play();
     }
 
+    UnloadSound(sound_ptr) {
+        var sound = new Int32Array(this.exports.memory.buffer, sound_ptr, 1);
+        delete this.sounds[sound[0]];
+        sound[0] = -1; // InvalidID
+    }
+
+    GetSoundMemory(sound_id) {
+        return 0;
+    }
+
     ClearBackground(color_ptr) {
         const color = getColorFromMemory(this.exports.memory.buffer, color_ptr)
+        this.#flushDraws();
         this.ctx.fillStyle = color;
         this.ctx.setTransform(1, 0, 0, 1, 0, 0);
+        // Clears to transparent have to replace what is there instead of blending over it
+        this.ctx.clearRect(0, 0, this.ctx.canvas.width, this.ctx.canvas.height);
         this.ctx.fillRect(0, 0, this.ctx.canvas.width, this.ctx.canvas.height);
     }
 
@@ -683,6 +911,21 @@ function color_hex_unpacked(r, g, b, a) {
     return "#"+r+g+b+a;
 }
 
+const identity_matrix2d = {a: 1, b: 0, c: 0, d: 1, e: 0, f: 0};
+
+// The 2D part of a 4x4 float 32 matrix, in the a-f order of canvas transforms
+function matrix2d_by_ptr(buffer, ptr) {
+    const m = new Float32Array(buffer, ptr, 16);
+    return {a: m[0], b: m[1], c: m[4], d: m[5], e: m[12], f: m[13]};
+}
+
+// Translate * Rotate_LH * Scale of a Transform2D, like Mln::GetMatrix
+function matrix2d_by_transform([x, y, scale_x, scale_y, rotation]) {
+    const s = Math.sin(rotation);
+    const c = Math.cos(rotation);
+    return {a: c * scale_x, b: -s * scale_x, c: s * scale_y, d: c * scale_y, e: x, f: y};
+}
+
 function getColorFromMemory(buffer, color_ptr) {
     const [r, g, b, a] = new Float32Array(buffer, color_ptr, 4);
     return color_hex_unpacked(r, g, b, a);